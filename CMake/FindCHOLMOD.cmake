@@ -0,0 +1,60 @@
+#
+# - Find SuiteSparse's CHOLMOD include dirs and libraries
+# Use this module by invoking find_package with the form:
+#  find_package(CHOLMOD
+#               [REQUIRED] # Fail with error if cholmod is not found
+#              )
+#
+# CHOLMOD depends on the AMD, COLAMD, CAMD, CCOLAMD and SuiteSparse_config libraries of SuiteSparse, and on
+# BLAS/LAPACK. The dependencies found are added to CHOLMOD_LIBRARIES.
+#
+# Results are reported in variables:
+#  CHOLMOD_FOUND            - True if the header and the cholmod library were found
+#  CHOLMOD_INCLUDE_DIRS     - cholmod include directories
+#  CHOLMOD_LIBRARIES        - cholmod library and its dependencies to be linked
+#
+# The user can give a specific path where to find the library adding cmake options at configure
+# (ex: cmake path/to/project -DCHOLMOD_DIR=path/to/suitesparse), or with the environment variable CHOLMOD_DIR.
+
+set(CHOLMOD_DIR "$ENV{CHOLMOD_DIR}" CACHE PATH "Installation directory of SuiteSparse's CHOLMOD library")
+
+find_path(CHOLMOD_INCLUDE_DIRS
+    NAMES cholmod.h
+    HINTS ${CHOLMOD_DIR}
+    PATH_SUFFIXES include include/suitesparse suitesparse ufsparse)
+
+find_library(CHOLMOD_cholmod_LIBRARY
+    NAMES cholmod
+    HINTS ${CHOLMOD_DIR}
+    PATH_SUFFIXES lib lib32 lib64)
+mark_as_advanced(CHOLMOD_INCLUDE_DIRS CHOLMOD_cholmod_LIBRARY)
+
+if (CHOLMOD_cholmod_LIBRARY)
+    set(CHOLMOD_LIBRARIES "${CHOLMOD_cholmod_LIBRARY}")
+    get_filename_component(cholmod_lib_path "${CHOLMOD_cholmod_LIBRARY}" PATH)
+
+    # SuiteSparse dependencies, usually installed next to cholmod
+    foreach(dependency amd colamd camd ccolamd suitesparseconfig)
+        find_library(CHOLMOD_${dependency}_LIBRARY
+            NAMES ${dependency}
+            HINTS ${cholmod_lib_path} ${CHOLMOD_DIR}
+            PATH_SUFFIXES lib lib32 lib64)
+        mark_as_advanced(CHOLMOD_${dependency}_LIBRARY)
+        if (CHOLMOD_${dependency}_LIBRARY)
+            list(APPEND CHOLMOD_LIBRARIES "${CHOLMOD_${dependency}_LIBRARY}")
+        endif()
+    endforeach()
+
+    # BLAS and LAPACK
+    if (NOT LAPACK_FOUND)
+        find_package(LAPACK QUIET)
+    endif()
+    if (LAPACK_FOUND)
+        list(APPEND CHOLMOD_LIBRARIES ${LAPACK_LIBRARIES})
+    endif()
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(CHOLMOD DEFAULT_MSG
+    CHOLMOD_INCLUDE_DIRS
+    CHOLMOD_LIBRARIES)
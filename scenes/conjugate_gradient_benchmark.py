@@ -19,11 +19,23 @@ eps = cell_size/10
 
 cg_solvers = [
     {'name':'None', 'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'None',     'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'Flat', 'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'None', 'flat_vectors':True, 'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'Pipe', 'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'None', 'pipelined':True, 'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
     {'name':'Id',   'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'Identity', 'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
     {'name':'Dia',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'Diagonal', 'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'pDia', 'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'Diagonal', 'pipelined':True, 'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
 # #    {'name':'LSDia', 'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'LeastSquareDiagonal', 'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
     {'name':'iChol',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'IncompleteCholesky',  'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
     {'name':'iLU',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'IncompleteLU',  'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'fiChol',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'IncompleteCholesky', 'single_precision_preconditioner':True, 'refinement_steps':5, 'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'bDia',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'BlockDiagonal',  'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'biChol',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'BlockIncompleteCholesky',  'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'MG',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'GeometricMultigrid',  'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'SA',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'SmoothedAggregation',  'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+    {'name':'mfbJac',  'solver':'ConjugateGradientSolver', 'arguments' : {'preconditioning_method':'NodeBlockJacobi',  'maximum_number_of_iterations':number_of_cg_iterations, 'residual_tolerance_threshold':threshold}},
+
+# Direct solvers
+    {'name':'LDLT',  'solver':'LDLTSolver', 'arguments' : {}},
 
 # Sofa solvers
     {'name':'sNone', 'solver':'CGLinearSolver', 'arguments':  {'tolerance':threshold, 'iterations':number_of_cg_iterations}},
@@ -61,6 +73,12 @@ def extract_newton_steps(record):
                     data['Precond Analysis'] = MBKBuild['ConjugateGradient::ComputeGlobalMatrix']['PreconditionerAnalysis']['total_time']
             else:
                 data['Update global matrix'] = MBKBuild['ConjugateGradient::ComputeGlobalMatrix']['total_time']
+        elif 'LDLTSolver::ComputeGlobalMatrix' in MBKBuild:
+            LDLTBuild = MBKBuild['LDLTSolver::ComputeGlobalMatrix']
+            data['Update global matrix'] = LDLTBuild['BuildMatrix']['total_time']
+            data['Precond Factorize'] = LDLTBuild['NumericFactorization']['total_time']
+            if 'SymbolicAnalysis' in LDLTBuild:
+                data['Precond Analysis'] = LDLTBuild['SymbolicAnalysis']['total_time']
         else:
             data['Update global matrix'] = MBKBuild['total_time']
 
@@ -0,0 +1,91 @@
+#!/usr/bin/python3
+
+# Time spent in the element kernels of the HyperelasticForcefield on a beam of 100 000 hexahedrons (10x10x1000).
+# Run it on two builds (or two commits) to compare the performance of the kernels, for example before and after a
+# change in the material evaluation.
+
+import Sofa
+from SofaRuntime import Timer
+
+number_of_newton_iterations = 3
+number_of_cg_iterations = 100
+nx, ny, nz = 11, 11, 1001
+width = 10
+length = 1000
+eps = 1e-3
+
+materials = [
+    {'name': 'StVK',       'material': 'SaintVenantKirchhoffMaterial', 'arguments': {'young_modulus': 3000, 'poisson_ratio': 0.3}},
+    {'name': 'NeoHookean', 'material': 'NeoHookeanMaterial',           'arguments': {'young_modulus': 3000, 'poisson_ratio': 0.3}},
+]
+
+timers = ['HyperelasticForcefield::addForce', 'HyperelasticForcefield::update_stiffness', 'HyperelasticForcefield::addDForce']
+
+
+def collect(record, name, times):
+    """Recursively gather the total times of every records having the given name."""
+    if isinstance(record, list):
+        for r in record:
+            collect(r, name, times)
+    elif isinstance(record, dict):
+        for k, v in record.items():
+            if k == name:
+                for r in (v if isinstance(v, list) else [v]):
+                    times.append(r['total_time'])
+            else:
+                collect(v, name, times)
+
+
+class Controller(Sofa.Core.Controller):
+    def __init__(self, node, *args, **kwargs):
+        Sofa.Core.Controller.__init__(self, *args, **kwargs)
+        self.node = node
+
+    def onAnimateBeginEvent(self, e):
+        Timer.setEnabled(self.node.name.value, True)
+        Timer.begin(self.node.name.value)
+
+    def onAnimateEndEvent(self, e):
+        records = Timer.getRecords(self.node.name.value)
+        print(self.node.name.value)
+        for name in timers:
+            times = []
+            collect(records, name, times)
+            if len(times):
+                print('  {: <45} calls: {: >4}  mean: {:.3f} ms  total: {:.3f} ms'.format(name, len(times), sum(times)/len(times), sum(times)))
+        Timer.end(self.node.name.value)
+
+
+def createScene(root):
+    root.addObject('APIVersion', level='17.06')
+    root.addObject('RequiredPlugin', name='SofaComponentAll')
+    root.addObject('RequiredPlugin', name='SofaCaribou')
+
+    root.addObject('RegularGridTopology', name='grid', min=[-width/2, -width/2, 0], max=[width/2, width/2, length], n=[nx, ny, nz])
+
+    for m in materials:
+        meca = root.addChild(m['name'])
+        meca.addObject(Controller(meca))
+        meca.addObject('StaticODESolver', newton_iterations=number_of_newton_iterations, correction_tolerance_threshold=1e-8, residual_tolerance_threshold=1e-8)
+        meca.addObject('ConjugateGradientSolver', preconditioning_method='None', maximum_number_of_iterations=number_of_cg_iterations, residual_tolerance_threshold=1e-8)
+        meca.addObject('MechanicalObject', name='mo', position='@../grid.position')
+        meca.addObject('HexahedronSetTopologyContainer', name='mechanical_topology', src='@../grid')
+        meca.addObject(m['material'], **m['arguments'])
+        meca.addObject('HyperelasticForcefield')
+
+        meca.addObject('BoxROI', name='base_roi', box=[-width/2-eps, -width/2-eps, -eps, width/2+eps, width/2+eps, eps])
+        meca.addObject('BoxROI', name='top_roi',  box=[-width/2-eps, -width/2-eps, length-eps, width/2+eps, width/2+eps, length+eps], quad='@mechanical_topology.quads')
+
+        meca.addObject('FixedConstraint', indices='@base_roi.indices')
+        meca.addObject('TractionForce', traction=[0, -1, 0], slope=1, quads='@top_roi.quadInROI')
+
+
+if __name__ == "__main__":
+    import Sofa.Simulation
+    import Sofa.Core
+    import SofaRuntime
+
+    root = Sofa.Core.Node()
+    createScene(root)
+    Sofa.Simulation.init(root)
+    Sofa.Simulation.animate(root, 1)
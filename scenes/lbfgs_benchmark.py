@@ -0,0 +1,96 @@
+#!/usr/bin/python3
+
+# Compare the L-BFGS static solver (LBFGSODESolver, no tangent stiffness) to Newton + CG (StaticODESolver and
+# ConjugateGradientSolver) on the hexahedral Neo-Hookean beam of HyperelasticForcefield.py. Each child node solves
+# the same problem with a different solver. At every load increment, the time spent in the solver, its number of
+# iterations (newton or L-BFGS) and its final residual ratio are printed.
+
+import re
+import Sofa
+from SofaRuntime import Timer
+
+increments = 10
+residual_tolerance_threshold = 1e-8
+
+poissonRatio = 0
+youngModulus = 3000
+
+solvers = [
+    {'name': 'NewtonCG',   'ode': 'StaticODESolver', 'arguments': {'newton_iterations': 25, 'correction_tolerance_threshold': -1}, 'linear_solver': {'preconditioning_method': 'Diagonal', 'maximum_number_of_iterations': 1000, 'residual_tolerance_threshold': 1e-10}},
+    {'name': 'NewtonCGmf', 'ode': 'StaticODESolver', 'arguments': {'newton_iterations': 25, 'correction_tolerance_threshold': -1}, 'linear_solver': {'preconditioning_method': 'NodeBlockJacobi', 'maximum_number_of_iterations': 1000, 'residual_tolerance_threshold': 1e-10}},
+    {'name': 'LBFGS',      'ode': 'LBFGSODESolver',  'arguments': {'preconditioner': 'None', 'iterations': 10000}},
+    {'name': 'LBFGSK0',    'ode': 'LBFGSODESolver',  'arguments': {'preconditioner': 'InitialStiffness', 'iterations': 10000}},
+    {'name': 'LBFGSbJac',  'ode': 'LBFGSODESolver',  'arguments': {'preconditioner': 'NodeBlockJacobi', 'iterations': 10000}},
+]
+
+
+class Controller(Sofa.Core.Controller):
+    def __init__(self, ode_solvers):
+        super().__init__(self)
+        self.ode_solvers = ode_solvers
+        self.step = 0
+
+    def onAnimateBeginEvent(self, e):
+        Timer.setEnabled("lbfgs_timer", True)
+        Timer.begin("lbfgs_timer")
+
+    def onAnimateEndEvent(self, e):
+        records = Timer.getRecords("lbfgs_timer")
+        self.step += 1
+        print(f"Load increment #{self.step}")
+        print("{: <12}|{: ^12}|{: ^12}|{: ^12}|{: ^12}".format('', 'Time (ms)', 'Iterations', '|R|/|R0|', 'Converged'))
+        for k, v in zip(records['AnimateVisitor'].keys(), records['AnimateVisitor'].values()):
+            match = re.search('Mechanical \((.*)\)', k)
+            if match is None:
+                continue
+            name = match.group(1)
+            solve_record = v['StaticODESolver::Solve'] if 'StaticODESolver::Solve' in v else v['LBFGSODESolver::Solve']
+            ode_solver = self.ode_solvers[name]
+            residuals = ode_solver.findData('residuals').value
+            print("{: <12}|{: ^12.1f}|{: ^12}|{: ^12.2e}|{: ^12}".format(
+                name, solve_record['total_time'], len(residuals) - 1,
+                residuals[-1] / residuals[0] if residuals[0] > 0 else 0.,
+                str(ode_solver.findData('converged').value)))
+        Timer.end("lbfgs_timer")
+
+
+def createScene(root):
+    root.addObject('APIVersion', level='17.06')
+
+    root.addObject('RequiredPlugin', name='SofaComponentAll')
+    root.addObject('RequiredPlugin', name='SofaCaribou')
+
+    root.addObject('RegularGridTopology', name='mesh', min=[-7.5, -7.5, 0], max=[7.5, 7.5, 80], n=[9, 9, 21])
+
+    ode_solvers = {}
+    for s in solvers:
+        meca = root.addChild(s['name'])
+        ode_solvers[s['name']] = meca.addObject(s['ode'], residual_tolerance_threshold=residual_tolerance_threshold, printLog=False, **s['arguments'])
+        if 'linear_solver' in s:
+            meca.addObject('ConjugateGradientSolver', **s['linear_solver'])
+
+        meca.addObject('MechanicalObject', src='@../mesh')
+        meca.addObject('HexahedronSetTopologyContainer', name='topo', src='@../mesh')
+        meca.addObject('NeoHookeanMaterial', young_modulus=youngModulus, poisson_ratio=poissonRatio)
+        meca.addObject('HyperelasticForcefield', template="Hexahedron")
+
+        meca.addObject('BoxROI', name='fixed_roi', box=[-7.5, -7.5, -0.9, 7.5, 7.5, 0.1])
+        meca.addObject('FixedConstraint', indices='@fixed_roi.indices')
+
+        meca.addObject('BoxROI', name='top_roi', box=[-7.5, -7.5, 79.9, 7.5, 7.5, 80.1])
+        meca.addObject('QuadSetTopologyContainer', name='quad_container', quads='@top_roi.quadInROI')
+        meca.addObject('TractionForce', traction=[0, -30, 0], slope=1/increments, quads='@quad_container.quads')
+
+    root.addObject(Controller(ode_solvers))
+
+
+if __name__ == "__main__":
+    import Sofa.Simulation
+    import Sofa.Core
+    import SofaRuntime
+
+    root = Sofa.Core.Node()
+    createScene(root)
+    Sofa.Simulation.init(root)
+    for _ in range(increments):
+        Sofa.Simulation.animate(root, 1)
@@ -0,0 +1,73 @@
+#!/usr/bin/python3
+
+# Mean CG iteration time (matrix-free, preconditioning_method=None) of the HyperelasticForcefield, the
+# HexahedronElasticForce and the TetrahedronElasticForce w.r.t the number of threads. Each child node solves the same
+# problem with one of the forcefields and a different value of its 'number_of_threads' parameter.
+# Caribou must be compiled with OpenMP (CARIBOU_WITH_OPENMP).
+
+import Sofa
+from conjugate_gradient_benchmark import Controller
+
+number_of_threads = [1, 2, 4, 8, 16, 32]
+forcefields = ['Hyperelastic', 'Hexahedron', 'Tetrahedron']
+number_of_newton_iterations = 3
+number_of_cg_iterations = 1000
+threshold = 1e-15
+cell_size = 1.5
+radius = 5
+length = 60
+
+nx = int(2*radius / cell_size)+1
+nz = int(length / cell_size) + 1
+eps = cell_size/10
+
+
+def createScene(root):
+    root.addObject(Controller())
+    root.addObject('APIVersion', level='17.06')
+
+    root.addObject('RequiredPlugin', name='SofaComponentAll')
+    root.addObject('RequiredPlugin', name='SofaCaribou')
+
+    root.addObject('RegularGridTopology', name='grid', min=[-radius, -radius, -length/2], max=[radius, radius, length/2], n=[nx, nx, nz])
+
+    for forcefield in forcefields:
+        for n in number_of_threads:
+            meca = root.addChild('{}_{}_threads'.format(forcefield, n))
+            meca.addObject('StaticODESolver', newton_iterations=number_of_newton_iterations, correction_tolerance_threshold=1e-8, residual_tolerance_threshold=1e-8, printLog=False)
+            meca.addObject('ConjugateGradientSolver', preconditioning_method='None', maximum_number_of_iterations=number_of_cg_iterations, residual_tolerance_threshold=threshold)
+
+            meca.addObject('MechanicalObject', name='mo', position='@../grid.position')
+            if forcefield == 'Tetrahedron':
+                meca.addObject('TetrahedronSetTopologyContainer', name='mechanical_topology')
+                meca.addObject('TetrahedronSetTopologyModifier')
+                meca.addObject('Hexa2TetraTopologicalMapping', input='@../grid', output='@mechanical_topology', swapping=True)
+                meca.addObject('TetrahedronElasticForce', youngModulus=3000, poissonRatio=0, corotated=False, linearStrain=False, number_of_threads=n)
+            else:
+                meca.addObject('HexahedronSetTopologyContainer', name='mechanical_topology', src='@../grid')
+                if forcefield == 'Hexahedron':
+                    meca.addObject('HexahedronElasticForce', youngModulus=3000, poissonRatio=0, corotated=False, linearStrain=False, number_of_threads=n)
+                else:
+                    meca.addObject('SaintVenantKirchhoffMaterial', young_modulus=3000, poisson_ratio=0)
+                    meca.addObject('HyperelasticForcefield', number_of_threads=n)
+
+            meca.addObject('BoxROI', name='base_roi', box=[-radius-eps, -radius-eps, -length/2-eps, radius+eps, radius+eps, -length/2+eps])
+            meca.addObject('FixedConstraint', indices='@base_roi.indices')
+
+            top_box = [-radius-eps, -radius-eps, +length/2-eps, radius+eps, radius+eps, +length/2+eps]
+            if forcefield == 'Tetrahedron':
+                meca.addObject('BoxROI', name='top_roi', box=top_box)
+                meca.addObject('TractionForce', traction=[0, -30, 0], slope=1/5, triangles='@top_roi.trianglesInROI')
+            else:
+                meca.addObject('BoxROI', name='top_roi', box=top_box, quad='@mechanical_topology.quads')
+                meca.addObject('TractionForce', traction=[0, -30, 0], slope=1/5, quads='@top_roi.quadInROI')
+
+if __name__ == "__main__":
+    import Sofa.Simulation
+    import Sofa.Core
+    import SofaRuntime
+
+    root = Sofa.Core.Node()
+    createScene(root)
+    Sofa.Simulation.init(root)
+    Sofa.Simulation.animate(root, 1)
@@ -0,0 +1,58 @@
+#!/usr/bin/python3
+
+# Memory footprint of the element tangent stiffness and mean CG iteration time (matrix-free CG,
+# preconditioning_method=None) of the HyperelasticForcefield w.r.t its 'tangent_storage' parameter. Each child node
+# solves the same problem with a different storage. The memory used by each storage is printed by the forcefield
+# during its initialization.
+
+import Sofa
+from conjugate_gradient_benchmark import Controller
+
+tangent_storages = ['Dense', 'PackedSymmetric', 'MatrixFree']
+number_of_newton_iterations = 3
+number_of_cg_iterations = 1000
+threshold = 1e-15
+cell_size = 1.5
+radius = 5
+length = 60
+
+nx = int(2*radius / cell_size)+1
+nz = int(length / cell_size) + 1
+eps = cell_size/10
+
+
+def createScene(root):
+    root.addObject(Controller())
+    root.addObject('APIVersion', level='17.06')
+
+    root.addObject('RequiredPlugin', name='SofaComponentAll')
+    root.addObject('RequiredPlugin', name='SofaCaribou')
+
+    root.addObject('RegularGridTopology', name='grid', min=[-radius, -radius, -length/2], max=[radius, radius, length/2], n=[nx, nx, nz])
+
+    for storage in tangent_storages:
+        meca = root.addChild(storage)
+        meca.addObject('StaticODESolver', newton_iterations=number_of_newton_iterations, correction_tolerance_threshold=1e-8, residual_tolerance_threshold=1e-8, printLog=False)
+        meca.addObject('ConjugateGradientSolver', preconditioning_method='None', maximum_number_of_iterations=number_of_cg_iterations, residual_tolerance_threshold=threshold)
+
+        meca.addObject('MechanicalObject', name='mo', position='@../grid.position')
+        meca.addObject('HexahedronSetTopologyContainer', name='mechanical_topology', src='@../grid')
+        meca.addObject('SaintVenantKirchhoffMaterial', young_modulus=3000, poisson_ratio=0.3)
+        meca.addObject('HyperelasticForcefield', tangent_storage=storage, printLog=True)
+
+        meca.addObject('BoxROI', name='base_roi', box=[-radius-eps, -radius-eps, -length/2-eps, radius+eps, radius+eps, -length/2+eps])
+        meca.addObject('BoxROI', name='top_roi',  box=[-radius-eps, -radius-eps, +length/2-eps, radius+eps, radius+eps, +length/2+eps], quad='@mechanical_topology.quads')
+
+        meca.addObject('FixedConstraint', indices='@base_roi.indices')
+        meca.addObject('TractionForce', traction=[0, -30, 0], slope=1/5, quads='@top_roi.quadInROI')
+
+
+if __name__ == "__main__":
+    import Sofa.Simulation
+    import Sofa.Core
+    import SofaRuntime
+
+    root = Sofa.Core.Node()
+    createScene(root)
+    Sofa.Simulation.init(root)
+    Sofa.Simulation.animate(root, 1)
@@ -0,0 +1,69 @@
+#ifndef CARIBOU_TOPOLOGY_ELEMENTCOLORING_H
+#define CARIBOU_TOPOLOGY_ELEMENTCOLORING_H
+
+#include <Caribou/config.h>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+namespace caribou::topology {
+
+/**
+ * Partition a set of elements into colors such that two elements of the same color never share a node.
+ *
+ * The coloring is order-preserving: the color of an element is one plus the highest color of the previous elements
+ * (w.r.t. their index) sharing one of its nodes. Hence, the elements sharing a given node always have strictly
+ * increasing colors in the same order as their indices. Processing the colors one after the other (while the
+ * elements of a same color are processed concurrently) therefore accumulates the nodal contributions in exactly
+ * the same order than a sequential loop over the elements, which gives bitwise identical results.
+ *
+ * This comes at the price of more colors than a greedy coloring would give (roughly the length of the mesh
+ * diagonal, in number of elements, for a structured mesh), which is usually still much lower than the number
+ * of elements per color.
+ *
+ * @param number_of_elements The number of elements.
+ * @param number_of_nodes_per_element The number of nodes of each element.
+ * @param element_nodes A callable where element_nodes(element_id)[i] is the index of the ith node of the element.
+ * @return The list of colors, each color being the list of its element indices in increasing order.
+ */
+template <typename ElementNodesGetter>
+auto color_elements(const std::size_t & number_of_elements,
+                    const std::size_t & number_of_nodes_per_element,
+                    const ElementNodesGetter & element_nodes) -> std::vector<std::vector<std::size_t>>
+{
+    // Highest color (plus one) of the elements visited so far that contain a given node, 0 if none
+    std::vector<std::size_t> node_next_color;
+    std::vector<std::size_t> element_color (number_of_elements);
+    std::size_t number_of_colors = 0;
+
+    for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+        const auto & nodes = element_nodes(element_id);
+
+        std::size_t color = 0;
+        for (std::size_t i = 0; i < number_of_nodes_per_element; ++i) {
+            const auto node_id = static_cast<std::size_t>(nodes[i]);
+            if (node_id >= node_next_color.size()) {
+                node_next_color.resize(node_id+1, 0);
+            }
+            color = std::max(color, node_next_color[node_id]);
+        }
+
+        for (std::size_t i = 0; i < number_of_nodes_per_element; ++i) {
+            node_next_color[static_cast<std::size_t>(nodes[i])] = color+1;
+        }
+
+        element_color[element_id] = color;
+        number_of_colors = std::max(number_of_colors, color+1);
+    }
+
+    std::vector<std::vector<std::size_t>> colors (number_of_colors);
+    for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+        colors[element_color[element_id]].emplace_back(element_id);
+    }
+
+    return colors;
+}
+
+} // namespace caribou::topology
+
+#endif //CARIBOU_TOPOLOGY_ELEMENTCOLORING_H
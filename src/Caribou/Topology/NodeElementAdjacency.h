@@ -0,0 +1,121 @@
+#ifndef CARIBOU_TOPOLOGY_NODEELEMENTADJACENCY_H
+#define CARIBOU_TOPOLOGY_NODEELEMENTADJACENCY_H
+
+#include <Caribou/config.h>
+#include <vector>
+#include <cstddef>
+
+namespace caribou::topology {
+
+/**
+ * Compressed (CSR) adjacency table giving, for each node, the list of elements containing it together with the
+ * local index of the node inside each of these elements.
+ *
+ * The elements of a node are sorted by increasing element index. This table is typically used to gather the
+ * elemental contributions of a node (one node per thread) instead of scattering the contributions of each element
+ * to its nodes, which avoids any write conflict when the nodes are processed concurrently. Since the contributions
+ * are gathered in the element order, the result is identical to a sequential scatter over the elements.
+ *
+ * Example:
+ * \code{.cpp}
+ * NodeElementAdjacency adjacency (nb_nodes, nb_elements, 4, [&](std::size_t e) {return tetrahedra[e];});
+ * for (std::size_t node_id = 0; node_id < adjacency.number_of_nodes(); ++node_id) {
+ *     for (auto k = adjacency.begin(node_id); k < adjacency.end(node_id); ++k) {
+ *         const auto & [element_id, local_node_id] = adjacency[k];
+ *         // ...
+ *     }
+ * }
+ * \endcode
+ */
+class NodeElementAdjacency {
+public:
+    struct Entry {
+        std::size_t element_id;    ///< Index of the element containing the node
+        std::size_t local_node_id; ///< Index of the node inside the element (between 0 and #nodes per element - 1)
+    };
+
+    NodeElementAdjacency() = default;
+
+    /**
+     * Build the adjacency table.
+     *
+     * @param number_of_nodes The number of nodes (the table will be extended if an element contains a node with a
+     *                        greater index).
+     * @param number_of_elements The number of elements.
+     * @param number_of_nodes_per_element The number of nodes of each element.
+     * @param element_nodes A callable where element_nodes(element_id)[i] is the index of the ith node of the element.
+     */
+    template <typename ElementNodesGetter>
+    NodeElementAdjacency(const std::size_t & number_of_nodes,
+                         const std::size_t & number_of_elements,
+                         const std::size_t & number_of_nodes_per_element,
+                         const ElementNodesGetter & element_nodes)
+    {
+        // First pass: count the number of elements of each node
+        p_offsets.resize(number_of_nodes+1, 0);
+        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            const auto & nodes = element_nodes(element_id);
+            for (std::size_t i = 0; i < number_of_nodes_per_element; ++i) {
+                const auto node_id = static_cast<std::size_t>(nodes[i]);
+                if (node_id+1 >= p_offsets.size()) {
+                    p_offsets.resize(node_id+2, 0);
+                }
+                p_offsets[node_id+1]++;
+            }
+        }
+
+        // Prefix sum of the counts
+        for (std::size_t node_id = 1; node_id < p_offsets.size(); ++node_id) {
+            p_offsets[node_id] += p_offsets[node_id-1];
+        }
+
+        // Second pass: fill the entries following the element order
+        p_entries.resize(p_offsets.back());
+        std::vector<std::size_t> position (p_offsets.begin(), p_offsets.end()-1);
+        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            const auto & nodes = element_nodes(element_id);
+            for (std::size_t i = 0; i < number_of_nodes_per_element; ++i) {
+                const auto node_id = static_cast<std::size_t>(nodes[i]);
+                p_entries[position[node_id]++] = {element_id, i};
+            }
+        }
+    }
+
+    /** Number of nodes of the table */
+    [[nodiscard]] inline
+    auto number_of_nodes() const -> std::size_t {
+        return (p_offsets.empty()) ? 0 : p_offsets.size() - 1;
+    }
+
+    /** Position of the first entry of the given node */
+    [[nodiscard]] inline
+    auto begin(const std::size_t & node_id) const -> std::size_t {
+        return p_offsets[node_id];
+    }
+
+    /** Position following the last entry of the given node */
+    [[nodiscard]] inline
+    auto end(const std::size_t & node_id) const -> std::size_t {
+        return p_offsets[node_id+1];
+    }
+
+    /** Get the entry (element index and local node index) at the given position */
+    [[nodiscard]] inline
+    auto operator[](const std::size_t & position) const -> const Entry & {
+        return p_entries[position];
+    }
+
+    /** Total number of entries (sum of the number of nodes of every elements) */
+    [[nodiscard]] inline
+    auto size() const -> std::size_t {
+        return p_entries.size();
+    }
+
+private:
+    std::vector<std::size_t> p_offsets;
+    std::vector<Entry> p_entries;
+};
+
+} // namespace caribou::topology
+
+#endif //CARIBOU_TOPOLOGY_NODEELEMENTADJACENCY_H
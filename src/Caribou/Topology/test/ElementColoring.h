@@ -0,0 +1,59 @@
+#ifndef CARIBOU_TOPOLOGY_TEST_ELEMENTCOLORING_H
+#define CARIBOU_TOPOLOGY_TEST_ELEMENTCOLORING_H
+
+#include <Caribou/Topology/ElementColoring.h>
+#include <Caribou/Topology/Grid/Grid.h>
+#include <vector>
+#include <array>
+
+TEST(Topology_ElementColoring, Grid3D) {
+    using namespace caribou::topology;
+    using Grid = Grid<3>;
+
+    Grid grid(Grid::WorldCoordinates{0, 0, 0}, Grid::Subdivisions{3, 4, 5}, Grid::Dimensions{3, 4, 5});
+    const auto nb_elements = static_cast<std::size_t>(grid.number_of_cells());
+
+    const auto colors = color_elements(nb_elements, 8, [&grid](const std::size_t & element_id) {
+        return grid.node_indices_of(static_cast<Grid::CellIndex>(element_id));
+    });
+
+    // Every element has exactly one color
+    std::vector<std::size_t> element_color (nb_elements, colors.size());
+    for (std::size_t color = 0; color < colors.size(); ++color) {
+        for (const auto & element_id : colors[color]) {
+            EXPECT_EQ(element_color[element_id], colors.size());
+            element_color[element_id] = color;
+        }
+    }
+    for (const auto & color : element_color) {
+        EXPECT_LT(color, colors.size());
+    }
+
+    // Elements sharing a node have strictly increasing colors following their indices
+    std::vector<std::size_t> node_last_color (grid.number_of_nodes(), 0);
+    std::vector<bool> node_visited (grid.number_of_nodes(), false);
+    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+        for (const auto & node_id : grid.node_indices_of(static_cast<Grid::CellIndex>(element_id))) {
+            if (node_visited[node_id]) {
+                EXPECT_GT(element_color[element_id], node_last_color[node_id]);
+            }
+            node_visited[node_id] = true;
+            node_last_color[node_id] = element_color[element_id];
+        }
+    }
+}
+
+TEST(Topology_ElementColoring, Disjoint) {
+    using namespace caribou::topology;
+
+    // Disjoint elements all share the first color
+    const std::vector<std::array<unsigned int, 2>> segments = {{0, 1}, {2, 3}, {4, 5}};
+    const auto colors = color_elements(segments.size(), 2, [&segments](const std::size_t & i) {
+        return segments[i];
+    });
+
+    ASSERT_EQ(colors.size(), (std::size_t) 1);
+    EXPECT_EQ(colors[0], (std::vector<std::size_t>{0, 1, 2}));
+}
+
+#endif //CARIBOU_TOPOLOGY_TEST_ELEMENTCOLORING_H
@@ -0,0 +1,42 @@
+#ifndef CARIBOU_TOPOLOGY_TEST_NODEELEMENTADJACENCY_H
+#define CARIBOU_TOPOLOGY_TEST_NODEELEMENTADJACENCY_H
+
+#include <Caribou/Topology/NodeElementAdjacency.h>
+#include <Caribou/Topology/Grid/Grid.h>
+#include <vector>
+
+TEST(Topology_NodeElementAdjacency, Grid2D) {
+    using namespace caribou::topology;
+    using Grid = Grid<2>;
+
+    // 2x2 cells, 3x3 nodes
+    Grid grid(Grid::WorldCoordinates{0, 0}, Grid::Subdivisions{2, 2}, Grid::Dimensions{2, 2});
+    const auto nb_elements = static_cast<std::size_t>(grid.number_of_cells());
+
+    NodeElementAdjacency adjacency (grid.number_of_nodes(), nb_elements, 4, [&grid](const std::size_t & element_id) {
+        return grid.node_indices_of(static_cast<Grid::CellIndex>(element_id));
+    });
+
+    EXPECT_EQ(adjacency.number_of_nodes(), (std::size_t) 9);
+    EXPECT_EQ(adjacency.size(), (std::size_t) 16);
+
+    // Corner nodes have one element, edge nodes two and the center node four
+    const std::vector<std::size_t> expected_counts = {1, 2, 1, 2, 4, 2, 1, 2, 1};
+    for (std::size_t node_id = 0; node_id < 9; ++node_id) {
+        EXPECT_EQ(adjacency.end(node_id) - adjacency.begin(node_id), expected_counts[node_id]);
+    }
+
+    // Every entry points back to its node, and elements are sorted
+    for (std::size_t node_id = 0; node_id < adjacency.number_of_nodes(); ++node_id) {
+        for (auto k = adjacency.begin(node_id); k < adjacency.end(node_id); ++k) {
+            const auto & entry = adjacency[k];
+            const auto nodes = grid.node_indices_of(static_cast<Grid::CellIndex>(entry.element_id));
+            EXPECT_EQ(static_cast<std::size_t>(nodes[entry.local_node_id]), node_id);
+            if (k > adjacency.begin(node_id)) {
+                EXPECT_LT(adjacency[k-1].element_id, entry.element_id);
+            }
+        }
+    }
+}
+
+#endif //CARIBOU_TOPOLOGY_TEST_NODEELEMENTADJACENCY_H
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "Grid/Grid.h"
+#include "ElementColoring.h"
+#include "NodeElementAdjacency.h"
 
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <utility>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Double-buffered preconditioner which can be factorized on a background thread while it is still being used.
+ *
+ * Two instances of the preconditioner are kept. The current one is used to solve, and is the one factorized by the
+ * synchronous calls (analyzePattern, factorize, compute). A call to start_factorization copies the matrix, and
+ * factorizes the second instance with this copy on a background thread, hence the matrix and the current
+ * preconditioner can be freely used while the factorization is running. Once the factorization is completed, the
+ * two instances are swapped by calling swap_if_ready from the thread using the preconditioner (usually, right
+ * before a solve).
+ *
+ * The preconditioner must have the interface of Eigen's preconditioners (analyzePattern, factorize, solve, info).
+ * Since Eigen's sparse preconditioners aren't copyable, the background instance analyzes the pattern of the matrix
+ * before factorizing it.
+ *
+ * @example
+ * \code{.cpp}
+ *    AsynchronousPreconditioner<Eigen::IncompleteCholesky<double>> ichol;
+ *    ichol.compute(A);
+ *    ichol.start_factorization(A_next);
+ *    // ... solves with ichol.current() ...
+ *    if (ichol.swap_if_ready()) {
+ *        // ichol.current() is now the factorization of A_next
+ *    }
+ * \endcode
+ */
+template <typename Preconditioner>
+class AsynchronousPreconditioner {
+public:
+    AsynchronousPreconditioner()
+    : p_current(std::make_unique<Preconditioner>())
+    , p_next(std::make_unique<Preconditioner>())
+    {}
+
+    AsynchronousPreconditioner(const AsynchronousPreconditioner &) = delete;
+    AsynchronousPreconditioner & operator=(const AsynchronousPreconditioner &) = delete;
+
+    /** Wait for the background factorization (if any) before destroying the preconditioner it is building. */
+    ~AsynchronousPreconditioner() { cancel(); }
+
+    /** The preconditioner currently in use */
+    inline Preconditioner & current() { return *p_current; }
+    inline const Preconditioner & current() const { return *p_current; }
+
+    /** Analyze the pattern of A with the current preconditioner. A background factorization is canceled first. */
+    template <typename Matrix>
+    AsynchronousPreconditioner & analyzePattern(const Matrix & A) {
+        cancel();
+        p_current->analyzePattern(A);
+        return *this;
+    }
+
+    /** Factorize the current preconditioner. A background factorization is canceled first. */
+    template <typename Matrix>
+    AsynchronousPreconditioner & factorize(const Matrix & A) {
+        cancel();
+        p_current->factorize(A);
+        return *this;
+    }
+
+    template <typename Matrix>
+    AsynchronousPreconditioner & compute(const Matrix & A) {
+        analyzePattern(A);
+        return factorize(A);
+    }
+
+    template <typename Derived>
+    inline auto solve(const Derived & b) const { return p_current->solve(b); }
+
+    inline auto info() const { return p_current->info(); }
+
+    /** Whether or not a background factorization has been started and not swapped in (or canceled) yet. */
+    inline bool running() const { return p_job.valid(); }
+
+    /** Whether or not the background factorization is completed and ready to be swapped in. */
+    inline bool ready() const {
+        return p_job.valid() and p_job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    /**
+     * Start the factorization of a copy of the matrix A on a background thread. A factorization already running
+     * is canceled first.
+     */
+    template <typename Matrix>
+    void start_factorization(const Matrix & A) {
+        cancel();
+        p_job = std::async(std::launch::async, [next = p_next.get(), A]() {
+            next->analyzePattern(A);
+            next->factorize(A);
+        });
+    }
+
+    /**
+     * If the background factorization is completed, swap it with the current preconditioner.
+     * @return True if the current preconditioner has been replaced, false otherwise.
+     */
+    bool swap_if_ready() {
+        if (not ready()) {
+            return false;
+        }
+        p_job.get();
+        std::swap(p_current, p_next);
+        return true;
+    }
+
+    /** Wait for the background factorization (if any) and discard its result. */
+    void cancel() {
+        if (p_job.valid()) {
+            p_job.wait();
+            p_job = {};
+        }
+    }
+
+private:
+    ///< The preconditioner currently in use
+    std::unique_ptr<Preconditioner> p_current;
+
+    ///< The preconditioner factorized on the background thread
+    std::unique_ptr<Preconditioner> p_next;
+
+    ///< The background factorization
+    std::future<void> p_job;
+};
+
+} // namespace SofaCaribou::Algebra
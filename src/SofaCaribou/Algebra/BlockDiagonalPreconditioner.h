@@ -0,0 +1,105 @@
+#pragma once
+
+#include <SofaCaribou/Algebra/BlockSparseMatrix.h>
+#include <Eigen/LU>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Block Jacobi preconditioner of a BlockSparseMatrix.
+ *
+ * The preconditioner approximates the matrix A by its diagonal blocks. Each diagonal block is inverted during the
+ * factorization, and the preconditioner is applied with a block-diagonal matrix-vector product. A singular diagonal
+ * block falls back to the inverse of its diagonal entries (a null diagonal entry being replaced by one), as done
+ * by Eigen::DiagonalPreconditioner.
+ *
+ * The interface follows the one of Eigen's preconditioners (analyzePattern, factorize, compute, solve, info).
+ */
+template <typename Scalar, int BlockSize>
+class BlockDiagonalPreconditioner {
+public:
+    using MatrixType = BlockSparseMatrix<Scalar, BlockSize>;
+    using Index = typename MatrixType::Index;
+    using Block = typename MatrixType::Block;
+    using BlockVector = typename MatrixType::BlockVector;
+    using Vector = typename MatrixType::Vector;
+
+    BlockDiagonalPreconditioner() = default;
+
+    inline Index rows() const { return static_cast<Index>(p_inverse_blocks.size())*BlockSize; }
+    inline Index cols() const { return rows(); }
+
+    /** Nothing to analyze, the diagonal blocks are always found from the pattern of A. */
+    BlockDiagonalPreconditioner & analyzePattern(const MatrixType &) {
+        return *this;
+    }
+
+    /** Invert the diagonal blocks of A. */
+    BlockDiagonalPreconditioner & factorize(const MatrixType & A) {
+        const auto nb_block_rows = A.block_rows();
+        p_inverse_blocks.resize(nb_block_rows);
+
+#pragma omp parallel for schedule(static)
+        for (Index i = 0; i < nb_block_rows; ++i) {
+            const Block * diagonal_block = A.find_block(i, i);
+            p_inverse_blocks[i] = inverse((diagonal_block) ? *diagonal_block : Block::Zero());
+        }
+
+        return *this;
+    }
+
+    /**
+     * Invert the given diagonal blocks. This is used when the diagonal blocks are computed directly (for example,
+     * by the forcefields) without assembling the matrix.
+     */
+    BlockDiagonalPreconditioner & factorize(const std::vector<Block, Eigen::aligned_allocator<Block>> & diagonal_blocks) {
+        const auto nb_block_rows = static_cast<Index>(diagonal_blocks.size());
+        p_inverse_blocks.resize(nb_block_rows);
+
+#pragma omp parallel for schedule(static)
+        for (Index i = 0; i < nb_block_rows; ++i) {
+            p_inverse_blocks[i] = inverse(diagonal_blocks[i]);
+        }
+
+        return *this;
+    }
+
+    BlockDiagonalPreconditioner & compute(const MatrixType & A) {
+        return factorize(A);
+    }
+
+    /** Compute x = D^-1 b */
+    template <typename Derived>
+    Vector solve(const Eigen::MatrixBase<Derived> & b) const {
+        caribou_assert(b.size() == rows());
+        Vector x(b.size());
+        const auto nb_block_rows = static_cast<Index>(p_inverse_blocks.size());
+#pragma omp parallel for schedule(static)
+        for (Index i = 0; i < nb_block_rows; ++i) {
+            x.template segment<BlockSize>(i*BlockSize).noalias() = p_inverse_blocks[i] * b.template segment<BlockSize>(i*BlockSize);
+        }
+        return x;
+    }
+
+    Eigen::ComputationInfo info() const { return Eigen::Success; }
+
+private:
+    /** Inverse of the diagonal block D, or of its diagonal entries if D is singular. */
+    static Block inverse(const Block & D) {
+        bool invertible = false;
+        Block inverse;
+        D.computeInverseWithCheck(inverse, invertible);
+        if (not invertible) {
+            inverse.setZero();
+            for (Index k = 0; k < BlockSize; ++k) {
+                inverse(k, k) = (D(k, k) != Scalar(0)) ? Scalar(1) / D(k, k) : Scalar(1);
+            }
+        }
+        return inverse;
+    }
+
+    ///< Inverse of the diagonal blocks
+    std::vector<Block, Eigen::aligned_allocator<Block>> p_inverse_blocks;
+};
+
+} // namespace SofaCaribou::Algebra
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <SofaCaribou/Algebra/BlockSparseMatrix.h>
+#include <Eigen/Cholesky>
+#include <cmath>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Block incomplete Cholesky factorization with zero fill-in, IC(0), of a symmetric positive definite BlockSparseMatrix.
+ *
+ * The lower block triangular factor L (A ~ L L^T) has the same block sparsity pattern as the lower triangular part
+ * of A. Its diagonal blocks are the dense Cholesky factors of the Schur complement of the diagonal blocks of A,
+ * hence the coupling between the degrees of freedom of a same node is kept exactly.
+ *
+ * If a diagonal block isn't positive definite during the factorization (the incomplete factorization may break down
+ * even when A is positive definite), the factorization is restarted with the diagonal of A scaled by (1 + shift),
+ * shift starting at 1e-3 and being doubled at each restart, similar to the strategy used by Eigen::IncompleteCholesky.
+ *
+ * Only the lower triangular part of A is read. The pattern is analyzed once (analyzePattern) and can be reused for
+ * every later factorizations of matrices having the same sparsity pattern.
+ *
+ * The interface follows the one of Eigen's preconditioners (analyzePattern, factorize, compute, solve, info).
+ */
+template <typename Scalar, int BlockSize>
+class BlockIncompleteCholesky {
+public:
+    using MatrixType = BlockSparseMatrix<Scalar, BlockSize>;
+    using Index = typename MatrixType::Index;
+    using StorageIndex = typename MatrixType::StorageIndex;
+    using Block = typename MatrixType::Block;
+    using BlockVector = typename MatrixType::BlockVector;
+    using Vector = typename MatrixType::Vector;
+
+    BlockIncompleteCholesky() = default;
+
+    inline Index rows() const { return p_nb_block_rows*BlockSize; }
+    inline Index cols() const { return rows(); }
+
+    /** Shift of the diagonal used by the last factorization (0 if no shift was needed) */
+    inline Scalar shift() const { return p_shift; }
+
+    /** Gather the block pattern of the lower triangular part of A. */
+    BlockIncompleteCholesky & analyzePattern(const MatrixType & A) {
+        p_nb_block_rows = A.block_rows();
+        const auto & row_pointers = A.row_pointers();
+        const auto & column_indices = A.column_indices();
+
+        p_row_pointers.assign(p_nb_block_rows+1, 0);
+        p_column_indices.clear();
+        p_positions.clear();
+        for (Index i = 0; i < p_nb_block_rows; ++i) {
+            for (StorageIndex k = row_pointers[i]; k < row_pointers[i+1] and column_indices[k] < i; ++k) {
+                p_column_indices.emplace_back(column_indices[k]);
+                p_positions.emplace_back(k);
+            }
+
+            // The diagonal block is always the last one of its row, even when it isn't stored in A
+            p_column_indices.emplace_back(static_cast<StorageIndex>(i));
+            p_positions.emplace_back(static_cast<StorageIndex>(A.block_position(i, i)));
+            p_row_pointers[i+1] = static_cast<StorageIndex>(p_column_indices.size());
+        }
+
+        p_blocks.resize(p_column_indices.size());
+        p_is_initialized = true;
+        p_info = Eigen::Success;
+
+        return *this;
+    }
+
+    /** Compute the incomplete factorization of A. The pattern of A must be the one given to analyzePattern. */
+    BlockIncompleteCholesky & factorize(const MatrixType & A) {
+        caribou_assert(p_is_initialized && "analyzePattern must be called before factorize.");
+
+        static constexpr unsigned int maximum_number_of_restarts = 30;
+        p_shift = 0;
+        for (unsigned int restart = 0; restart <= maximum_number_of_restarts; ++restart) {
+            if (try_factorize(A, p_shift)) {
+                p_info = Eigen::Success;
+                return *this;
+            }
+            p_shift = (p_shift == Scalar(0)) ? Scalar(1e-3) : 2*p_shift;
+        }
+
+        p_info = Eigen::NumericalIssue;
+        return *this;
+    }
+
+    BlockIncompleteCholesky & compute(const MatrixType & A) {
+        analyzePattern(A);
+        return factorize(A);
+    }
+
+    /** Compute x = (L L^T)^-1 b */
+    template <typename Derived>
+    Vector solve(const Eigen::MatrixBase<Derived> & b) const {
+        caribou_assert(b.size() == rows());
+        Vector x = b;
+
+        // Forward substitution L y = b
+        for (Index i = 0; i < p_nb_block_rows; ++i) {
+            BlockVector y_i = x.template segment<BlockSize>(i*BlockSize);
+            const auto diagonal = p_row_pointers[i+1]-1;
+            for (StorageIndex k = p_row_pointers[i]; k < diagonal; ++k) {
+                y_i.noalias() -= p_blocks[k] * x.template segment<BlockSize>(p_column_indices[k]*BlockSize);
+            }
+            p_blocks[diagonal].template triangularView<Eigen::Lower>().solveInPlace(y_i);
+            x.template segment<BlockSize>(i*BlockSize) = y_i;
+        }
+
+        // Backward substitution L^T x = y
+        for (Index i = p_nb_block_rows-1; i >= 0; --i) {
+            BlockVector x_i = x.template segment<BlockSize>(i*BlockSize);
+            const auto diagonal = p_row_pointers[i+1]-1;
+            p_blocks[diagonal].transpose().template triangularView<Eigen::Upper>().solveInPlace(x_i);
+            x.template segment<BlockSize>(i*BlockSize) = x_i;
+            for (StorageIndex k = p_row_pointers[i]; k < diagonal; ++k) {
+                x.template segment<BlockSize>(p_column_indices[k]*BlockSize).noalias() -= p_blocks[k].transpose() * x_i;
+            }
+        }
+
+        return x;
+    }
+
+    Eigen::ComputationInfo info() const { return p_info; }
+
+private:
+    /** Compute the factorization with the given diagonal shift, return false if it broke down. */
+    bool try_factorize(const MatrixType & A, const Scalar & shift) {
+        const auto & blocks = A.blocks();
+        std::vector<StorageIndex> marker(p_nb_block_rows, -1);
+
+        for (Index i = 0; i < p_nb_block_rows; ++i) {
+            const auto begin = p_row_pointers[i];
+            const auto diagonal = p_row_pointers[i+1]-1;
+
+            // Copy the blocks of the row i of A
+            for (StorageIndex k = begin; k <= diagonal; ++k) {
+                p_blocks[k] = (p_positions[k] < 0) ? Block::Zero() : blocks[p_positions[k]];
+                marker[p_column_indices[k]] = k;
+            }
+
+            // L_ij = (A_ij - sum_{k<j} L_ik L_jk^T) L_jj^-T, only for the blocks (i, k) part of the pattern
+            for (StorageIndex k = begin; k < diagonal; ++k) {
+                const auto j = p_column_indices[k];
+                const auto j_diagonal = p_row_pointers[j+1]-1;
+                Block L_ij = p_blocks[k];
+                for (StorageIndex m = p_row_pointers[j]; m < j_diagonal; ++m) {
+                    const auto position = marker[p_column_indices[m]];
+                    if (position >= 0) {
+                        L_ij.noalias() -= p_blocks[position] * p_blocks[m].transpose();
+                    }
+                }
+                p_blocks[k] = p_blocks[j_diagonal].template triangularView<Eigen::Lower>().solve(L_ij.transpose()).transpose();
+            }
+
+            // L_ii = chol(A_ii - sum_{k<i} L_ik L_ik^T)
+            Block D = p_blocks[diagonal];
+            for (Index d = 0; d < BlockSize; ++d) {
+                D(d, d) += shift * std::abs(D(d, d));
+            }
+            for (StorageIndex k = begin; k < diagonal; ++k) {
+                D.noalias() -= p_blocks[k] * p_blocks[k].transpose();
+            }
+
+            Eigen::LLT<Block> llt(D);
+            if (llt.info() != Eigen::Success) {
+                return false;
+            }
+            p_blocks[diagonal] = llt.matrixL();
+
+            for (StorageIndex k = begin; k <= diagonal; ++k) {
+                marker[p_column_indices[k]] = -1;
+            }
+        }
+
+        return true;
+    }
+
+    ///< Number of block rows of the factorized matrix
+    Index p_nb_block_rows = 0;
+
+    ///< Block sparsity pattern of the lower factor L (the diagonal block being the last one of every rows)
+    std::vector<StorageIndex> p_row_pointers;
+    std::vector<StorageIndex> p_column_indices;
+
+    ///< Position in the blocks of A of every blocks of L (-1 for a diagonal block missing in A)
+    std::vector<StorageIndex> p_positions;
+
+    ///< Blocks of the lower factor L
+    std::vector<Block, Eigen::aligned_allocator<Block>> p_blocks;
+
+    ///< Diagonal shift used by the last factorization
+    Scalar p_shift = 0;
+
+    bool p_is_initialized = false;
+    Eigen::ComputationInfo p_info = Eigen::Success;
+};
+
+} // namespace SofaCaribou::Algebra
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <Caribou/macros.h>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Block compressed sparse row (BSR) matrix made of dense BlockSize x BlockSize blocks.
+ *
+ * The matrix is stored as a list of non-zero blocks, row by row. Each block row i contains the blocks
+ * blocks()[row_pointers()[i]] to blocks()[row_pointers()[i+1]-1], which are sorted by their block column index
+ * (column_indices()). Since a single index is stored per block, the index memory is about BlockSize^2 smaller
+ * than the one of a scalar compressed sparse matrix, and the matrix-vector product works on fixed-size dense blocks.
+ *
+ * The number of rows and columns of the matrix must be a multiple of BlockSize.
+ *
+ * @example
+ * \code{.cpp}
+ *    std::vector<Eigen::Triplet<double>> triplets = {{0, 0, 1}, {1, 1, 2}, {2, 2, 3}, {5, 0, 4}};
+ *    BlockSparseMatrix<double, 3> A(6, 6);
+ *    A.set_from_triplets(triplets.begin(), triplets.end());
+ *    Eigen::VectorXd y = A * Eigen::VectorXd::Ones(6);
+ * \endcode
+ */
+template <typename Scalar_, int BlockSize_>
+class BlockSparseMatrix {
+public:
+    using Scalar = Scalar_;
+    static constexpr int BlockSize = BlockSize_;
+    using Index = Eigen::Index;
+    using StorageIndex = int;
+    using Block = Eigen::Matrix<Scalar, BlockSize, BlockSize, Eigen::RowMajor>;
+    using BlockVector = Eigen::Matrix<Scalar, BlockSize, 1>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    using Triplet = Eigen::Triplet<Scalar>;
+
+    static_assert(BlockSize > 0, "The block size must be positive.");
+
+    BlockSparseMatrix() = default;
+    BlockSparseMatrix(Index rows, Index cols) { resize(rows, cols); }
+
+    /** Number of scalar rows */
+    inline Index rows() const { return p_rows; }
+
+    /** Number of scalar columns */
+    inline Index cols() const { return p_cols; }
+
+    /** Number of block rows */
+    inline Index block_rows() const { return p_rows / BlockSize; }
+
+    /** Number of block columns */
+    inline Index block_cols() const { return p_cols / BlockSize; }
+
+    /** Number of non-zero blocks */
+    inline Index non_zero_blocks() const { return static_cast<Index>(p_blocks.size()); }
+
+    /** Index of the first block of every block rows (the last entry being the number of non-zero blocks) */
+    inline const std::vector<StorageIndex> & row_pointers() const { return p_row_pointers; }
+
+    /** Block column index of every non-zero blocks */
+    inline const std::vector<StorageIndex> & column_indices() const { return p_column_indices; }
+
+    /** The non-zero blocks */
+    inline const std::vector<Block, Eigen::aligned_allocator<Block>> & blocks() const { return p_blocks; }
+    inline std::vector<Block, Eigen::aligned_allocator<Block>> & blocks() { return p_blocks; }
+
+    /** Resize the matrix to rows x cols dimensions. This removes all the non-zero blocks. */
+    void resize(Index rows, Index cols) {
+        caribou_assert(rows % BlockSize == 0 and cols % BlockSize == 0 && "The dimensions must be a multiple of the block size.");
+        p_rows = rows;
+        p_cols = cols;
+        p_row_pointers.assign(block_rows()+1, 0);
+        p_column_indices.clear();
+        p_blocks.clear();
+    }
+
+    /** Set the values of all the non-zero blocks to zero, keeping the sparsity pattern. */
+    inline void set_zero() {
+        std::fill(p_blocks.begin(), p_blocks.end(), Block::Zero());
+    }
+
+    /** Build the matrix from a list of scalar triplets (i, j, value). Duplicated entries are summed up. */
+    template <typename InputIterator>
+    void set_from_triplets(const InputIterator & begin, const InputIterator & end) {
+        resize(p_rows, p_cols);
+        insert_from_triplets(begin, end);
+    }
+
+    /**
+     * Add a list of scalar triplets (i, j, value) to the matrix. The blocks containing entries that aren't already part
+     * of the sparsity pattern are inserted.
+     */
+    template <typename InputIterator>
+    void insert_from_triplets(const InputIterator & begin, const InputIterator & end) {
+        const auto nb_block_rows = block_rows();
+
+        // Bucket the block column indices of the triplets by block rows
+        std::vector<StorageIndex> bucket_pointers(nb_block_rows+1, 0);
+        for (auto it = begin; it != end; ++it) {
+            caribou_assert(it->row() < p_rows and it->col() < p_cols && "Entry outside of the matrix.");
+            bucket_pointers[it->row() / BlockSize + 1]++;
+        }
+        for (Index i = 0; i < nb_block_rows; ++i) {
+            bucket_pointers[i+1] += bucket_pointers[i];
+        }
+        std::vector<StorageIndex> buckets(bucket_pointers.back());
+        {
+            std::vector<StorageIndex> positions(bucket_pointers.begin(), bucket_pointers.end()-1);
+            for (auto it = begin; it != end; ++it) {
+                buckets[positions[it->row() / BlockSize]++] = static_cast<StorageIndex>(it->col() / BlockSize);
+            }
+        }
+
+        // Merge the new block columns of every block rows with the existing ones
+        std::vector<StorageIndex> row_pointers(nb_block_rows+1, 0);
+        std::vector<StorageIndex> column_indices;
+        std::vector<Block, Eigen::aligned_allocator<Block>> blocks;
+        column_indices.reserve(p_column_indices.size() + buckets.size());
+        blocks.reserve(p_blocks.size() + buckets.size());
+
+        for (Index i = 0; i < nb_block_rows; ++i) {
+            auto bucket_begin = buckets.begin() + bucket_pointers[i];
+            auto bucket_end = buckets.begin() + bucket_pointers[i+1];
+            std::sort(bucket_begin, bucket_end);
+            bucket_end = std::unique(bucket_begin, bucket_end);
+
+            StorageIndex k = p_row_pointers[i];
+            const StorageIndex k_end = p_row_pointers[i+1];
+            auto b = bucket_begin;
+            while (k < k_end or b != bucket_end) {
+                if (b == bucket_end or (k < k_end and p_column_indices[k] <= *b)) {
+                    if (b != bucket_end and p_column_indices[k] == *b) {
+                        ++b;
+                    }
+                    column_indices.emplace_back(p_column_indices[k]);
+                    blocks.emplace_back(p_blocks[k]);
+                    ++k;
+                } else {
+                    column_indices.emplace_back(*b);
+                    blocks.emplace_back(Block::Zero());
+                    ++b;
+                }
+            }
+            row_pointers[i+1] = static_cast<StorageIndex>(column_indices.size());
+        }
+
+        p_row_pointers = std::move(row_pointers);
+        p_column_indices = std::move(column_indices);
+        p_blocks = std::move(blocks);
+
+        // Accumulate the values
+        for (auto it = begin; it != end; ++it) {
+            Block * block = find_block(it->row() / BlockSize, it->col() / BlockSize);
+            (*block)(it->row() % BlockSize, it->col() % BlockSize) += it->value();
+        }
+    }
+
+    /** Get the position of the block (i, j) in the list of non-zero blocks, or -1 if it isn't a non-zero block. */
+    inline Index block_position(Index i, Index j) const {
+        const auto row_begin = p_column_indices.begin() + p_row_pointers[i];
+        const auto row_end = p_column_indices.begin() + p_row_pointers[i+1];
+        const auto it = std::lower_bound(row_begin, row_end, static_cast<StorageIndex>(j));
+        if (it == row_end or *it != j) {
+            return -1;
+        }
+        return static_cast<Index>(it - p_column_indices.begin());
+    }
+
+    /** Get the block (i, j), or nullptr if it isn't a non-zero block. */
+    inline Block * find_block(Index i, Index j) {
+        const auto k = block_position(i, j);
+        return (k < 0) ? nullptr : &p_blocks[k];
+    }
+    inline const Block * find_block(Index i, Index j) const {
+        const auto k = block_position(i, j);
+        return (k < 0) ? nullptr : &p_blocks[k];
+    }
+
+    /** Get the scalar entry (i, j). */
+    inline Scalar coeff(Index i, Index j) const {
+        const Block * block = find_block(i / BlockSize, j / BlockSize);
+        return (block) ? (*block)(i % BlockSize, j % BlockSize) : Scalar(0);
+    }
+
+    /**
+     * Compute y = A x. Each block row is computed independently (and concurrently when OpenMP is available), the
+     * product of a block and a segment of x being done with fixed-size (and vectorized) Eigen kernels.
+     */
+    void multiply(const Scalar * x, Scalar * y) const {
+        const auto nb_block_rows = block_rows();
+#pragma omp parallel for schedule(static)
+        for (Index i = 0; i < nb_block_rows; ++i) {
+            BlockVector y_i = BlockVector::Zero();
+            for (StorageIndex k = p_row_pointers[i]; k < p_row_pointers[i+1]; ++k) {
+                const Eigen::Map<const BlockVector> x_j (x + static_cast<Index>(p_column_indices[k])*BlockSize);
+                y_i.noalias() += p_blocks[k].lazyProduct(x_j);
+            }
+            Eigen::Map<BlockVector>(y + i*BlockSize) = y_i;
+        }
+    }
+
+    /**
+     * Compute the product A x. Contiguous vectors (ex. Vector, a Map or a column segment) are read in place, only the
+     * expressions and the strided vectors are first evaluated into a contiguous vector.
+     */
+    template <typename Derived>
+    Vector operator*(const Eigen::MatrixBase<Derived> & x) const {
+        caribou_assert(x.size() == p_cols);
+        Vector y(p_rows);
+        if constexpr (bool(Derived::Flags & Eigen::DirectAccessBit) and Derived::InnerStrideAtCompileTime == 1 and
+                      std::is_same<typename Derived::Scalar, Scalar>::value) {
+            multiply(x.derived().data(), y.data());
+        } else {
+            const Vector x_ = x;
+            multiply(x_.data(), y.data());
+        }
+        return y;
+    }
+
+    /** Convert the matrix to a scalar Eigen sparse matrix */
+    template <int Options = Eigen::ColMajor>
+    Eigen::SparseMatrix<Scalar, Options> to_sparse() const {
+        std::vector<Triplet> triplets;
+        triplets.reserve(p_blocks.size()*BlockSize*BlockSize);
+        for (Index i = 0; i < block_rows(); ++i) {
+            for (StorageIndex k = p_row_pointers[i]; k < p_row_pointers[i+1]; ++k) {
+                for (Index r = 0; r < BlockSize; ++r) {
+                    for (Index c = 0; c < BlockSize; ++c) {
+                        triplets.emplace_back(i*BlockSize + r, p_column_indices[k]*BlockSize + c, p_blocks[k](r, c));
+                    }
+                }
+            }
+        }
+        Eigen::SparseMatrix<Scalar, Options> m(p_rows, p_cols);
+        m.setFromTriplets(triplets.begin(), triplets.end());
+        return m;
+    }
+
+private:
+    ///< Number of scalar rows and columns
+    Index p_rows = 0;
+    Index p_cols = 0;
+
+    ///< Index of the first non-zero block of every block rows
+    std::vector<StorageIndex> p_row_pointers = {0};
+
+    ///< Block column index of every non-zero blocks
+    std::vector<StorageIndex> p_column_indices;
+
+    ///< Non-zero blocks
+    std::vector<Block, Eigen::aligned_allocator<Block>> p_blocks;
+};
+
+} // namespace SofaCaribou::Algebra
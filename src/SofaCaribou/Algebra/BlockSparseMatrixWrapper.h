@@ -0,0 +1,323 @@
+#pragma once
+
+#include <Caribou/macros.h>
+#include <sofa/defaulttype/BaseMatrix.h>
+#include <SofaCaribou/Algebra/BlockSparseMatrix.h>
+#include <type_traits>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * The BlockSparseMatrixWrapper implements the BaseMatrix class of Sofa on top of a BlockSparseMatrix. It can
+ * either map or copy an existing block sparse matrix, and behaves like the wrapper around Eigen sparse matrices
+ * (see EigenMatrixWrapper):
+ *
+ *   1. Before the first call to compress (or set), the entries added are accumulated into a list of triplets, which
+ *      is used to build the matrix during the call to compress.
+ *   2. Once the matrix is built, the entries are accumulated directly into the existing blocks. The 3x3 (or 2x2)
+ *      blocks aligned with the blocks of the matrix are added in a single block operation.
+ *   3. An entry that isn't part of the sparsity pattern is stored in the triplets list, and the matrix is rebuilt
+ *      with these new entries during the next call to compress.
+ *
+ * @example
+ * \code{.cpp}
+ *    BlockSparseMatrix<double, 3> A;
+ *    BlockSparseMatrixWrapper<BlockSparseMatrix<double, 3> &> wrapper(A);
+ *    wrapper.set_pattern_locked(true);
+ *    wrapper.resize(300, 300);
+ *    wrapper.add(0, 0, sofa::defaulttype::Mat3x3d(1));
+ *    wrapper.compress();
+ * \endcode
+ */
+template <typename Derived>
+class BlockSparseMatrixWrapper : public sofa::defaulttype::BaseMatrix
+{
+public:
+    using MatrixType = std::remove_cv_t<std::remove_reference_t<Derived>>;
+    using Base = sofa::defaulttype::BaseMatrix;
+    using Index = Base::Index;
+    using Real = SReal;
+    using Scalar = typename MatrixType::Scalar;
+    using StorageIndex = typename MatrixType::StorageIndex;
+    static constexpr int BlockSize = MatrixType::BlockSize;
+
+    BlockSparseMatrixWrapper(std::remove_reference_t<Derived> & matrix) : p_matrix(matrix) {}
+
+    // Abstract methods overrides
+    inline Index rowSize() const final { return p_matrix.rows(); }
+    inline Index colSize() const final { return p_matrix.cols(); }
+
+    /**
+     * @brief Return the matrix entry (i,j).
+     * \warning If the matrix hasn't been initialized by calling compress() or set(), this
+     *          method will always return 0.
+     */
+    inline Real  element(Index i, Index j) const final {
+        caribou_assert(p_initialized && "Accessing an element on an uninitialized matrix.");
+        return p_matrix.coeff(i, j);
+    }
+
+    /**
+     * Resize the matrix to nbRow x nbCol dimensions. This method resets to zero all entries.
+     *
+     * If the pattern is locked and the dimensions are unchanged, the non-zero blocks are kept (with a zero value).
+     */
+    inline void  resize(Index nbRow, Index nbCol) final {
+        p_triplets.clear();
+        if (p_pattern_locked and has_pattern() and nbRow == p_matrix.rows() and nbCol == p_matrix.cols()) {
+            zero_values();
+            return;
+        }
+
+        p_matrix.resize(nbRow, nbCol);
+        p_initialized = false;
+        p_pattern_has_changed = true;
+    }
+
+    /**
+     * Set all entries to zero. Keeps the current matrix dimensions.
+     *
+     * If the pattern is locked, the non-zero blocks are kept (with a zero value).
+     */
+    inline void  clear() final {
+        p_triplets.clear();
+        if (p_pattern_locked and has_pattern()) {
+            zero_values();
+            return;
+        }
+
+        p_matrix.resize(p_matrix.rows(), p_matrix.cols());
+        p_initialized = false;
+        p_pattern_has_changed = true;
+    }
+
+    /**
+     * Lock (or unlock) the sparsity pattern of the matrix. When the pattern is locked, resizing the matrix to its
+     * current dimensions or clearing it only sets the values of its blocks to zero.
+     */
+    inline void set_pattern_locked(bool locked) { p_pattern_locked = locked; }
+
+    /** Whether or not the sparsity pattern is locked. */
+    inline bool pattern_locked() const { return p_pattern_locked; }
+
+    /**
+     * Whether or not the sparsity pattern of the matrix has been (re)built since the last time the matrix was resized
+     * or cleared.
+     */
+    inline bool pattern_has_changed() const { return p_pattern_has_changed; }
+
+    /**
+     * Set this value of the matrix entry (i, j) to the value of v.
+     *
+     * \warning When the matrix hasn't been initialized yet, this method will have to do it. If you have to use the
+     *          set method, make sure that all calls to add has been made beforehand.
+     */
+    inline void  set(Index i, Index j, double v) final {
+        if (not p_initialized) {
+            initialize();
+        }
+
+        auto * block = p_matrix.find_block(i / BlockSize, j / BlockSize);
+        if (not block) {
+            // Insert the block (with the pending entries) and rebuild the pattern
+            p_triplets.emplace_back(i, j, 0);
+            merge_triplets();
+            block = p_matrix.find_block(i / BlockSize, j / BlockSize);
+        }
+
+        (*block)(i % BlockSize, j % BlockSize) = static_cast<Scalar>(v);
+    }
+
+    /** Adds v to the value of the matrix entry (i, j). */
+    inline void  add(Index i, Index j, double v) final {
+        add_entry(i, j, static_cast<Scalar>(v));
+    }
+
+    /**
+     * Compress the matrix.
+     *
+     * If it is the first time that this method is called, then the matrix is built from a list of
+     * triplets (i, j, value) accumulated during the calls of the methodes 'add' and 'set'. Otherwise, the
+     * entries that weren't part of the sparsity pattern are inserted.
+     */
+    void compress() final {
+        if (not p_initialized) {
+            initialize();
+        } else {
+            merge_triplets();
+        }
+    }
+
+    // Block operations on 3x3 and 2x2 sub-matrices
+    inline void add(Index i, Index j, const sofa::defaulttype::Mat3x3d & m) override {return add_block(i, j, m);}
+    inline void add(Index i, Index j, const sofa::defaulttype::Mat3x3f & m) override {return add_block(i, j, m);}
+    inline void add(Index i, Index j, const sofa::defaulttype::Mat2x2d & m) override {return add_block(i, j, m);}
+    inline void add(Index i, Index j, const sofa::defaulttype::Mat2x2f & m) override {return add_block(i, j, m);}
+
+    /** Sets the entire row i to zero */
+    inline void clearRow(Index i) final {
+        clearRows(i, i);
+    }
+
+    /** Sets the rows from index imin to index imax (inclusively) to zero */
+    inline void clearRows(Index imin, Index imax) final {
+        prepare_clear();
+
+        const auto & row_pointers = p_matrix.row_pointers();
+        auto & blocks = p_matrix.blocks();
+        for (Index i = imin; i <= imax; ++i) {
+            const auto block_row = i / BlockSize;
+            for (StorageIndex k = row_pointers[block_row]; k < row_pointers[block_row+1]; ++k) {
+                blocks[k].row(i % BlockSize).setZero();
+            }
+        }
+    }
+
+    /** Sets the entire columns i to zero */
+    inline void clearCol(Index i) final {
+        clearCols(i, i);
+    }
+
+    /** Sets the columns from index imin to index imax (inclusively) to zero */
+    inline void clearCols(Index imin, Index imax) final {
+        prepare_clear();
+
+        // The blocks of each block columns are only gathered once, the first time a column is cleared
+        if (p_column_pointers.empty()) {
+            initialize_columns();
+        }
+
+        auto & blocks = p_matrix.blocks();
+        for (Index j = imin; j <= imax; ++j) {
+            const auto block_column = j / BlockSize;
+            for (StorageIndex k = p_column_pointers[block_column]; k < p_column_pointers[block_column+1]; ++k) {
+                blocks[p_column_blocks[k]].col(j % BlockSize).setZero();
+            }
+        }
+    }
+
+private:
+
+    /** Adds v to the entry (i, j), or append it to the triplets list if it isn't part of the sparsity pattern. */
+    inline void add_entry(Index i, Index j, Scalar v) {
+        if (p_initialized) {
+            if (auto * block = p_matrix.find_block(i / BlockSize, j / BlockSize)) {
+                (*block)(i % BlockSize, j % BlockSize) += v;
+                return;
+            }
+        }
+        p_triplets.emplace_back(i, j, v);
+    }
+
+    /**
+     * Block addition with a NxC matrix. When the sub-matrix matches exactly a block of the matrix, it is added
+     * with a single block operation.
+     */
+    template <typename S, int N, int C>
+    void add_block(Index i, Index j, const sofa::defaulttype::Mat<N, C, S> & m) {
+        if constexpr (N == BlockSize and C == BlockSize) {
+            if (p_initialized and i % BlockSize == 0 and j % BlockSize == 0) {
+                if (auto * block = p_matrix.find_block(i / BlockSize, j / BlockSize)) {
+                    const Eigen::Map<const Eigen::Matrix<S, N, C, Eigen::RowMajor>> b(&(m[0][0]));
+                    *block += b.template cast<Scalar>();
+                    return;
+                }
+            }
+        }
+
+        for (Index k = 0; k < N; ++k) {
+            for (Index l = 0; l < C; ++l) {
+                add_entry(i+k, j+l, static_cast<Scalar>(m[k][l]));
+            }
+        }
+    }
+
+    /** Whether or not the matrix has a sparsity pattern that can be reused. */
+    inline bool has_pattern() const {
+        return (p_initialized or p_pattern_locked) and p_matrix.non_zero_blocks() > 0;
+    }
+
+    /** Set the values of the existing blocks to zero, keeping the sparsity pattern. */
+    inline void zero_values() {
+        p_matrix.set_zero();
+        p_initialized = true;
+        p_pattern_has_changed = false;
+    }
+
+    /** Make sure every entries are in the matrix before clearing rows or columns. */
+    inline void prepare_clear() {
+        if (not p_initialized) {
+            initialize();
+        } else {
+            merge_triplets();
+        }
+    }
+
+    /** Initialize the matrix with the accumulated triplets. */
+    void initialize() {
+        p_matrix.set_from_triplets(p_triplets.begin(), p_triplets.end());
+        p_triplets.clear();
+        p_column_pointers.clear();
+        p_initialized = true;
+        p_pattern_has_changed = true;
+    }
+
+    /** Insert the entries that aren't part of the pattern into the matrix, rebuilding its pattern. */
+    void merge_triplets() {
+        if (p_triplets.empty()) {
+            return;
+        }
+
+        p_matrix.insert_from_triplets(p_triplets.begin(), p_triplets.end());
+        p_triplets.clear();
+        p_column_pointers.clear();
+        p_pattern_has_changed = true;
+    }
+
+    /** Gather the positions of the blocks of every block columns. */
+    void initialize_columns() {
+        const auto & row_pointers = p_matrix.row_pointers();
+        const auto & column_indices = p_matrix.column_indices();
+        const auto nb_block_cols = p_matrix.block_cols();
+
+        p_column_pointers.assign(nb_block_cols+1, 0);
+        for (const auto & j : column_indices) {
+            p_column_pointers[j+1]++;
+        }
+        for (Index j = 0; j < nb_block_cols; ++j) {
+            p_column_pointers[j+1] += p_column_pointers[j];
+        }
+
+        p_column_blocks.resize(column_indices.size());
+        std::vector<StorageIndex> positions(p_column_pointers.begin(), p_column_pointers.end()-1);
+        for (Index i = 0; i < p_matrix.block_rows(); ++i) {
+            for (StorageIndex k = row_pointers[i]; k < row_pointers[i+1]; ++k) {
+                p_column_blocks[positions[column_indices[k]]++] = k;
+            }
+        }
+    }
+
+    ///< Triplets are used to store matrix entries before the call to 'compress'.
+    /// Duplicates entries are summed up.
+    std::vector<Eigen::Triplet<Scalar>> p_triplets;
+
+    ///< Whether or not the matrix has been initialized with triplets yet.
+    bool p_initialized = false;
+
+    ///< Whether or not the sparsity pattern is kept when the matrix is resized to the same dimensions or cleared.
+    bool p_pattern_locked = false;
+
+    ///< Whether or not the sparsity pattern has been (re)built since the matrix was last resized or cleared.
+    bool p_pattern_has_changed = true;
+
+    ///< Index of the first block of every block columns in p_column_blocks (only built when clearing columns).
+    std::vector<StorageIndex> p_column_pointers;
+
+    ///< Position of the blocks (in the list of non-zero blocks of the matrix) sorted by block columns.
+    std::vector<StorageIndex> p_column_blocks;
+
+    ///< The actual block sparse matrix.
+    Derived p_matrix;
+};
+
+} // namespace SofaCaribou::Algebra
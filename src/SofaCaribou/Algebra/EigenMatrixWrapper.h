@@ -4,6 +4,7 @@
 #include <sofa/defaulttype/BaseMatrix.h>
 #include <Eigen/Core>
 #include <Eigen/Sparse>
+#include <algorithm>
 
 namespace SofaCaribou::Algebra {
 
@@ -15,6 +16,11 @@ namespace SofaCaribou::Algebra {
  *
  * \note The wrapper around Eigen sparse matrices has special restrictions.
  *
+ * \note The wrapper around Eigen sparse matrices can lock the sparsity pattern of the matrix (see
+ *       set_pattern_locked). When the matrix is assembled repeatedly with the same pattern (for example at every
+ *       Newton iterations), resizing it to its current dimensions will then only zero its values, and the following
+ *       calls to add will directly accumulate into the existing entries instead of rebuilding the matrix from triplets.
+ *
  * @example
  * \code{.cpp}
  *    // Wrapper by copy
@@ -146,20 +152,62 @@ public:
         return this->p_eigen_matrix.coeff(i,j);
     }
 
-    /** Resize the matrix to nbRow x nbCol dimensions. This method resets to zero all entries. */
+    /**
+     * Resize the matrix to nbRow x nbCol dimensions. This method resets to zero all entries.
+     *
+     * If the pattern is locked and the dimensions are unchanged, the nonzero entries are kept (with a zero value).
+     */
     inline void  resize(Index nbRow, Index nbCol) final {
         p_triplets.clear();
+        if (p_pattern_locked and has_pattern() and nbRow == p_eigen_matrix.rows() and nbCol == p_eigen_matrix.cols()) {
+            zero_values();
+            return;
+        }
+
         this->p_eigen_matrix.resize(nbRow, nbCol);
         p_initialized = false;
+        p_pattern_has_changed = true;
     }
 
-    /** Set all entries to zero. Keeps the current matrix dimensions. */
+    /**
+     * Set all entries to zero. Keeps the current matrix dimensions.
+     *
+     * If the pattern is locked, the nonzero entries are kept (with a zero value).
+     */
     inline void  clear() final {
         p_triplets.clear();
+        if (p_pattern_locked and has_pattern()) {
+            zero_values();
+            return;
+        }
+
         this->p_eigen_matrix.setZero();
         p_initialized = false;
+        p_pattern_has_changed = true;
     }
 
+    /**
+     * Lock (or unlock) the sparsity pattern of the matrix.
+     *
+     * When the pattern is locked, resizing the matrix to its current dimensions or clearing it only sets its values to
+     * zero. The calls to add are then accumulated directly into the existing entries. An entry that isn't part of the
+     * pattern yet is stored in a triplet list, and merged into the matrix at the next call to compress (the pattern
+     * is then rebuilt once, and pattern_has_changed() returns true).
+     *
+     * \warning When the pattern is locked, new entries added after the last call to compress aren't visible to the
+     *          element method until compress is called.
+     */
+    inline void set_pattern_locked(bool locked) { p_pattern_locked = locked; }
+
+    /** Whether or not the sparsity pattern is locked. */
+    inline bool pattern_locked() const { return p_pattern_locked; }
+
+    /**
+     * Whether or not the sparsity pattern of the matrix has been (re)built since the last time the matrix was resized
+     * or cleared. This is always true if the pattern isn't locked.
+     */
+    inline bool pattern_has_changed() const { return p_pattern_has_changed; }
+
     /**
      * Set this value of the matrix entry (i, j) to the value of v.
      *
@@ -173,6 +221,15 @@ public:
             initialize();
         }
 
+        if (p_pattern_locked) {
+            if (auto * value = find(i, j)) {
+                *value = v;
+                return;
+            }
+            merge_triplets();
+            p_pattern_has_changed = true;
+        }
+
         this->p_eigen_matrix.coeffRef(i, j) = v;
     }
 
@@ -188,6 +245,8 @@ public:
         //       X calls to add until compress is called).
         if (not p_initialized) {
             p_triplets.emplace_back(i, j, v);
+        } else if (p_pattern_locked) {
+            add_locked(i, j, v);
         } else {
             p_eigen_matrix.coeffRef(i, j) += v;
         }
@@ -203,6 +262,7 @@ public:
         if (not p_initialized) {
             initialize();
         } else {
+            merge_triplets();
             p_eigen_matrix.makeCompressed();
         }
     }
@@ -217,6 +277,8 @@ public:
     inline void clearRow(Index i) final {
         if (not p_initialized) {
             initialize();
+        } else {
+            merge_triplets();
         }
 
 #if EIGEN_VERSION_AT_LEAST(3,3,0)
@@ -230,6 +292,8 @@ public:
     inline void clearRows(Index imin, Index imax) final {
         if (not p_initialized) {
             initialize();
+        } else {
+            merge_triplets();
         }
 
         p_eigen_matrix.middleRows(imin, (imax-imin)+1) *= static_cast<const typename EigenType::Scalar &>(0);
@@ -239,6 +303,8 @@ public:
     inline void clearCol(Index i) final {
         if (not p_initialized) {
             initialize();
+        } else {
+            merge_triplets();
         }
 
         p_eigen_matrix.col(i) *= static_cast<const typename EigenType::Scalar &>(0);
@@ -248,6 +314,8 @@ public:
     inline void clearCols(Index imin, Index imax) final {
         if (not p_initialized) {
             initialize();
+        } else {
+            merge_triplets();
         }
 
         p_eigen_matrix.middleCols(imin, (imax-imin)+1) *= static_cast<const typename EigenType::Scalar &>(0);
@@ -265,6 +333,8 @@ private:
                 const auto value = static_cast<typename EigenType::Scalar>(m[k][l]);
                 if (not p_initialized) {
                     p_triplets.emplace_back(i+k, j+l, value);
+                } else if (p_pattern_locked) {
+                    add_locked(i+k, j+l, value);
                 } else {
                     p_eigen_matrix.coeffRef(i+k, j+l) += value;
                 }
@@ -281,6 +351,69 @@ private:
         p_eigen_matrix.setFromTriplets(p_triplets.begin(), p_triplets.end());
         p_triplets.clear();
         p_initialized = true;
+        p_pattern_has_changed = true;
+    }
+
+    /**
+     * Whether or not the matrix has a sparsity pattern that can be reused. When the pattern is locked, the pattern of
+     * a wrapped matrix built beforehand (for example by a previous wrapper of the same matrix) is reused.
+     */
+    inline bool has_pattern() const {
+        return (p_initialized or p_pattern_locked) and p_eigen_matrix.nonZeros() > 0;
+    }
+
+    /** Set the values of the existing entries to zero, keeping the sparsity pattern. */
+    inline void zero_values() {
+        p_eigen_matrix.makeCompressed();
+        std::fill(p_eigen_matrix.valuePtr(), p_eigen_matrix.valuePtr() + p_eigen_matrix.nonZeros(), 0);
+        p_initialized = true;
+        p_pattern_has_changed = false;
+    }
+
+    /**
+     * Get a pointer to the value of the entry (i, j) if it is part of the sparsity pattern, nullptr otherwise.
+     * The inner indices of every outer vectors being sorted, the entry is found by a binary search.
+     */
+    inline typename EigenType::Scalar * find(Index i, Index j) {
+        const auto outer = static_cast<typename EigenType::StorageIndex>(EigenType::IsRowMajor ? i : j);
+        const auto inner = static_cast<typename EigenType::StorageIndex>(EigenType::IsRowMajor ? j : i);
+
+        const auto * inner_indices = p_eigen_matrix.innerIndexPtr();
+        const auto begin = p_eigen_matrix.outerIndexPtr()[outer];
+        const auto end = p_eigen_matrix.isCompressed() ? p_eigen_matrix.outerIndexPtr()[outer+1]
+                                                       : begin + p_eigen_matrix.innerNonZeroPtr()[outer];
+
+        const auto * it = std::lower_bound(inner_indices + begin, inner_indices + end, inner);
+        if (it == inner_indices + end or *it != inner) {
+            return nullptr;
+        }
+
+        return p_eigen_matrix.valuePtr() + (it - inner_indices);
+    }
+
+    /**
+     * Add v to the entry (i, j) of a matrix having a locked pattern. If the entry isn't part of the pattern, it is
+     * appended to the triplet list and will be merged into the matrix when compressed.
+     */
+    inline void add_locked(Index i, Index j, typename EigenType::Scalar v) {
+        if (auto * value = find(i, j)) {
+            *value += v;
+        } else {
+            p_triplets.emplace_back(i, j, v);
+        }
+    }
+
+    /** Merge the entries that aren't part of the locked pattern into the matrix, rebuilding its pattern. */
+    void merge_triplets() {
+        if (p_triplets.empty()) {
+            return;
+        }
+
+        EigenType new_entries(p_eigen_matrix.rows(), p_eigen_matrix.cols());
+        new_entries.setFromTriplets(p_triplets.begin(), p_triplets.end());
+        p_eigen_matrix += new_entries;
+        p_triplets.clear();
+        p_pattern_has_changed = true;
     }
 
     ///< Triplets are used to store matrix entries before the call to 'compress'.
@@ -292,6 +425,12 @@ private:
     /// the new coefficient to the triplet list.
     bool p_initialized = false;
 
+    ///< Whether or not the sparsity pattern is kept when the matrix is resized to the same dimensions or cleared.
+    bool p_pattern_locked = false;
+
+    ///< Whether or not the sparsity pattern has been (re)built since the matrix was last resized or cleared.
+    bool p_pattern_has_changed = true;
+
     ///< The actual Eigen Matrix.
     Derived p_eigen_matrix;
 };
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <Caribou/macros.h>
+#include <Caribou/Topology/Grid/Grid.h>
+#include <SofaCaribou/Algebra/MultigridHierarchy.h>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Geometric multigrid preconditioner for systems whose nodes lie on a regular grid (caribou::topology::Grid<3>).
+ *
+ * The hierarchy of grids is built by doubling the cell size of the grid at each level. The prolongation P from a
+ * coarse level to the next finer one is the trilinear interpolation of the coarse nodes onto the fine nodes, the
+ * restriction being its transpose. The coarse operators are the Galerkin products A_c = P^T A P, hence only the
+ * system matrix of the finest level is needed. Only the coarse nodes used by the interpolation of the fine nodes
+ * are kept, which allows sparse grids (for example, the nodes of the cells inside a FictitiousGrid).
+ *
+ * The preconditioner applies one symmetric V-cycle (see MultigridHierarchy).
+ *
+ * The degrees of freedom of a node n are expected to be n*d, ..., n*d + d-1, d being the number of degrees of
+ * freedom per node. The degrees of freedom decoupled from the others (rows of the matrix having only a diagonal
+ * entry, usually fixed by a projective constraint) aren't interpolated from the coarse levels.
+ *
+ * The interface follows the one of Eigen's preconditioners (analyzePattern, factorize, compute, solve, info). The
+ * grid must be given (set_grid or set_nodes) before the first factorization.
+ *
+ * @example
+ * \code{.cpp}
+ *    GeometricMultigridPreconditioner<double> multigrid;
+ *    multigrid.set_nodes(rest_positions, 3);
+ *    multigrid.compute(A);
+ *    Eigen::VectorXd z = multigrid.solve(r);
+ * \endcode
+ */
+template <typename Scalar>
+class GeometricMultigridPreconditioner {
+public:
+    using Index = Eigen::Index;
+    using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    using Grid = caribou::topology::Grid<3>;
+    using GridCoordinates = typename Grid::GridCoordinates;
+    using WorldCoordinates = typename Grid::WorldCoordinates;
+    using Subdivisions = typename Grid::Subdivisions;
+    using Dimensions = typename Grid::Dimensions;
+
+    GeometricMultigridPreconditioner() = default;
+
+    inline Index rows() const { return p_sizes.empty() ? 0 : p_sizes.front(); }
+    inline Index cols() const { return rows(); }
+
+    /** Number of levels of the hierarchy (including the finest one) */
+    inline Index number_of_levels() const { return static_cast<Index>(p_sizes.size()); }
+
+    /** Number of degrees of freedom of the given level (0 being the finest level) */
+    inline Index size_of_level(const Index & level) const { return p_sizes[level]; }
+
+    /** Number of forward (resp. backward) Gauss-Seidel sweeps before (resp. after) the coarse grid correction */
+    inline void set_number_of_smoothing_steps(const unsigned int & steps) { p_hierarchy.set_number_of_smoothing_steps(steps); }
+
+    /** Maximum number of levels of the hierarchy, including the finest one (0 for no maximum) */
+    inline void set_maximum_number_of_levels(const unsigned int & levels) { p_maximum_number_of_levels = levels; }
+
+    /** Coarsening stops when a level has less degrees of freedom than this size */
+    inline void set_coarsest_size(const Index & size) { p_coarsest_size = size; }
+
+    /**
+     * Set the grid of the finest level, and the grid coordinates of every nodes of the system. This builds the
+     * hierarchy of the coarse grids and their prolongation operators.
+     */
+    void set_grid(const Grid & grid, const std::vector<GridCoordinates> & node_coordinates, const Index & dofs_per_node) {
+        p_prolongations.clear();
+        p_sizes = {static_cast<Index>(node_coordinates.size())*dofs_per_node};
+        p_dofs_per_node = dofs_per_node;
+
+        auto fine_grid = std::make_unique<Grid>(grid);
+        auto fine_coordinates = node_coordinates;
+
+        while (p_maximum_number_of_levels == 0 or p_sizes.size() < p_maximum_number_of_levels) {
+            const Index fine_size = static_cast<Index>(fine_coordinates.size())*dofs_per_node;
+            const Subdivisions & N = fine_grid->N();
+            if (fine_size <= p_coarsest_size or N.maxCoeff() < 2) {
+                break;
+            }
+
+            // The coarse grid has twice the cell size of the fine grid
+            const Subdivisions coarse_N = ((N.array() + 1) / 2).matrix();
+            const Dimensions coarse_size = (fine_grid->H().array() * 2 * coarse_N.array().template cast<FLOATING_POINT_TYPE>()).matrix();
+            auto coarse_grid = std::make_unique<Grid>(fine_grid->anchor_position(), coarse_N, coarse_size);
+
+            std::vector<GridCoordinates> coarse_coordinates;
+            SparseMatrix P = prolongation(*coarse_grid, fine_coordinates, coarse_coordinates);
+            if (static_cast<Index>(coarse_coordinates.size()) == static_cast<Index>(fine_coordinates.size())) {
+                break;
+            }
+
+            p_prolongations.emplace_back(std::move(P));
+            p_sizes.emplace_back(static_cast<Index>(coarse_coordinates.size())*dofs_per_node);
+
+            fine_grid = std::move(coarse_grid);
+            fine_coordinates = std::move(coarse_coordinates);
+        }
+
+        p_grid_is_set = true;
+        p_is_initialized = false;
+    }
+
+    /**
+     * Fit a regular grid onto the given node positions and set it as the grid of the finest level
+     * (see set_grid).
+     *
+     * @return False if the nodes do not lie on the nodes of a regular grid (in which case nothing is done).
+     */
+    template <typename Positions>
+    bool set_nodes(const Positions & positions, const Index & dofs_per_node) {
+        if (positions.size() == 0) {
+            return false;
+        }
+
+        // Bounding box of the nodes
+        WorldCoordinates min, max;
+        for (unsigned int axis = 0; axis < 3; ++axis) {
+            min[axis] = max[axis] = positions[0][axis];
+        }
+        for (const auto & p : positions) {
+            for (unsigned int axis = 0; axis < 3; ++axis) {
+                min[axis] = std::min(min[axis], static_cast<FLOATING_POINT_TYPE>(p[axis]));
+                max[axis] = std::max(max[axis], static_cast<FLOATING_POINT_TYPE>(p[axis]));
+            }
+        }
+
+        // The cell size is the smallest distance between two distinct coordinates of the nodes along an axis
+        Dimensions H;
+        Subdivisions N;
+        for (unsigned int axis = 0; axis < 3; ++axis) {
+            const FLOATING_POINT_TYPE extent = max[axis] - min[axis];
+            if (extent <= 0) {
+                return false;
+            }
+
+            std::vector<FLOATING_POINT_TYPE> coordinates;
+            coordinates.reserve(positions.size());
+            for (const auto & p : positions) {
+                coordinates.emplace_back(p[axis]);
+            }
+            std::sort(coordinates.begin(), coordinates.end());
+
+            H[axis] = extent;
+            for (std::size_t i = 1; i < coordinates.size(); ++i) {
+                const FLOATING_POINT_TYPE distance = coordinates[i] - coordinates[i-1];
+                if (distance > 1e-8*extent) {
+                    H[axis] = std::min(H[axis], distance);
+                }
+            }
+            N[axis] = static_cast<typename Subdivisions::Scalar>(std::round(extent / H[axis]));
+            H[axis] = extent / static_cast<FLOATING_POINT_TYPE>(N[axis]);
+        }
+
+        // Grid coordinates of every nodes, making sure they are on a node of the grid
+        std::vector<GridCoordinates> node_coordinates;
+        node_coordinates.reserve(positions.size());
+        for (const auto & p : positions) {
+            GridCoordinates c;
+            for (unsigned int axis = 0; axis < 3; ++axis) {
+                const FLOATING_POINT_TYPE x = (static_cast<FLOATING_POINT_TYPE>(p[axis]) - min[axis]) / H[axis];
+                c[axis] = static_cast<typename GridCoordinates::Scalar>(std::round(x));
+                if (std::abs(x - static_cast<FLOATING_POINT_TYPE>(c[axis])) > 1e-3) {
+                    return false;
+                }
+            }
+            node_coordinates.emplace_back(c);
+        }
+
+        set_grid(Grid(min, N, (max - min)), node_coordinates, dofs_per_node);
+        return true;
+    }
+
+    /** Nothing to analyze, the coarse operators are computed during the factorization. */
+    template <typename MatrixType>
+    GeometricMultigridPreconditioner & analyzePattern(const MatrixType &) {
+        return *this;
+    }
+
+    /** Compute the coarse operators of every levels, and factorize the coarsest one. */
+    template <typename MatrixType>
+    GeometricMultigridPreconditioner & factorize(const MatrixType & A) {
+        caribou_assert(p_grid_is_set && "The grid must be set before the factorization.");
+        caribou_assert(A.rows() == p_sizes[0] && "The size of the matrix doesn't match the number of nodes.");
+
+        auto & levels = p_hierarchy.levels();
+        levels.resize(p_sizes.size());
+        levels[0].A = A;
+        for (std::size_t l = 0; l < p_prolongations.size(); ++l) {
+            levels[l].P = p_prolongations[l];
+        }
+
+        // The decoupled degrees of freedom of the finest level aren't interpolated from the coarse level
+        if (levels.size() > 1) {
+            const SparseMatrix & A0 = levels[0].A;
+            Vector coupled = Vector::Zero(A0.rows());
+            for (Index j = 0; j < A0.outerSize(); ++j) {
+                for (typename SparseMatrix::InnerIterator it(A0, j); it; ++it) {
+                    if (it.row() != j and it.value() != Scalar(0)) {
+                        coupled[it.row()] = 1;
+                        coupled[j] = 1;
+                    }
+                }
+            }
+            levels[0].P = coupled.asDiagonal() * levels[0].P;
+        }
+
+        // Galerkin coarse operators A_c = P^T A P
+        for (std::size_t l = 0; l+1 < levels.size(); ++l) {
+            levels[l+1].A = MultigridHierarchy<Scalar>::galerkin_product(levels[l].A, levels[l].P);
+        }
+
+        p_hierarchy.finalize();
+        p_is_initialized = true;
+
+        return *this;
+    }
+
+    template <typename MatrixType>
+    GeometricMultigridPreconditioner & compute(const MatrixType & A) {
+        analyzePattern(A);
+        return factorize(A);
+    }
+
+    /** Apply one V-cycle: x = M^-1 b */
+    template <typename Derived>
+    Vector solve(const Eigen::MatrixBase<Derived> & b) const {
+        caribou_assert(p_is_initialized && "The preconditioner must be factorized before solving.");
+        return p_hierarchy.solve(b);
+    }
+
+    Eigen::ComputationInfo info() const { return p_hierarchy.info(); }
+
+private:
+    /**
+     * Trilinear interpolation of the nodes of the coarse grid onto the fine nodes. The coarse nodes used by the
+     * interpolation are gathered in coarse_coordinates.
+     */
+    SparseMatrix prolongation(const Grid & coarse_grid, const std::vector<GridCoordinates> & fine_coordinates, std::vector<GridCoordinates> & coarse_coordinates) const {
+        const auto d = p_dofs_per_node;
+        std::vector<INTEGER_TYPE> coarse_node_index (coarse_grid.number_of_nodes(), -1);
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        triplets.reserve(fine_coordinates.size()*8*d);
+
+        for (std::size_t i = 0; i < fine_coordinates.size(); ++i) {
+            const GridCoordinates & c = fine_coordinates[i];
+
+            // A fine node on an even coordinate coincides with a coarse node, otherwise it is halfway between two
+            for (unsigned int corner = 0; corner < 8; ++corner) {
+                GridCoordinates coarse;
+                Scalar weight = 1;
+                bool valid = true;
+                for (unsigned int axis = 0; axis < 3; ++axis) {
+                    const bool upper = corner & (1u << axis);
+                    if (c[axis] % 2 == 0) {
+                        valid = valid and not upper;
+                        coarse[axis] = c[axis] / 2;
+                    } else {
+                        coarse[axis] = c[axis] / 2 + (upper ? 1 : 0);
+                        weight *= Scalar(0.5);
+                    }
+                }
+                if (not valid) {
+                    continue;
+                }
+
+                const auto node_index = coarse_grid.node_index_at(coarse);
+                if (coarse_node_index[node_index] < 0) {
+                    coarse_node_index[node_index] = static_cast<INTEGER_TYPE>(coarse_coordinates.size());
+                    coarse_coordinates.emplace_back(coarse);
+                }
+
+                const Index j = coarse_node_index[node_index];
+                for (Index k = 0; k < d; ++k) {
+                    triplets.emplace_back(static_cast<Index>(i)*d + k, j*d + k, weight);
+                }
+            }
+        }
+
+        SparseMatrix P(static_cast<Index>(fine_coordinates.size())*d, static_cast<Index>(coarse_coordinates.size())*d);
+        P.setFromTriplets(triplets.begin(), triplets.end());
+        return P;
+    }
+
+    ///< Number of degrees of freedom of every levels, from the finest to the coarsest one
+    std::vector<Index> p_sizes;
+
+    ///< Trilinear prolongations from every coarse levels to the next finer level
+    std::vector<SparseMatrix> p_prolongations;
+
+    ///< Operators of every levels and their V-cycle
+    MultigridHierarchy<Scalar> p_hierarchy;
+
+    ///< Number of degrees of freedom per node
+    Index p_dofs_per_node = 1;
+
+    ///< Maximum number of levels (0 for no maximum)
+    unsigned int p_maximum_number_of_levels = 0;
+
+    ///< Coarsening stops when a level has less degrees of freedom than this size
+    Index p_coarsest_size = 1000;
+
+    bool p_grid_is_set = false;
+    bool p_is_initialized = false;
+};
+
+} // namespace SofaCaribou::Algebra
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <Caribou/macros.h>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <vector>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Hierarchy of levels of a multigrid method, with its V-cycle.
+ *
+ * Each level holds its operator A and the prolongation P from the next (coarser) level. The way the prolongations
+ * are built is left to the multigrid method using the hierarchy (geometric or algebraic). The coarse operators are
+ * usually the Galerkin products A_c = P^T A P (see galerkin_product).
+ *
+ * The V-cycle does a number of forward Gauss-Seidel sweeps before the coarse grid correction and the same number of
+ * backward sweeps after it, which keeps the cycle symmetric (as required by the conjugate gradient). The coarsest
+ * system is solved with a sparse LDL^T factorization.
+ */
+template <typename Scalar>
+class MultigridHierarchy {
+public:
+    using Index = Eigen::Index;
+    using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+    /** A level of the hierarchy */
+    struct Level {
+        ///< Operator of this level
+        SparseMatrix A;
+
+        ///< Inverse of the diagonal of the operator
+        Vector inverse_diagonal;
+
+        ///< Prolongation from the next (coarser) level to this level (empty on the coarsest level)
+        SparseMatrix P;
+    };
+
+    /** Levels of the hierarchy, from the finest to the coarsest one */
+    inline std::vector<Level> & levels() { return p_levels; }
+    inline const std::vector<Level> & levels() const { return p_levels; }
+
+    /** Number of forward (resp. backward) Gauss-Seidel sweeps before (resp. after) the coarse grid correction */
+    inline void set_number_of_smoothing_steps(const unsigned int & steps) { p_number_of_smoothing_steps = steps; }
+
+    /**
+     * Compute the Galerkin product P^T A P. A coarse degree of freedom whose fine degrees of freedom aren't
+     * interpolated (empty column of P) gets a unit diagonal entry, which keeps the coarse operator invertible.
+     */
+    static SparseMatrix galerkin_product(const SparseMatrix & A, const SparseMatrix & P) {
+        const SparseMatrix AP = A * P;
+        SparseMatrix Ac = SparseMatrix(P.transpose() * AP).pruned();
+        for (Index i = 0; i < Ac.rows(); ++i) {
+            if (Ac.coeff(i, i) == Scalar(0)) {
+                Ac.coeffRef(i, i) = 1;
+            }
+        }
+        Ac.makeCompressed();
+        return Ac;
+    }
+
+    /** Inverse of the diagonal of A (a null diagonal entry being replaced by one). */
+    static Vector inverse_diagonal(const SparseMatrix & A) {
+        Vector d = A.diagonal();
+        for (Index i = 0; i < d.size(); ++i) {
+            d[i] = (d[i] != Scalar(0)) ? Scalar(1) / d[i] : Scalar(1);
+        }
+        return d;
+    }
+
+    /**
+     * Set up the smoothers of every levels and factorize the coarsest operator. This must be called once the
+     * operators of every levels are computed.
+     */
+    void finalize() {
+        caribou_assert(not p_levels.empty());
+        for (auto & level : p_levels) {
+            level.inverse_diagonal = inverse_diagonal(level.A);
+        }
+        p_coarse_solver.compute(p_levels.back().A);
+        p_info = p_coarse_solver.info();
+    }
+
+    /** Apply one V-cycle: x = M^-1 b */
+    template <typename Derived>
+    Vector solve(const Eigen::MatrixBase<Derived> & b) const {
+        const Vector rhs = b;
+        Vector x = Vector::Zero(rhs.size());
+        cycle(0, rhs, x);
+        return x;
+    }
+
+    Eigen::ComputationInfo info() const { return p_info; }
+
+private:
+    /**
+     * Gauss-Seidel sweep on the symmetric operator A (the column j being used as the row j). The sweep goes from the
+     * first to the last row when forward is true, and from the last to the first row otherwise.
+     */
+    static void gauss_seidel(const SparseMatrix & A, const Vector & inverse_diagonal, const Vector & b, Vector & x, bool forward) {
+        const Index n = A.cols();
+        for (Index k = 0; k < n; ++k) {
+            const Index j = forward ? k : n-1-k;
+            Scalar sigma = 0;
+            for (typename SparseMatrix::InnerIterator it(A, j); it; ++it) {
+                if (it.row() != j) {
+                    sigma += it.value() * x[it.row()];
+                }
+            }
+            x[j] = (b[j] - sigma) * inverse_diagonal[j];
+        }
+    }
+
+    /** V-cycle on the given level, starting from the initial guess x */
+    void cycle(const std::size_t & l, const Vector & b, Vector & x) const {
+        const Level & level = p_levels[l];
+        if (l+1 == p_levels.size()) {
+            x = p_coarse_solver.solve(b);
+            return;
+        }
+
+        // Pre-smoothing
+        for (unsigned int s = 0; s < p_number_of_smoothing_steps; ++s) {
+            gauss_seidel(level.A, level.inverse_diagonal, b, x, true);
+        }
+
+        // Coarse grid correction
+        const Vector r = b - level.A * x;
+        const Vector rc = level.P.transpose() * r;
+        Vector ec = Vector::Zero(rc.size());
+        cycle(l+1, rc, ec);
+        x.noalias() += level.P * ec;
+
+        // Post-smoothing
+        for (unsigned int s = 0; s < p_number_of_smoothing_steps; ++s) {
+            gauss_seidel(level.A, level.inverse_diagonal, b, x, false);
+        }
+    }
+
+    ///< Levels of the hierarchy, from the finest to the coarsest one
+    std::vector<Level> p_levels;
+
+    ///< Direct solver of the coarsest level
+    Eigen::SimplicialLDLT<SparseMatrix> p_coarse_solver;
+
+    ///< Number of Gauss-Seidel sweeps before and after the coarse grid correction
+    unsigned int p_number_of_smoothing_steps = 2;
+
+    Eigen::ComputationInfo p_info = Eigen::Success;
+};
+
+} // namespace SofaCaribou::Algebra
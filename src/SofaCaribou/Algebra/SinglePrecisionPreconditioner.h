@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Preconditioner whose factors are stored and applied in single precision, while it is factorized from and applied
+ * to double precision matrices and vectors.
+ *
+ * The matrix is rounded to single precision before being given to the wrapped preconditioner, and the vectors are
+ * rounded before and after each application. The preconditioner is only an approximation of the inverse of the
+ * matrix, hence the rounding barely changes its quality, but the memory traffic of its applications (usually
+ * dominated by the triangular solves) is halved. The Krylov iterations using it should stay in double precision.
+ *
+ * The interface follows the one of Eigen's preconditioners (analyzePattern, factorize, compute, solve, info).
+ *
+ * @tparam Preconditioner A single precision preconditioner, ex. Eigen::IncompleteCholesky<float>.
+ */
+template <typename Preconditioner>
+class SinglePrecisionPreconditioner {
+public:
+    using Scalar = float;
+    using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+    SinglePrecisionPreconditioner() = default;
+
+    /** The wrapped preconditioner */
+    inline const Preconditioner & preconditioner() const { return p_preconditioner; }
+
+    template <typename MatrixType>
+    SinglePrecisionPreconditioner & analyzePattern(const MatrixType & A) {
+        p_preconditioner.analyzePattern(SparseMatrix(A.template cast<Scalar>()));
+        return *this;
+    }
+
+    template <typename MatrixType>
+    SinglePrecisionPreconditioner & factorize(const MatrixType & A) {
+        p_preconditioner.factorize(SparseMatrix(A.template cast<Scalar>()));
+        return *this;
+    }
+
+    template <typename MatrixType>
+    SinglePrecisionPreconditioner & compute(const MatrixType & A) {
+        analyzePattern(A);
+        return factorize(A);
+    }
+
+    /** Compute x = M^-1 b in single precision, x having the scalar type of b */
+    template <typename Derived>
+    Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic, 1> solve(const Eigen::MatrixBase<Derived> & b) const {
+        const Vector single_b = b.template cast<Scalar>();
+        const Vector single_x = p_preconditioner.solve(single_b);
+        return single_x.template cast<typename Derived::Scalar>();
+    }
+
+    Eigen::ComputationInfo info() const { return p_preconditioner.info(); }
+
+private:
+    ///< The single precision preconditioner
+    Preconditioner p_preconditioner;
+};
+
+} // namespace SofaCaribou::Algebra
@@ -0,0 +1,424 @@
+#pragma once
+
+#include <Caribou/macros.h>
+#include <SofaCaribou/Algebra/MultigridHierarchy.h>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/QR>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Smoothed aggregation algebraic multigrid preconditioner.
+ *
+ * The nodes of a level are grouped into small aggregates of strongly connected nodes. Two nodes i and j are strongly
+ * connected when the norm of their coupling block A_ij is larger than theta * sqrt(|A_ii| |A_jj|), theta being the
+ * strength threshold. A coarse level has one (vector) node per aggregate.
+ *
+ * The tentative prolongation T of an aggregate interpolates the near-nullspace B of the operator (the vectors having
+ * a very low energy), restricted to the aggregate, from the degrees of freedom of its coarse node (the QR
+ * decomposition B_a = Q_a R_a gives T_a = Q_a, the near-nullspace of the coarse node being R_a). For elasticity, the
+ * near-nullspace is made of the rigid body modes (translations and rotations) computed from the node positions. The
+ * tentative prolongation is then smoothed by one damped Jacobi iteration, P = (I - w D^-1 A) T with
+ * w = 4 / (3 rho(D^-1 A)). The coarse operators are the Galerkin products A_c = P^T A P.
+ *
+ * Since the aggregates and tentative prolongations only depend on the sparsity pattern of the matrix (and on the
+ * node positions), they are built during the first factorization following a call to analyzePattern (or set_nodes),
+ * and reused by the next factorizations, which only smooth the tentative prolongations and compute the Galerkin
+ * products. Hence, a preconditioner factorized at every Newton iterations of a static solve only builds its
+ * aggregates once.
+ *
+ * The preconditioner applies one symmetric V-cycle (see MultigridHierarchy).
+ *
+ * The degrees of freedom of a node n are expected to be n*d, ..., n*d + d-1, d being the number of degrees of
+ * freedom per node. The degrees of freedom decoupled from the others (rows of the matrix having only a diagonal
+ * entry, usually fixed by a projective constraint) aren't interpolated from the coarse levels.
+ *
+ * The interface follows the one of Eigen's preconditioners (analyzePattern, factorize, compute, solve, info). The
+ * node positions must be given (set_nodes) before the first factorization.
+ *
+ * @example
+ * \code{.cpp}
+ *    SmoothedAggregationPreconditioner<double> amg;
+ *    amg.set_nodes(rest_positions, 3);
+ *    amg.compute(A);
+ *    Eigen::VectorXd z = amg.solve(r);
+ * \endcode
+ */
+template <typename Scalar>
+class SmoothedAggregationPreconditioner {
+public:
+    using Index = Eigen::Index;
+    using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    using DenseMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
+    SmoothedAggregationPreconditioner() = default;
+
+    inline Index rows() const { return p_near_nullspace.rows(); }
+    inline Index cols() const { return rows(); }
+
+    /** Number of levels of the hierarchy (including the finest one), available after the first factorization */
+    inline Index number_of_levels() const { return static_cast<Index>(p_hierarchy.levels().size()); }
+
+    /** Number of degrees of freedom of the given level (0 being the finest level) */
+    inline Index size_of_level(const Index & level) const { return p_hierarchy.levels()[level].A.rows(); }
+
+    /** Number of times the aggregates have been built */
+    inline unsigned int number_of_aggregations() const { return p_number_of_aggregations; }
+
+    /** Number of forward (resp. backward) Gauss-Seidel sweeps before (resp. after) the coarse grid correction */
+    inline void set_number_of_smoothing_steps(const unsigned int & steps) { p_hierarchy.set_number_of_smoothing_steps(steps); }
+
+    /** Maximum number of levels of the hierarchy, including the finest one (0 for no maximum) */
+    inline void set_maximum_number_of_levels(const unsigned int & levels) { p_maximum_number_of_levels = levels; }
+
+    /** Coarsening stops when a level has less degrees of freedom than this size */
+    inline void set_coarsest_size(const Index & size) { p_coarsest_size = size; }
+
+    /** Relative strength of the coupling between two nodes for them to be aggregated together */
+    inline void set_strength_threshold(const Scalar & theta) { p_strength_threshold = theta; }
+
+    /**
+     * Set the positions of the nodes, from which the near-nullspace of the finest level is computed. With 3 degrees of
+     * freedom per node, these are the 3 translations and 3 rotations of the rigid body modes (with 2 degrees of freedom
+     * per node, 2 translations and 1 rotation). Otherwise, only the translations are used.
+     */
+    template <typename Positions>
+    void set_nodes(const Positions & positions, const Index & dofs_per_node) {
+        const auto nb_nodes = static_cast<Index>(positions.size());
+        const Index d = dofs_per_node;
+        const Index nb_rotations = (d == 3) ? 3 : ((d == 2) ? 1 : 0);
+
+        // The rotations are centered on the centroid of the nodes to keep the modes well scaled
+        Eigen::Matrix<Scalar, 3, 1> centroid = Eigen::Matrix<Scalar, 3, 1>::Zero();
+        for (const auto & p : positions) {
+            for (Index axis = 0; axis < std::min<Index>(d, 3); ++axis) {
+                centroid[axis] += static_cast<Scalar>(p[axis]) / static_cast<Scalar>(nb_nodes);
+            }
+        }
+
+        p_dofs_per_node = d;
+        p_near_nullspace = DenseMatrix::Zero(nb_nodes*d, d + nb_rotations);
+        for (Index n = 0; n < nb_nodes; ++n) {
+            for (Index k = 0; k < d; ++k) {
+                p_near_nullspace(n*d + k, k) = 1;
+            }
+            if (nb_rotations > 0) {
+                const Scalar x = static_cast<Scalar>(positions[n][0]) - centroid[0];
+                const Scalar y = static_cast<Scalar>(positions[n][1]) - centroid[1];
+                p_near_nullspace(n*d + 0, d) = -y;
+                p_near_nullspace(n*d + 1, d) =  x;
+                if (nb_rotations == 3) {
+                    const Scalar z = static_cast<Scalar>(positions[n][2]) - centroid[2];
+                    p_near_nullspace(n*d + 1, d+1) = -z;
+                    p_near_nullspace(n*d + 2, d+1) =  y;
+                    p_near_nullspace(n*d + 0, d+2) =  z;
+                    p_near_nullspace(n*d + 2, d+2) = -x;
+                }
+            }
+        }
+
+        p_nodes_are_set = true;
+        p_aggregates_are_valid = false;
+    }
+
+    /** The aggregates will be rebuilt during the next factorization. */
+    template <typename MatrixType>
+    SmoothedAggregationPreconditioner & analyzePattern(const MatrixType &) {
+        p_aggregates_are_valid = false;
+        return *this;
+    }
+
+    /**
+     * Build the aggregates (if the pattern has been analyzed since the last factorization), smooth the tentative
+     * prolongations, compute the coarse operators of every levels and factorize the coarsest one.
+     */
+    template <typename MatrixType>
+    SmoothedAggregationPreconditioner & factorize(const MatrixType & A) {
+        caribou_assert(p_nodes_are_set && "The node positions must be set before the factorization.");
+        caribou_assert(A.rows() == rows() && "The size of the matrix doesn't match the number of nodes.");
+
+        auto & levels = p_hierarchy.levels();
+        levels.resize(1);
+        levels[0].A = A;
+
+        if (not p_aggregates_are_valid) {
+            build_tentative_prolongations(levels[0].A);
+            p_aggregates_are_valid = true;
+            ++p_number_of_aggregations;
+        }
+
+        for (std::size_t l = 0; l < p_tentative_prolongations.size(); ++l) {
+            levels[l].P = smoothed_prolongation(levels[l].A, p_tentative_prolongations[l]);
+            levels.emplace_back();
+            levels[l+1].A = MultigridHierarchy<Scalar>::galerkin_product(levels[l].A, levels[l].P);
+        }
+
+        p_hierarchy.finalize();
+        p_is_initialized = true;
+
+        return *this;
+    }
+
+    template <typename MatrixType>
+    SmoothedAggregationPreconditioner & compute(const MatrixType & A) {
+        analyzePattern(A);
+        return factorize(A);
+    }
+
+    /** Apply one V-cycle: x = M^-1 b */
+    template <typename Derived>
+    Vector solve(const Eigen::MatrixBase<Derived> & b) const {
+        caribou_assert(p_is_initialized && "The preconditioner must be factorized before solving.");
+        return p_hierarchy.solve(b);
+    }
+
+    Eigen::ComputationInfo info() const { return p_hierarchy.info(); }
+
+private:
+    /**
+     * Build the aggregates and the tentative prolongations of every levels. The coarse operators used to aggregate
+     * the coarse levels are the Galerkin products of the unsmoothed tentative prolongations, which have the same
+     * sparsity pattern (at the node level) as the smoothed ones.
+     */
+    void build_tentative_prolongations(const SparseMatrix & A) {
+        p_tentative_prolongations.clear();
+
+        const Index nb_nodes = A.rows() / p_dofs_per_node;
+        std::vector<Index> node_offsets(nb_nodes+1);
+        for (Index n = 0; n <= nb_nodes; ++n) {
+            node_offsets[n] = n*p_dofs_per_node;
+        }
+
+        SparseMatrix A_l = A;
+        DenseMatrix B = p_near_nullspace;
+        while (p_maximum_number_of_levels == 0 or p_tentative_prolongations.size()+1 < p_maximum_number_of_levels) {
+            if (A_l.rows() <= p_coarsest_size) {
+                break;
+            }
+
+            std::vector<Index> coarse_node_offsets;
+            DenseMatrix coarse_B;
+            SparseMatrix T = tentative_prolongation(A_l, node_offsets, B, coarse_node_offsets, coarse_B);
+            if (T.cols() == 0 or T.cols() >= T.rows()) {
+                break;
+            }
+
+            A_l = MultigridHierarchy<Scalar>::galerkin_product(A_l, T);
+            p_tentative_prolongations.emplace_back(std::move(T));
+            node_offsets = std::move(coarse_node_offsets);
+            B = std::move(coarse_B);
+        }
+    }
+
+    /**
+     * Aggregate the nodes of the operator A (the degrees of freedom of node n being node_offsets[n] to
+     * node_offsets[n+1]-1) and compute the tentative prolongation of the near-nullspace B. The node offsets and the
+     * near-nullspace of the coarse level are returned in coarse_node_offsets and coarse_B.
+     */
+    SparseMatrix tentative_prolongation(const SparseMatrix & A, const std::vector<Index> & node_offsets, const DenseMatrix & B,
+                                        std::vector<Index> & coarse_node_offsets, DenseMatrix & coarse_B) const {
+        const Index n = A.rows();
+        const auto nb_nodes = static_cast<Index>(node_offsets.size()) - 1;
+        std::vector<Index> node_of_dof (n);
+        for (Index i = 0; i < nb_nodes; ++i) {
+            std::fill(node_of_dof.begin() + node_offsets[i], node_of_dof.begin() + node_offsets[i+1], i);
+        }
+
+        // Strength of the coupling between two nodes (Frobenius norm of their block), and the decoupled degrees of freedom
+        std::vector<bool> coupled (n, false);
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        triplets.reserve(A.nonZeros());
+        for (Index j = 0; j < A.outerSize(); ++j) {
+            for (typename SparseMatrix::InnerIterator it(A, j); it; ++it) {
+                if (it.value() == Scalar(0)) {
+                    continue;
+                }
+                if (it.row() != j) {
+                    coupled[it.row()] = coupled[j] = true;
+                }
+                triplets.emplace_back(node_of_dof[it.row()], node_of_dof[j], it.value()*it.value());
+            }
+        }
+        SparseMatrix S(nb_nodes, nb_nodes);
+        S.setFromTriplets(triplets.begin(), triplets.end());
+
+        std::vector<std::vector<std::pair<Index, Scalar>>> strong_neighbors (nb_nodes);
+        {
+            const Vector diagonal = S.diagonal().cwiseSqrt();
+            for (Index j = 0; j < S.outerSize(); ++j) {
+                for (typename SparseMatrix::InnerIterator it(S, j); it; ++it) {
+                    const Scalar s = std::sqrt(it.value());
+                    if (it.row() != j and s > p_strength_threshold*std::sqrt(diagonal[it.row()]*diagonal[j])) {
+                        strong_neighbors[j].emplace_back(it.row(), s);
+                    }
+                }
+            }
+        }
+
+        // A node having only decoupled degrees of freedom isn't part of any aggregate
+        std::vector<Index> aggregate_of_node (nb_nodes, -1);
+        for (Index i = 0; i < nb_nodes; ++i) {
+            if (std::none_of(coupled.begin() + node_offsets[i], coupled.begin() + node_offsets[i+1], [](bool c) {return c;})) {
+                aggregate_of_node[i] = -2;
+            }
+        }
+
+        // 1. A node whose strong neighbors are all free forms a new aggregate with them
+        Index nb_aggregates = 0;
+        for (Index i = 0; i < nb_nodes; ++i) {
+            if (aggregate_of_node[i] != -1 or strong_neighbors[i].empty()) {
+                continue;
+            }
+            const bool all_free = std::all_of(strong_neighbors[i].begin(), strong_neighbors[i].end(), [&](const auto & neighbor) {
+                return aggregate_of_node[neighbor.first] == -1;
+            });
+            if (all_free) {
+                aggregate_of_node[i] = nb_aggregates;
+                for (const auto & neighbor : strong_neighbors[i]) {
+                    aggregate_of_node[neighbor.first] = nb_aggregates;
+                }
+                ++nb_aggregates;
+            }
+        }
+
+        // 2. The remaining nodes join the aggregate of their strongest neighbor built in the first pass
+        {
+            const std::vector<Index> first_pass = aggregate_of_node;
+            for (Index i = 0; i < nb_nodes; ++i) {
+                if (first_pass[i] != -1) {
+                    continue;
+                }
+                Scalar strongest = 0;
+                for (const auto & neighbor : strong_neighbors[i]) {
+                    if (first_pass[neighbor.first] >= 0 and neighbor.second > strongest) {
+                        strongest = neighbor.second;
+                        aggregate_of_node[i] = first_pass[neighbor.first];
+                    }
+                }
+            }
+        }
+
+        // 3. The nodes still left form new aggregates with their free strong neighbors
+        for (Index i = 0; i < nb_nodes; ++i) {
+            if (aggregate_of_node[i] != -1) {
+                continue;
+            }
+            aggregate_of_node[i] = nb_aggregates;
+            for (const auto & neighbor : strong_neighbors[i]) {
+                if (aggregate_of_node[neighbor.first] == -1) {
+                    aggregate_of_node[neighbor.first] = nb_aggregates;
+                }
+            }
+            ++nb_aggregates;
+        }
+
+        // Coupled degrees of freedom of every aggregates
+        std::vector<std::vector<Index>> aggregates (nb_aggregates);
+        for (Index i = 0; i < nb_nodes; ++i) {
+            if (aggregate_of_node[i] < 0) {
+                continue;
+            }
+            for (Index dof = node_offsets[i]; dof < node_offsets[i+1]; ++dof) {
+                if (coupled[dof]) {
+                    aggregates[aggregate_of_node[i]].emplace_back(dof);
+                }
+            }
+        }
+
+        // Tentative prolongation: orthonormal basis of the near-nullspace restricted to every aggregates
+        const Index k = B.cols();
+        std::vector<DenseMatrix> coarse_B_blocks (nb_aggregates);
+        triplets.clear();
+        coarse_node_offsets.assign(1, 0);
+        for (Index a = 0; a < nb_aggregates; ++a) {
+            const auto & dofs = aggregates[a];
+            const auto m = static_cast<Index>(dofs.size());
+            DenseMatrix B_a (m, k);
+            for (Index r = 0; r < m; ++r) {
+                B_a.row(r) = B.row(dofs[r]);
+            }
+
+            // B_a Pi = Q R, the columns of Q beyond the rank of B_a being dropped
+            Eigen::ColPivHouseholderQR<DenseMatrix> qr (B_a);
+            const Index rank = qr.rank();
+            const DenseMatrix Q = qr.householderQ() * DenseMatrix::Identity(m, rank);
+            const DenseMatrix R = qr.matrixR().topRows(rank).template triangularView<Eigen::Upper>();
+            coarse_B_blocks[a] = R * qr.colsPermutation().transpose();
+
+            const Index offset = coarse_node_offsets.back();
+            for (Index r = 0; r < m; ++r) {
+                for (Index c = 0; c < rank; ++c) {
+                    triplets.emplace_back(dofs[r], offset + c, Q(r, c));
+                }
+            }
+            coarse_node_offsets.emplace_back(offset + rank);
+        }
+
+        const Index nc = coarse_node_offsets.back();
+        coarse_B.resize(nc, k);
+        for (Index a = 0; a < nb_aggregates; ++a) {
+            coarse_B.middleRows(coarse_node_offsets[a], coarse_B_blocks[a].rows()) = coarse_B_blocks[a];
+        }
+
+        SparseMatrix T(n, nc);
+        T.setFromTriplets(triplets.begin(), triplets.end());
+        return T;
+    }
+
+    /** Smooth the tentative prolongation T with one damped Jacobi iteration: P = (I - w D^-1 A) T */
+    static SparseMatrix smoothed_prolongation(const SparseMatrix & A, const SparseMatrix & T) {
+        const Vector inverse_diagonal = MultigridHierarchy<Scalar>::inverse_diagonal(A);
+
+        // Spectral radius of D^-1 A estimated with a few power iterations
+        Vector v = Vector::LinSpaced(A.rows(), Scalar(1), Scalar(2)).normalized();
+        Scalar rho = 1;
+        for (unsigned int i = 0; i < 15; ++i) {
+            const Vector w = inverse_diagonal.asDiagonal() * (A * v);
+            rho = w.norm();
+            if (rho == Scalar(0)) {
+                return T;
+            }
+            v = w / rho;
+        }
+
+        const Scalar omega = Scalar(4) / (Scalar(3) * rho);
+        const SparseMatrix AT = A * T;
+        const SparseMatrix DAT = (omega * inverse_diagonal).asDiagonal() * AT;
+        return SparseMatrix(T - DAT);
+    }
+
+    ///< Operators of every levels and their V-cycle
+    MultigridHierarchy<Scalar> p_hierarchy;
+
+    ///< Unsmoothed prolongations from every coarse levels to the next finer level, reused until the pattern changes
+    std::vector<SparseMatrix> p_tentative_prolongations;
+
+    ///< Near-nullspace of the finest level (one column per mode)
+    DenseMatrix p_near_nullspace;
+
+    ///< Number of degrees of freedom per node of the finest level
+    Index p_dofs_per_node = 1;
+
+    ///< Maximum number of levels (0 for no maximum)
+    unsigned int p_maximum_number_of_levels = 0;
+
+    ///< Coarsening stops when a level has less degrees of freedom than this size
+    Index p_coarsest_size = 1000;
+
+    ///< Relative strength of the coupling between two nodes for them to be aggregated together
+    Scalar p_strength_threshold = 0.08;
+
+    ///< Number of times the aggregates have been built
+    unsigned int p_number_of_aggregations = 0;
+
+    bool p_nodes_are_set = false;
+    bool p_aggregates_are_valid = false;
+    bool p_is_initialized = false;
+};
+
+} // namespace SofaCaribou::Algebra
@@ -0,0 +1,67 @@
+#include "BlockDiagonalStiffness.h"
+
+#include <sofa/core/behavior/BaseMass.h>
+#include <sofa/core/behavior/ForceField.h>
+#include <sofa/defaulttype/VecTypes.h>
+#include <SofaBaseLinearSolver/FullMatrix.h>
+
+namespace SofaCaribou::GraphComponents::forcefield {
+
+auto add_diagonal_node_blocks(const sofa::core::objectmodel::BaseContext * context,
+                              const sofa::component::linearsolver::DefaultMultiMatrixAccessor & accessor,
+                              const sofa::core::MechanicalParams * mparams,
+                              BlockDiagonalStiffness<3>::Blocks & blocks) -> std::vector<sofa::core::behavior::BaseForceField *> {
+    using Vec3Types = sofa::defaulttype::Vec3Types;
+    using Blocks = BlockDiagonalStiffness<3>::Blocks;
+    std::vector<sofa::core::behavior::BaseForceField *> ignored;
+
+    std::vector<sofa::core::behavior::BaseForceField *> forcefields;
+    context->getObjects<sofa::core::behavior::BaseForceField>(&forcefields, sofa::core::objectmodel::BaseContext::SearchDown);
+
+    for (auto * forcefield : forcefields) {
+        auto * vec3_forcefield = dynamic_cast<sofa::core::behavior::ForceField<Vec3Types> *>(forcefield);
+        auto * mass = dynamic_cast<sofa::core::behavior::BaseMass *>(forcefield);
+        auto * stiffness = dynamic_cast<BlockDiagonalStiffness<3> *>(forcefield);
+
+        // Offset of the forcefield's mechanical state in the global system (-1 if it is a mapped state)
+        const auto * state = (vec3_forcefield) ? vec3_forcefield->getMState() : nullptr;
+        const auto offset = (state) ? accessor.getGlobalOffset(state) : -1;
+        const auto nb_nodes = (state) ? static_cast<std::size_t>(state->getSize()) : 0;
+        if (offset < 0 or offset % 3 != 0 or offset/3 + nb_nodes > blocks.size() or (not mass and not stiffness)) {
+            ignored.push_back(forcefield);
+            continue;
+        }
+
+        const auto first_node = static_cast<std::size_t>(offset/3);
+        if (mass) {
+            const auto m_coef = static_cast<FLOATING_POINT_TYPE>(mparams->mFactor());
+            if (m_coef == 0) {
+                continue;
+            }
+            sofa::component::linearsolver::FullMatrix<FLOATING_POINT_TYPE> element_mass (3, 3);
+            for (std::size_t i = 0; i < nb_nodes; ++i) {
+                mass->getElementMass(static_cast<unsigned int>(i), &element_mass);
+                for (int r = 0; r < 3; ++r) {
+                    for (int c = 0; c < 3; ++c) {
+                        blocks[first_node+i](r, c) += m_coef*element_mass.element(r, c);
+                    }
+                }
+            }
+        } else {
+            if (first_node == 0 and nb_nodes == blocks.size()) {
+                stiffness->add_stiffness_diagonal_blocks(mparams, blocks);
+            } else {
+                // The forcefield's mechanical state is only a part of the system
+                Blocks local_blocks (nb_nodes, BlockDiagonalStiffness<3>::Block::Zero());
+                stiffness->add_stiffness_diagonal_blocks(mparams, local_blocks);
+                for (std::size_t i = 0; i < nb_nodes; ++i) {
+                    blocks[first_node+i] += local_blocks[i];
+                }
+            }
+        }
+    }
+
+    return ignored;
+}
+
+} // namespace SofaCaribou::GraphComponents::forcefield
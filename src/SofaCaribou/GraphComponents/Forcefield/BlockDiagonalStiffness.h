@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <Eigen/Core>
+#include <sofa/core/MechanicalParams.h>
+#include <sofa/core/behavior/BaseForceField.h>
+#include <sofa/core/objectmodel/BaseContext.h>
+#include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
+#include <vector>
+
+namespace SofaCaribou::GraphComponents::forcefield {
+
+/**
+ * Interface of the forcefields able to compute the DxD diagonal node blocks of their stiffness matrix without
+ * assembling the complete matrix.
+ *
+ * The block-Jacobi preconditioner of the matrix-free conjugate gradient (see the NodeBlockJacobi preconditioning
+ * method of the ConjugateGradientSolver) gathers these blocks from every forcefields of the scene instead of
+ * assembling the global system matrix.
+ */
+template <int Dimension>
+class BlockDiagonalStiffness {
+public:
+    using Block = Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, Dimension, Eigen::RowMajor>;
+    using Blocks = std::vector<Block, Eigen::aligned_allocator<Block>>;
+
+    virtual ~BlockDiagonalStiffness() = default;
+
+    /**
+     * Add the diagonal block of every nodes of the forcefield's mechanical state to blocks[node_id]. These are the
+     * diagonal blocks of what addKToMatrix would add to the system matrix, i.e. of kFactor * df/dx, with kFactor
+     * including the rayleigh stiffness.
+     *
+     * @param blocks One block per node of the mechanical state.
+     */
+    virtual void add_stiffness_diagonal_blocks(const sofa::core::MechanicalParams * mparams, Blocks & blocks) = 0;
+};
+
+/**
+ * Add the 3x3 diagonal node blocks of the matrix (mM + kK) of the masses and the forcefields found in the context
+ * sub-graph to blocks, without assembling the matrix. The factors m and k are the ones of mparams.
+ *
+ * The stiffness blocks are given by the forcefields implementing BlockDiagonalStiffness<3>, and the mass blocks by
+ * the element mass of the nodes. The other forcefields, the damping and the mapped mechanical states are ignored.
+ *
+ * @param accessor Gives the offset of each mechanical state in the global system
+ * @param blocks One block per node of the global system
+ * @return The ignored components
+ */
+auto add_diagonal_node_blocks(const sofa::core::objectmodel::BaseContext * context,
+                              const sofa::component::linearsolver::DefaultMultiMatrixAccessor & accessor,
+                              const sofa::core::MechanicalParams * mparams,
+                              BlockDiagonalStiffness<3>::Blocks & blocks) -> std::vector<sofa::core::behavior::BaseForceField *>;
+
+} // namespace SofaCaribou::GraphComponents::forcefield
@@ -0,0 +1,31 @@
+#pragma once
+
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace SofaCaribou::GraphComponents::forcefield {
+
+/**
+ * Description of the number_of_threads data of the forcefields computing their elemental quantities in parallel.
+ */
+constexpr const char * number_of_threads_description =
+    "Number of threads used for the elemental computations. A value of 1 (default) disables the parallel "
+    "computation, while a value lower or equal to 0 uses every threads made available by OpenMP. The result is "
+    "identical to the sequential computation no matter the number of threads used. Requires Caribou to be compiled "
+    "with OpenMP.";
+
+/**
+ * Get the number of threads that should be used for the elemental loops from the value of a number_of_threads data
+ * (1 if OpenMP is not available).
+ */
+inline auto number_of_threads(const int & requested_number_of_threads) -> int {
+#ifdef CARIBOU_WITH_OPENMP
+    return (requested_number_of_threads > 0) ? requested_number_of_threads : omp_get_max_threads();
+#else
+    (void) requested_number_of_threads;
+    return 1;
+#endif
+}
+
+} // namespace SofaCaribou::GraphComponents::forcefield
@@ -480,6 +480,34 @@ void FictitiousGridElasticForce::addKToMatrix(sofa::defaulttype::BaseMatrix * ma
     sofa::helper::AdvancedTimer::stepEnd("FictitiousGridElasticForce::addKToMatrix");
 }
 
+void FictitiousGridElasticForce::add_stiffness_diagonal_blocks(const MechanicalParams * mparams, Blocks & blocks)
+{
+    auto * grid = d_grid_container.get();
+
+    if (!grid)
+        return;
+
+    if (recompute_compute_tangent_stiffness)
+        compute_K();
+
+    const auto kFactor = static_cast<Real>(mparams->kFactorIncludingRayleighDamping(this->rayleighStiffness.getValue()));
+
+    sofa::helper::AdvancedTimer::stepBegin("FictitiousGridElasticForce::add_stiffness_diagonal_blocks");
+
+    for (std::size_t hexa_id = 0; hexa_id < grid->number_of_cells(); ++hexa_id) {
+        const auto & node_indices = grid->get_node_indices_of(hexa_id);
+        const Mat33 & R  = p_current_rotation[hexa_id];
+        const auto & K = p_stiffness_matrices[hexa_id];
+
+        for (Eigen::Index i = 0; i < 8; ++i) {
+            const Mat33 k = -kFactor * R*K.block<3, 3>(i*3, i*3)*R.transpose();
+            blocks[node_indices[i]] += k.cast<FLOATING_POINT_TYPE>();
+        }
+    }
+
+    sofa::helper::AdvancedTimer::stepEnd("FictitiousGridElasticForce::add_stiffness_diagonal_blocks");
+}
+
 void FictitiousGridElasticForce::compute_K()
 {
     auto grid = d_grid_container.get();
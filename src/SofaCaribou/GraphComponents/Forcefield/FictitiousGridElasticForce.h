@@ -9,6 +9,7 @@
 
 #include <Caribou/Geometry/Hexahedron.h>
 #include <Caribou/Geometry/RectangularHexahedron.h>
+#include <SofaCaribou/GraphComponents/Forcefield/BlockDiagonalStiffness.h>
 #include <SofaCaribou/GraphComponents/Topology/FictitiousGrid.h>
 
 namespace SofaCaribou::GraphComponents::forcefield {
@@ -19,7 +20,7 @@ using namespace sofa::core::behavior;
 using namespace sofa::core::topology;
 using sofa::defaulttype::Vec3Types;
 
-class FictitiousGridElasticForce : public ForceField<Vec3Types>
+class FictitiousGridElasticForce : public ForceField<Vec3Types>, public BlockDiagonalStiffness<3>
 {
 public:
     SOFA_CLASS(FictitiousGridElasticForce, SOFA_TEMPLATE(ForceField, Vec3Types));
@@ -32,6 +33,7 @@ public:
     using Coord    = typename DataTypes::Coord;
     using Deriv    = typename DataTypes::Deriv;
     using Real     = typename Coord::value_type;
+    using Blocks   = BlockDiagonalStiffness<3>::Blocks;
 
     using FictitiousGrid = SofaCaribou::GraphComponents::topology::FictitiousGrid<DataTypes>;
 
@@ -111,6 +113,9 @@ public:
 
     void addKToMatrix(sofa::defaulttype::BaseMatrix * /*matrix*/, SReal /*kFact*/, unsigned int & /*offset*/) override;
 
+    /** Add the diagonal node blocks of kFactor * df/dx to blocks (see BlockDiagonalStiffness) */
+    void add_stiffness_diagonal_blocks(const MechanicalParams * mparams, Blocks & blocks) override;
+
     void computeBBox(const sofa::core::ExecParams* params, bool onlyVisible) override;
 
     template <typename T>
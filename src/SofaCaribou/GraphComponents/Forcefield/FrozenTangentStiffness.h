@@ -0,0 +1,24 @@
+#pragma once
+
+namespace SofaCaribou::GraphComponents::forcefield {
+
+/**
+ * Interface of the forcefields able to keep their current tangent stiffness while their forces are evaluated at new
+ * positions.
+ *
+ * This is used by the modified newton method of the StaticODESolver (see its tangent_reuse option), which reuses the
+ * tangent stiffness of a previous newton iteration instead of rebuilding it at every iteration.
+ */
+class FrozenTangentStiffness {
+public:
+    virtual ~FrozenTangentStiffness() = default;
+
+    /**
+     * Freeze or unfreeze the tangent stiffness. While frozen, the forcefield keeps its current tangent stiffness (the
+     * one of its last update) instead of rebuilding it at the positions of the following calls to addForce.
+     * Unfreezing outdates the current tangent stiffness, which will be rebuilt at the positions of the last addForce.
+     */
+    virtual void set_tangent_stiffness_frozen(bool frozen) = 0;
+};
+
+} // namespace SofaCaribou::GraphComponents::forcefield
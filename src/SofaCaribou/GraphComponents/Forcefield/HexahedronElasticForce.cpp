@@ -13,6 +13,7 @@
 #include <Caribou/Mechanics/Elasticity/Strain.h>
 
 #include "HexahedronElasticForce.h"
+#include <SofaCaribou/GraphComponents/Forcefield/ElementThreads.h>
 
 #if !EIGEN_VERSION_AT_LEAST(3,3,0)
 namespace Eigen {
@@ -56,6 +57,18 @@ HexahedronElasticForce::HexahedronElasticForce()
                   OnePointGauss: One gauss point integration at the center of the hexahedron
                 )",
         true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_number_of_threads(initData(&d_number_of_threads,
+        int(1), "number_of_threads",
+        number_of_threads_description,
+        true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_single_precision_stiffness(initData(&d_single_precision_stiffness,
+        bool(false), "single_precision_stiffness",
+        "Store the elemental stiffness matrices in single precision (float). The matrices are still computed, and "
+        "their products accumulated, in double precision. Only the tangent products (addDForce, addKToMatrix and "
+        "the diagonal blocks) read the stored matrices: the elastic forces are integrated in double precision, so "
+        "the equilibrium is unchanged. This halves the memory footprint and the memory traffic of the tangent "
+        "products, at the price of a less accurate tangent stiffness matrix (more iterations may be needed).",
+        true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
 , d_topology_container(initLink(
         "topology_container", "Topology that contains the elements on which this force will be computed."))
 {
@@ -175,7 +188,13 @@ void HexahedronElasticForce::reinit()
     msg_info() << "Total volume is " << v;
 
     // Initialize the stiffness matrix of every hexahedrons
-    p_stiffness_matrices.resize(topology->getNbHexahedra());
+    if (d_single_precision_stiffness.getValue()) {
+        p_single_precision_stiffness_matrices.resize(topology->getNbHexahedra());
+        std::vector<Matrix<24, 24>>().swap(p_stiffness_matrices);
+    } else {
+        p_stiffness_matrices.resize(topology->getNbHexahedra());
+        std::vector<Eigen::Matrix<float, 24, 24, Eigen::RowMajor>>().swap(p_single_precision_stiffness_matrices);
+    }
     p_initial_rotation.resize(topology->getNbHexahedra(), Mat33::Identity());
     p_current_rotation.resize(topology->getNbHexahedra(), Mat33::Identity());
 
@@ -191,6 +210,11 @@ void HexahedronElasticForce::reinit()
         }
     }
 
+    // Compute the list of hexahedrons containing each nodes (used to gather the force increments in parallel)
+    p_node_elements = caribou::topology::NodeElementAdjacency(X.size(), topology->getNbHexahedra(), 8, [topology] (const std::size_t & hexa_id) {
+        return topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id));
+    });
+
     // Compute the initial tangent stiffness matrix
     compute_K();
 }
@@ -212,7 +236,7 @@ void HexahedronElasticForce::addForce(
     if (!topology or !state)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbHexahedra())
+    if (p_quadrature_nodes.size() != topology->getNbHexahedra())
         return;
 
     sofa::helper::ReadAccessor<Data<VecCoord>> x = d_x;
@@ -259,8 +283,7 @@ void HexahedronElasticForce::addForce(
             }
 
             // Compute the force vector
-            const auto &K = p_stiffness_matrices[hexa_id];
-            Vec24 F = K * U;
+            Vec24 F = linear_elastic_force(hexa_id, U);
 
             // Write the forces into the output vector
             i = 0;
@@ -352,7 +375,7 @@ void HexahedronElasticForce::addDForce(
     if (!topology or !state)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbHexahedra())
+    if (p_quadrature_nodes.size() != topology->getNbHexahedra())
         return;
 
     if (recompute_compute_tangent_stiffness)
@@ -365,8 +388,10 @@ void HexahedronElasticForce::addDForce(
 
     sofa::helper::AdvancedTimer::stepBegin("HexahedronElasticForce::addDForce");
     const auto number_of_elements = topology->getNbHexahedra();
-    for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
+    const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
 
+    // Compute the rotated force increment vector of an hexahedron
+    const auto hexa_force_increment = [&](const std::size_t & hexa_id) -> Vec24 {
         const Mat33 & R  = current_rotation[hexa_id];
         const Mat33 & Rt = R.transpose();
 
@@ -383,20 +408,49 @@ void HexahedronElasticForce::addDForce(
         }
 
         // Compute the force vector
-        const auto & K = p_stiffness_matrices[hexa_id];
-        Vec24 F = K*U*kFactor;
+        Vec24 F = stiffness_product(hexa_id, U)*kFactor;
 
-        // Write the forces into the output vector
-        i = 0;
-        for (const auto & node_id : topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id))) {
-            Vec3 force {F[i*3+0], F[i*3+1], F[i*3+2]};
-            force = R*force;
+        for (i = 0; i < 8; ++i) {
+            F.segment<3>(i*3) = (R*F.segment<3>(i*3)).eval();
+        }
+
+        return F;
+    };
 
-            df[node_id][0] -= force[0];
-            df[node_id][1] -= force[1];
-            df[node_id][2] -= force[2];
+    if (nb_threads == 1 or p_node_elements.number_of_nodes() != df.size()) {
+        for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
+            const Vec24 F = hexa_force_increment(hexa_id);
 
-            ++i;
+            // Write the forces into the output vector
+            Eigen::Index i = 0;
+            for (const auto & node_id : topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id))) {
+                df[node_id][0] -= F[i*3+0];
+                df[node_id][1] -= F[i*3+1];
+                df[node_id][2] -= F[i*3+2];
+
+                ++i;
+            }
+        }
+    } else {
+        p_elements_force_increments.resize(number_of_elements);
+
+        // First, compute the force increment vector of every hexahedrons
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+        for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
+            p_elements_force_increments[hexa_id] = hexa_force_increment(hexa_id);
+        }
+
+        // Then, gather for each node the force increments of the hexahedrons containing it
+        const auto & adjacency = p_node_elements;
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+        for (std::size_t node_id = 0; node_id < adjacency.number_of_nodes(); ++node_id) {
+            for (auto k = adjacency.begin(node_id); k < adjacency.end(node_id); ++k) {
+                const auto & F = p_elements_force_increments[adjacency[k].element_id];
+                const auto i = static_cast<Eigen::Index>(adjacency[k].local_node_id);
+                df[node_id][0] -= F[i*3+0];
+                df[node_id][1] -= F[i*3+1];
+                df[node_id][2] -= F[i*3+2];
+            }
         }
     }
     sofa::helper::AdvancedTimer::stepEnd("HexahedronElasticForce::addDForce");
@@ -422,7 +476,7 @@ void HexahedronElasticForce::addKToMatrix(sofa::defaulttype::BaseMatrix * matrix
         const Mat33 & R  = current_rotation[hexa_id];
         const Mat33   Rt = R.transpose();
 
-        const auto & K = p_stiffness_matrices[hexa_id];
+        const Mat2424 K = stiffness_matrix_of(hexa_id);
 
         for (size_t i = 0; i < 8; ++i) {
             for (size_t j = 0; j < 8; ++j) {
@@ -450,6 +504,41 @@ void HexahedronElasticForce::addKToMatrix(sofa::defaulttype::BaseMatrix * matrix
     sofa::helper::AdvancedTimer::stepEnd("HexahedronElasticForce::addKToMatrix");
 }
 
+void HexahedronElasticForce::add_stiffness_diagonal_blocks(const MechanicalParams * mparams, Blocks & blocks)
+{
+    auto * topology = d_topology_container.get();
+
+    if (!topology)
+        return;
+
+    if (p_quadrature_nodes.size() != topology->getNbHexahedra())
+        return;
+
+    if (recompute_compute_tangent_stiffness)
+        compute_K();
+
+    const auto kFactor = static_cast<Real>(mparams->kFactorIncludingRayleighDamping(this->rayleighStiffness.getValue()));
+
+    sofa::helper::AdvancedTimer::stepBegin("HexahedronElasticForce::add_stiffness_diagonal_blocks");
+
+    const auto number_of_elements = topology->getNbHexahedra();
+    const bool single = d_single_precision_stiffness.getValue();
+    for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
+        const auto & node_indices = topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id));
+        const Mat33 & R  = p_current_rotation[hexa_id];
+
+        for (Eigen::Index i = 0; i < 8; ++i) {
+            // Only the diagonal block of the stored elemental matrix is read
+            const Mat33 K_ii = (single) ? Mat33(p_single_precision_stiffness_matrices[hexa_id].block<3, 3>(i*3, i*3).cast<Real>())
+                                        : Mat33(p_stiffness_matrices[hexa_id].block<3, 3>(i*3, i*3));
+            const Mat33 k = -kFactor * R*K_ii*R.transpose();
+            blocks[node_indices[i]] += k.cast<FLOATING_POINT_TYPE>();
+        }
+    }
+
+    sofa::helper::AdvancedTimer::stepEnd("HexahedronElasticForce::add_stiffness_diagonal_blocks");
+}
+
 void HexahedronElasticForce::compute_K()
 {
     auto topology = d_topology_container.get();
@@ -457,7 +546,7 @@ void HexahedronElasticForce::compute_K()
     if (!topology)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbHexahedra())
+    if (p_quadrature_nodes.size() != topology->getNbHexahedra())
         return;
 
     static const auto I = Matrix<3,3, Eigen::RowMajor>::Identity();
@@ -470,8 +559,18 @@ void HexahedronElasticForce::compute_K()
     sofa::helper::AdvancedTimer::stepBegin("HexahedronElasticForce::compute_k");
 
     const auto number_of_elements = topology->getNbHexahedra();
+    const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
+    const bool single = d_single_precision_stiffness.getValue();
+    if (single) {
+        p_single_precision_stiffness_matrices.resize(number_of_elements);
+    } else {
+        p_stiffness_matrices.resize(number_of_elements);
+    }
+#pragma omp parallel for num_threads(nb_threads) schedule(dynamic, 64)
     for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
-        auto & K = p_stiffness_matrices[hexa_id];
+        // In single precision, the matrix is computed in double precision before being stored
+        Mat2424 K_double;
+        Mat2424 & K = single ? K_double : p_stiffness_matrices[hexa_id];
         K.fill(0.);
 
         for (GaussNode &gauss_node : p_quadrature_nodes[hexa_id]) {
@@ -535,6 +634,10 @@ void HexahedronElasticForce::compute_K()
                 }
             }
         }
+
+        if (single) {
+            p_single_precision_stiffness_matrices[hexa_id] = K.cast<float>();
+        }
     }
     recompute_compute_tangent_stiffness = false;
     K_is_up_to_date = false;
@@ -542,6 +645,50 @@ void HexahedronElasticForce::compute_K()
     sofa::helper::AdvancedTimer::stepEnd("HexahedronElasticForce::compute_k");
 }
 
+HexahedronElasticForce::Vec24 HexahedronElasticForce::stiffness_product(std::size_t hexahedron_id, const Vec24 & U) const
+{
+    if (d_single_precision_stiffness.getValue()) {
+        // The coefficients are promoted to Real one at a time and accumulated in Real, without any temporary copy
+        return p_single_precision_stiffness_matrices[hexahedron_id].cast<Real>().lazyProduct(U);
+    }
+
+    return p_stiffness_matrices[hexahedron_id] * U;
+}
+
+HexahedronElasticForce::Vec24 HexahedronElasticForce::linear_elastic_force(std::size_t hexahedron_id, const Vec24 & U) const
+{
+    if (not d_single_precision_stiffness.getValue()) {
+        return p_stiffness_matrices[hexahedron_id] * U;
+    }
+
+    static const auto I = Matrix<3,3, Eigen::RowMajor>::Identity();
+    const Real youngModulus = d_youngModulus.getValue();
+    const Real poissonRatio = d_poissonRatio.getValue();
+
+    const Real l = youngModulus * poissonRatio / ((1 + poissonRatio) * (1 - 2 * poissonRatio));
+    const Real m = youngModulus / (2 * (1 + poissonRatio));
+
+    const Eigen::Map<const Matrix<8, 3, Eigen::RowMajor>> u (U.data());
+
+    Matrix<8, 3, Eigen::RowMajor> forces;
+    forces.fill(0);
+    for (const GaussNode & gauss_node : p_quadrature_nodes[hexahedron_id]) {
+        const auto & dN_dx = gauss_node.dN_dx;
+
+        // Small strain tensor at gauss node
+        const Mat33 H = dN_dx.transpose() * u;
+        const Mat33 e = 1/2. * (H + H.transpose());
+
+        // Stress tensor at gauss node
+        const Mat33 S = 2.*m*e + (l * e.trace() * I);
+
+        // Elastic forces w.r.t the gauss node applied on each nodes
+        forces.noalias() += (gauss_node.jacobian_determinant * gauss_node.weight) * dN_dx * S;
+    }
+
+    return Eigen::Map<const Vec24>(forces.data());
+}
+
 const Eigen::SparseMatrix<HexahedronElasticForce::Real> & HexahedronElasticForce::K() {
     if (not K_is_up_to_date) {
         const sofa::helper::ReadAccessor<Data<VecCoord>> X = this->mstate->readRestPositions();
@@ -562,7 +709,7 @@ const Eigen::SparseMatrix<HexahedronElasticForce::Real> & HexahedronElasticForce
                 const Mat33 &R = current_rotation[hexa_id];
                 const Mat33 Rt = R.transpose();
 
-                const auto &Ke = p_stiffness_matrices[hexa_id];
+                const Mat2424 Ke = stiffness_matrix_of(hexa_id);
 
                 for (size_t i = 0; i < 8; ++i) {
                     for (size_t j = 0; j < 8; ++j) {
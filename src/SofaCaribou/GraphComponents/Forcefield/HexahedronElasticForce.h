@@ -9,6 +9,8 @@
 #include <sofa/helper/OptionsGroup.h>
 
 #include <Caribou/Geometry/Hexahedron.h>
+#include <Caribou/Topology/NodeElementAdjacency.h>
+#include <SofaCaribou/GraphComponents/Forcefield/BlockDiagonalStiffness.h>
 
 namespace SofaCaribou::GraphComponents::forcefield {
 
@@ -18,7 +20,7 @@ using namespace sofa::core::behavior;
 using namespace sofa::core::topology;
 using sofa::defaulttype::Vec3Types;
 
-class HexahedronElasticForce : public ForceField<Vec3Types>
+class HexahedronElasticForce : public ForceField<Vec3Types>, public BlockDiagonalStiffness<3>
 {
 public:
     SOFA_CLASS(HexahedronElasticForce, SOFA_TEMPLATE(ForceField, Vec3Types));
@@ -31,6 +33,7 @@ public:
     using Coord    = typename DataTypes::Coord;
     using Deriv    = typename DataTypes::Deriv;
     using Real     = typename Coord::value_type;
+    using Blocks   = BlockDiagonalStiffness<3>::Blocks;
 
     using Hexahedron = caribou::geometry::Hexahedron<caribou::geometry::interpolation::Hexahedron8>;
     static constexpr INTEGER_TYPE NumberOfNodes = Hexahedron::NumberOfNodes;
@@ -101,6 +104,9 @@ public:
 
     void addKToMatrix(sofa::defaulttype::BaseMatrix * /*matrix*/, SReal /*kFact*/, unsigned int & /*offset*/) override;
 
+    /** Add the diagonal node blocks of kFactor * df/dx to blocks (see BlockDiagonalStiffness) */
+    void add_stiffness_diagonal_blocks(const MechanicalParams * mparams, Blocks & blocks) override;
+
     void computeBBox(const sofa::core::ExecParams* params, bool onlyVisible) override;
 
     template <typename T>
@@ -147,7 +153,10 @@ public:
         return p_quadrature_nodes[hexahedron_id];
     }
 
-    const Matrix<24, 24> & stiffness_matrix_of(std::size_t hexahedron_id) const {
+    Matrix<24, 24> stiffness_matrix_of(std::size_t hexahedron_id) const {
+        if (d_single_precision_stiffness.getValue()) {
+            return p_single_precision_stiffness_matrices[hexahedron_id].cast<Real>();
+        }
         return p_stiffness_matrices[hexahedron_id];
     }
 
@@ -164,20 +173,35 @@ private:
     /** (Re)Compute the tangent stiffness matrix */
     virtual void compute_K();
 
+    /** Compute K*U for the given hexahedron, with K its stiffness matrix in either single or double precision */
+    Vec24 stiffness_product(std::size_t hexahedron_id, const Vec24 & U) const;
+
+    /**
+     * Compute the small strain elastic force K*U of the given hexahedron. In single precision, the force is integrated
+     * at the gauss nodes in double precision instead of being read from the stored matrix, so that the equilibrium
+     * does not depend on the precision of the stiffness matrices.
+     */
+    Vec24 linear_elastic_force(std::size_t hexahedron_id, const Vec24 & U) const;
+
 protected:
     Data< Real > d_youngModulus;
     Data< Real > d_poissonRatio;
     Data< bool > d_linear_strain;
     Data< bool > d_corotated;
     Data< sofa::helper::OptionsGroup > d_integration_method;
+    Data< int > d_number_of_threads;
+    Data< bool > d_single_precision_stiffness;
     Link<BaseMeshTopology>   d_topology_container;
 
 private:
     bool recompute_compute_tangent_stiffness = false;
     std::vector<Matrix<24, 24>> p_stiffness_matrices;
+    std::vector<Eigen::Matrix<float, 24, 24, Eigen::RowMajor>> p_single_precision_stiffness_matrices;
     std::vector<std::vector<GaussNode>> p_quadrature_nodes;
     std::vector<Mat33> p_initial_rotation;
     std::vector<Mat33> p_current_rotation;
+    caribou::topology::NodeElementAdjacency p_node_elements;
+    std::vector<Vec24> p_elements_force_increments;
     Eigen::SparseMatrix<Real> p_K;
     Vector<Eigen::Dynamic> p_eigenvalues;
     bool K_is_up_to_date = false;
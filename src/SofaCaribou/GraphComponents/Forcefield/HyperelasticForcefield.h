@@ -8,10 +8,15 @@
 
 #include <sofa/core/behavior/ForceField.h>
 #include <sofa/core/topology/BaseMeshTopology.h>
+#include <sofa/helper/OptionsGroup.h>
 
 #include <Caribou/config.h>
 #include <Caribou/Geometry/Traits.h>
+#include <Caribou/Topology/NodeElementAdjacency.h>
 
+#include <SofaCaribou/GraphComponents/Forcefield/BlockDiagonalStiffness.h>
+#include <SofaCaribou/GraphComponents/Forcefield/FrozenTangentStiffness.h>
+#include <SofaCaribou/GraphComponents/Forcefield/HyperelasticKernels.h>
 #include <SofaCaribou/GraphComponents/Material/HyperelasticMaterial.h>
 
 namespace SofaCaribou::GraphComponents::forcefield {
@@ -27,7 +32,9 @@ template <> struct SofaVecType<2> { using Type = sofa::defaulttype::Vec2Types; }
 template <> struct SofaVecType<3> { using Type = sofa::defaulttype::Vec3Types; };
 
 template <typename Element>
-class HyperelasticForcefield : public ForceField<typename SofaVecType<caribou::traits<Element>::Dimension>::Type> {
+class HyperelasticForcefield : public ForceField<typename SofaVecType<caribou::traits<Element>::Dimension>::Type>,
+                               public BlockDiagonalStiffness<caribou::traits<Element>::Dimension>,
+                               public FrozenTangentStiffness {
 public:
     SOFA_CLASS(SOFA_TEMPLATE(HyperelasticForcefield, Element), SOFA_TEMPLATE(ForceField, typename SofaVecType<caribou::traits<Element>::Dimension>::Type));
 
@@ -40,6 +47,7 @@ public:
     using Deriv    = typename DataTypes::Deriv;
     using Real     = typename Coord::value_type;
     using Index    = sofa::core::topology::BaseMeshTopology::index_type;
+    using Blocks   = typename BlockDiagonalStiffness<caribou::traits<Element>::Dimension>::Blocks;
 
     using LocalCoordinates = typename caribou::traits<Element>::LocalCoordinates;
     using WorldCoordinates = typename caribou::traits<Element>::WorldCoordinates;
@@ -78,6 +86,50 @@ public:
         Mat33 F = Mat33::Identity(); // Deformation gradient
     };
 
+    /// Number of elements per batch of the batched (vectorized) element kernels
+    static constexpr INTEGER_TYPE BatchSize = kernels::BatchSize;
+
+    /// Gauss node of a batch of elements stored as a structure of arrays, the ith value of each array being the one
+    /// of the ith element of the batch. The lanes past the last element of the mesh have a null weight. When the
+    /// batched kernels are used, the gauss nodes are only stored in these batches.
+    struct alignas(64) GaussNodesBatch {
+        Real weight[BatchSize];
+        Real jacobian_determinant[BatchSize];
+        Real dN_dx[NumberOfNodes*Dimension][BatchSize]; // dN_dx[i*Dimension+j] = derivative of the ith shape function w.r.t. the coordinate j
+        Real F[Dimension*Dimension][BatchSize]; // Deformation gradient, row by row
+    };
+
+    /// Material state at a gauss node, only stored when the tangent stiffness is applied matrix-free
+    struct GaussNodeTangent {
+        Mat33 F;      ///< Deformation gradient at which S and D were evaluated
+        Vector<6> S;  ///< Second Piola-Kirchhoff stress tensor in Voigt notation (xx, yy, zz, xy, yz, xz)
+        Vector<21> D; ///< Upper triangle (row by row) of the 6x6 jacobian of S in Voigt notation
+    };
+
+    /// Number of DxD blocks in the upper triangle (diagonal included) of an element stiffness matrix
+    static constexpr INTEGER_TYPE NumberOfStiffnessBlocks = NumberOfNodes*(NumberOfNodes+1)/2;
+
+    /// Dense element stiffness matrix, of which only the upper triangle is used
+    template <typename Scalar = Real>
+    using ElementStiffnessMatrix = Eigen::Matrix<Scalar, NumberOfNodes*Dimension, NumberOfNodes*Dimension>;
+
+    /// Element stiffness matrix stored as its upper triangular DxD blocks, (0,0), (0,1), ..., (0,n), (1,1), ...
+    template <typename Scalar = Real>
+    using PackedStiffnessMatrix = std::array<Eigen::Matrix<Scalar, Dimension, Dimension, Eigen::RowMajor>, NumberOfStiffnessBlocks>;
+
+    /// Storage format of the element tangent stiffness matrices.
+    enum class TangentStorage : unsigned int {
+        /// Full (NumberOfNodes*Dimension)^2 dense matrix per element, of which only the upper triangle is used
+        Dense = 0,
+
+        /// Upper triangular DxD blocks only (about 45% less memory for an hexahedron)
+        PackedSymmetric = 1,
+
+        /// No element matrix: K*dx is computed at each gauss node from its deformation gradient, stress tensor and
+        /// stress jacobian (9 + 6 + 21 = 36 scalars per gauss node, i.e. 288 instead of 576 for an hexahedron)
+        MatrixFree = 2
+    };
+
     // Public methods
 
     HyperelasticForcefield();
@@ -109,6 +161,15 @@ public:
 
     void addKToMatrix(sofa::defaulttype::BaseMatrix * /*matrix*/, SReal /*kFact*/, unsigned int & /*offset*/) override;
 
+    /** Add the diagonal node blocks of kFactor * df/dx to blocks (see BlockDiagonalStiffness) */
+    void add_stiffness_diagonal_blocks(const MechanicalParams * mparams, Blocks & blocks) override;
+
+    /**
+     * Keep the current elements tangent stiffness matrices while frozen (see FrozenTangentStiffness). With the
+     * matrix-free tangent storage, the deformation gradient, the stress and its jacobian at the gauss nodes are kept.
+     */
+    void set_tangent_stiffness_frozen(bool frozen) override;
+
     void computeBBox(const sofa::core::ExecParams* params, bool onlyVisible) override;
 
     void draw(const sofa::core::visual::VisualParams* vparams) override;
@@ -117,6 +178,26 @@ public:
     [[nodiscard]] inline
     auto number_of_elements() const -> std::size_t;
 
+    /** Get the storage format of the element tangent stiffness matrices */
+    [[nodiscard]] inline
+    auto tangent_storage() const -> TangentStorage {
+        const auto s = static_cast<TangentStorage> (d_tangent_storage.getValue().getSelectedId());
+        if (s == TangentStorage::PackedSymmetric or s == TangentStorage::MatrixFree)
+            return s;
+        return TangentStorage::Dense;
+    }
+
+    /** True if the element tangent stiffness matrices are stored in single precision */
+    [[nodiscard]] inline
+    auto single_precision_stiffness() const -> bool {
+        return d_single_precision_stiffness.getValue();
+    }
+
+    /** Index of the block (i, j), with i <= j, inside a PackedStiffnessMatrix */
+    static constexpr auto packed_block_index(const std::size_t & i, const std::size_t & j) -> std::size_t {
+        return i*NumberOfNodes - (i*(i-1))/2 + (j-i);
+    }
+
 private:
 
     // These private methods are implemented but can be overridden
@@ -130,6 +211,84 @@ private:
     /** Update the stiffness matrix for every elements */
     virtual void update_stiffness();
 
+    /**
+     * Move the gauss nodes of every elements into batches of BatchSize elements stored as structures of arrays. The
+     * batches are then the only storage of the gauss nodes.
+     */
+    virtual void initialize_elements_batches();
+
+    /** Get a gauss node of an element, from its batch when the batched kernels are used */
+    [[nodiscard]]
+    auto get_gauss_node(const std::size_t & element_id, const std::size_t & gauss_node_id) const -> GaussNode;
+
+    /** True if the gauss nodes of the nb_elements elements have been initialized (in batches or not) */
+    [[nodiscard]]
+    auto gauss_nodes_are_initialized(const std::size_t & nb_elements) const -> bool;
+
+    /**
+     * Compute the nodal forces of every elements (stored in p_elements_force_increments) with the batched kernels,
+     * BatchSize elements at a time. Only the material's stress is evaluated one element at a time.
+     */
+    template <typename Material>
+    void compute_batched_elements_forces(const Material & material, const VecCoord & x, const VecCoord & x0);
+
+    /** Get the upper DxD block (i, j), with i <= j, of the stiffness matrix of an element */
+    [[nodiscard]]
+    auto element_stiffness_block(const std::size_t & element_id, const std::size_t & i, const std::size_t & j) const -> Matrix<Dimension, Dimension, Eigen::RowMajor>;
+
+    /** Compute K*U of an element, where U holds the displacement increments of the element nodes (one per row) */
+    [[nodiscard]]
+    auto element_force_increment(const std::size_t & element_id, const Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> & U) const -> Matrix<NumberOfNodes, Dimension, Eigen::RowMajor>;
+
+    /** Compute K*U of an element from the stress and stress jacobian of its gauss nodes (matrix-free tangent storage) */
+    [[nodiscard]]
+    auto element_matrix_free_force_increment(const std::size_t & element_id, const Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> & U) const -> Matrix<NumberOfNodes, Dimension, Eigen::RowMajor>;
+
+    /**
+     * Get the strain-displacement matrix B of a node at a gauss node, i.e. the derivative of the Green-Lagrange strain
+     * tensor (in Voigt notation) w.r.t. the displacement of the node, from the deformation gradient F and the
+     * derivatives dx of the node's shape function at the gauss node.
+     */
+    [[nodiscard]]
+    static auto strain_displacement_matrix(const Mat33 & F, const Vec3 & dx) -> Matrix<6, 3>;
+
+    /** Unpack the stress tensor and its jacobian (6x6 Voigt matrix) stored at a gauss node */
+    static void unpack_gauss_node_tangent(const GaussNodeTangent & tangent, Mat33 & S, Matrix<6, 6> & D);
+
+    /** Get the memory used by the element tangent stiffness storage, in bytes */
+    [[nodiscard]]
+    auto tangent_storage_size() const -> std::size_t;
+
+    /**
+     * Compute K*U of an element from the upper DxD blocks of its stiffness matrix, where block(i, j) returns the
+     * block Kij (i <= j). The lower blocks are given by Kji = Kij^T.
+     */
+    template <typename BlockGetter>
+    [[nodiscard]]
+    static auto symmetric_blocks_product(const BlockGetter & block, const Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> & U) -> Matrix<NumberOfNodes, Dimension, Eigen::RowMajor>;
+
+    /**
+     * Partition the elements into colors such that elements of the same color do not share any node. This allows
+     * to accumulate the elemental contributions of a same color in parallel without any race condition.
+     */
+    virtual void color_elements();
+
+    /**
+     * Build the node to elements adjacency table used to gather the elemental contributions of each node when the
+     * force increments (addDForce) are computed in parallel.
+     */
+    virtual void initialize_node_elements_adjacency();
+
+    /**
+     * Call f(m) where m is a view of the material calling the methods of its concrete type when it is exactly one of
+     * the materials shipped with Caribou (NeoHookeanMaterial, SaintVenantKirchhoffMaterial). The material calls made
+     * at every gauss node inside f are then resolved at compile time (and can be inlined) instead of going through
+     * the virtual interface. Any other material, including the subclasses of these two, is passed as an
+     * HyperelasticMaterial.
+     */
+    template <typename Function>
+    static void dispatch_material(const material::HyperelasticMaterial<DataTypes> * material, Function && f);
+
     /**
      * Return true if the mesh topology is compatible with the type Element.
      *
@@ -145,15 +304,28 @@ private:
     // Data members
     Link<sofa::core::topology::BaseMeshTopology> d_topology_container;
     Link<material::HyperelasticMaterial<DataTypes>> d_material;
+    Data<int> d_number_of_threads;
+    Data<sofa::helper::OptionsGroup> d_tangent_storage;
+    Data<bool> d_single_precision_stiffness;
+    Data<bool> d_batched_kernels;
 
     // Private variables
-    std::vector<Matrix<NumberOfNodes*Dimension, NumberOfNodes*Dimension>> p_elements_stiffness_matrices;
+    std::vector<ElementStiffnessMatrix<Real>> p_elements_stiffness_matrices;
+    std::vector<PackedStiffnessMatrix<Real>> p_elements_packed_stiffness_matrices;
+    std::vector<ElementStiffnessMatrix<float>> p_elements_single_precision_stiffness_matrices;
+    std::vector<PackedStiffnessMatrix<float>> p_elements_single_precision_packed_stiffness_matrices;
     std::vector<std::array<GaussNode, NumberOfGaussNodes>> p_elements_quadrature_nodes;
+    std::vector<std::array<GaussNodeTangent, NumberOfGaussNodes>> p_elements_quadrature_tangents;
+    std::vector<std::array<GaussNodesBatch, NumberOfGaussNodes>> p_elements_batches;
+    std::vector<std::vector<std::size_t>> p_elements_colors;
+    caribou::topology::NodeElementAdjacency p_node_elements;
+    std::vector<Matrix<NumberOfNodes, Dimension, Eigen::RowMajor>> p_elements_force_increments;
     Eigen::SparseMatrix<Real> p_sparse_K;
     Eigen::Matrix<Real, Eigen::Dynamic, 1> p_eigenvalues;
     bool elements_stiffness_matrices_are_up_to_date = false;
     bool sparse_K_is_up_to_date = false;
     bool eigenvalues_are_up_to_date = false;
+    bool p_tangent_stiffness_is_frozen = false;
 };
 
 } // namespace SofaCaribou::GraphComponents::forcefield
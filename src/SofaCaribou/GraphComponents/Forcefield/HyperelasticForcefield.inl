@@ -1,12 +1,49 @@
 #pragma once
 
 #include <sofa/helper/AdvancedTimer.h>
+#include <algorithm>
+#include <typeinfo>
 #include <Caribou/Mechanics/Elasticity/Strain.h>
+#include <Caribou/Topology/ElementColoring.h>
 #include "HyperelasticForcefield.h"
+#include <SofaCaribou/GraphComponents/Forcefield/ElementThreads.h>
+#include <SofaCaribou/GraphComponents/Material/NeoHookeanMaterial.h>
+#include <SofaCaribou/GraphComponents/Material/SaintVenantKirchhoffMaterial.h>
 #include <sofa/core/visual/VisualParams.h>
 
 namespace SofaCaribou::GraphComponents::forcefield {
 
+namespace internal {
+/**
+ * View of a material known to be exactly of type Material (not of a subclass), calling its methods without going
+ * through the virtual table so that they can be inlined in the gauss nodes loops.
+ */
+template <typename Material, typename DataTypes>
+struct ExactMaterial {
+    using Real = typename DataTypes::Coord::value_type;
+    static constexpr auto Dimension = DataTypes::spatial_dimensions;
+    using Mat = Eigen::Matrix<Real, Dimension, Dimension>;
+
+    const Material & material;
+
+    Real strain_energy_density(const Real & J, const Mat & E) const {
+        return material.Material::strain_energy_density(J, E);
+    }
+
+    Mat PK2_stress(const Real & J, const Mat & E) const {
+        return material.Material::PK2_stress(J, E);
+    }
+
+    Eigen::Matrix<Real, 6, 6> PK2_stress_jacobian(const Real & J, const Mat & E) const {
+        return material.Material::PK2_stress_jacobian(J, E);
+    }
+
+    typename Material::StressAndJacobian PK2_stress_and_jacobian(const Real & J, const Mat & E, bool compute_strain_energy_density) const {
+        return material.Material::PK2_stress_and_jacobian(J, E, compute_strain_energy_density);
+    }
+};
+} // namespace internal
+
 template <typename Element>
 HyperelasticForcefield<Element>::HyperelasticForcefield()
 : d_topology_container(initLink(
@@ -15,7 +52,48 @@ HyperelasticForcefield<Element>::HyperelasticForcefield()
 , d_material(initLink(
     "material",
     "Material used to compute the hyperelastic force field."))
+, d_number_of_threads(initData(&d_number_of_threads,
+    1,
+    "number_of_threads",
+    number_of_threads_description))
+, d_tangent_storage(initData(&d_tangent_storage,
+    "tangent_storage",
+    R"(
+        Storage format of the element tangent stiffness matrices.
+
+        Formats are:
+          Dense:           Full dense matrix for each element (default).
+          PackedSymmetric: Only the upper triangular DxD blocks of each element matrix are stored, which reduces
+                           the memory footprint and the memory traffic of the matrix-vector products by about 45%.
+          MatrixFree:      No element matrix is stored. The deformation gradient, the stress tensor and its jacobian
+                           are stored at every gauss nodes, and the products K*dx are computed on the fly from them.
+                           This is the storage with the lowest memory footprint (about 50% less than Dense for an
+                           hexahedron), but each product costs more operations.
+    )"))
+, d_single_precision_stiffness(initData(&d_single_precision_stiffness,
+    false,
+    "single_precision_stiffness",
+    "Store the element tangent stiffness matrices in single precision (float), independently of the scalar type "
+    "of the mechanical state. The matrices are still computed in double precision, and the products with the "
+    "stiffness matrices are accumulated in double precision. This halves the memory footprint and the memory "
+    "traffic of the matrix-vector products at the price of a less accurate tangent (which may slightly increase "
+    "the number of Newton iterations), but the residual (internal forces) is never affected. Has no effect with "
+    "the MatrixFree tangent storage."))
+, d_batched_kernels(initData(&d_batched_kernels,
+    false,
+    "batched_kernels",
+    "Compute the deformation gradients, the strain tensors and the nodal forces of batches of 8 elements at once "
+    "with vectorized kernels. The material's stress is still evaluated one element at a time. The gauss nodes are "
+    "then only stored as structures of arrays. "
+    "When Caribou is compiled with CARIBOU_WITH_RUNTIME_DISPATCH, the instruction set of the kernels (AVX-512, "
+    "AVX2, ...) is selected at runtime w.r.t. the CPU."))
 {
+    d_tangent_storage.setValue(sofa::helper::OptionsGroup(std::vector<std::string> {
+        "Dense", "PackedSymmetric", "MatrixFree"
+    }));
+
+    sofa::helper::WriteAccessor<Data< sofa::helper::OptionsGroup >> tangent_storage = d_tangent_storage;
+    tangent_storage->setSelectedItem(static_cast<unsigned int>(0));
 }
 
 template <typename Element>
@@ -72,8 +150,25 @@ void HyperelasticForcefield<Element>::init()
     // Compute and store the shape functions and their derivatives for every integration points
     initialize_elements();
 
+    // Copy the quadrature nodes into batches of elements for the batched kernels
+    if (d_batched_kernels.getValue()) {
+        initialize_elements_batches();
+        msg_info() << "The batched element kernels use the '" << kernels::instruction_set() << "' instruction set.";
+    } else {
+        std::vector<std::array<GaussNodesBatch, NumberOfGaussNodes>>().swap(p_elements_batches);
+    }
+
+    // Partition the elements into groups that can be computed concurrently
+    color_elements();
+
+    // Compute the list of elements containing each nodes
+    initialize_node_elements_adjacency();
+
     // Update the stiffness matrix for every elements
     update_stiffness();
+
+    msg_info() << "The element tangent stiffness (" << d_tangent_storage.getValue().getSelectedItem() << ") uses "
+               << tangent_storage_size() / 1024. / 1024. << " MB.";
 }
 
 template <typename Element>
@@ -111,7 +206,7 @@ void HyperelasticForcefield<Element>::addForce(
     if (nb_nodes == 0 || nb_elements == 0)
         return;
 
-    if (p_elements_quadrature_nodes.size() != nb_elements)
+    if (not gauss_nodes_are_initialized(nb_elements))
         return;
 
     const Map<Eigen::Dynamic, Dimension>    X       (sofa_x.ref().data()->data(),  nb_nodes, Dimension);
@@ -121,78 +216,137 @@ void HyperelasticForcefield<Element>::addForce(
 
     sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::addForce");
 
-    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+    if (d_batched_kernels.getValue()) {
+        dispatch_material(material, [&](const auto & m) {
+            compute_batched_elements_forces(m, sofa_x.ref(), sofa_x0.ref());
+        });
+
+        // Accumulate the elemental forces into the global force vector, following the elements order
+        const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
+        if (nb_threads == 1 or p_node_elements.number_of_nodes() != nb_nodes) {
+            for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+                const Index * node_indices = get_element_nodes_indices(element_id);
+                for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                    forces.row(node_indices[i]) -= p_elements_force_increments[element_id].row(i);
+                }
+            }
+        } else {
+            const auto & adjacency = p_node_elements;
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+            for (std::size_t node_id = 0; node_id < adjacency.number_of_nodes(); ++node_id) {
+                for (auto k = adjacency.begin(node_id); k < adjacency.end(node_id); ++k) {
+                    const auto & entry = adjacency[k];
+                    forces.row(node_id) -= p_elements_force_increments[entry.element_id].row(entry.local_node_id);
+                }
+            }
+        }
+    } else {
+        dispatch_material(material, [&](const auto & m) {
+            const auto add_element_force = [&](const std::size_t & element_id) {
 
-        // Fetch the node indices of the element
-        const Index * node_indices = get_element_nodes_indices(element_id);
+                // Fetch the node indices of the element
+                const Index * node_indices = get_element_nodes_indices(element_id);
 
-        // Fetch the initial and current positions of the element's nodes
-        Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> initial_nodes_position;
-        Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> current_nodes_position;
+                // Fetch the initial and current positions of the element's nodes
+                Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> initial_nodes_position;
+                Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> current_nodes_position;
 
-        for (std::size_t i = 0; i < NumberOfNodes; ++i) {
-            initial_nodes_position.row(i).noalias() = X0.row(node_indices[i]);
-            current_nodes_position.row(i).noalias() = X.row(node_indices[i]);
-        }
+                for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                    initial_nodes_position.row(i).noalias() = X0.row(node_indices[i]);
+                    current_nodes_position.row(i).noalias() = X.row(node_indices[i]);
+                }
 
-        // Compute the nodal displacement
-        Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> U;
-        for (size_t i = 0; i < NumberOfNodes; ++i) {
-            const auto u = sofa_x[node_indices[i]] - sofa_x0[node_indices[i]];
-            for (size_t j = 0; j < Dimension; ++j) {
-                U(i, j) = u[j];
-            }
-        }
+                // Compute the nodal displacement
+                Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> U;
+                for (size_t i = 0; i < NumberOfNodes; ++i) {
+                    const auto u = sofa_x[node_indices[i]] - sofa_x0[node_indices[i]];
+                    for (size_t j = 0; j < Dimension; ++j) {
+                        U(i, j) = u[j];
+                    }
+                }
 
-        // Compute the nodal forces
-        Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> nodal_forces;
-        nodal_forces.fill(0);
+                // Compute the nodal forces
+                Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> nodal_forces;
+                nodal_forces.fill(0);
 
-        for (GaussNode &gauss_node : p_elements_quadrature_nodes[element_id]) {
+                for (GaussNode &gauss_node : p_elements_quadrature_nodes[element_id]) {
 
-            // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
-            const auto & detJ = gauss_node.jacobian_determinant;
+                    // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
+                    const auto & detJ = gauss_node.jacobian_determinant;
 
-            // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
-            const auto & dN_dx = gauss_node.dN_dx;
+                    // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
+                    const auto & dN_dx = gauss_node.dN_dx;
 
-            // Gauss quadrature node weight
-            const auto & w = gauss_node.weight;
+                    // Gauss quadrature node weight
+                    const auto & w = gauss_node.weight;
 
-            // Deformation tensor at gauss node
-            gauss_node.F = caribou::mechanics::elasticity::strain::F(dN_dx, U).transpose();
-            const auto & F = gauss_node.F;
-            const auto J = F.determinant();
+                    // Deformation tensor at gauss node
+                    gauss_node.F = caribou::mechanics::elasticity::strain::F(dN_dx, U).transpose();
+                    const auto & F = gauss_node.F;
+                    const auto J = F.determinant();
 
-            // Strain tensor at gauss node
-            const Mat33 C = F.transpose() * F;
-            const Mat33 E = 1/2. * (C - I);
+                    // Strain tensor at gauss node
+                    const Mat33 C = F.transpose() * F;
+                    const Mat33 E = 1/2. * (C - I);
 
-            // Second Piola-Kirchhoff stress tensor at gauss node
-            const Mat33 S = material->PK2_stress(J, E);
+                    // Second Piola-Kirchhoff stress tensor at gauss node
+                    const Mat33 S = m.PK2_stress(J, E);
 
-            // Elastic forces w.r.t the gauss node applied on each nodes
-            for (size_t i = 0; i < NumberOfNodes; ++i) {
-                const auto dx = dN_dx.row(i).transpose();
-                const Vector<Dimension> f_ = (detJ * w) * F*S*dx;
-                for (size_t j = 0; j < Dimension; ++j) {
-                    nodal_forces(i, j) += f_[j];
+                    // Elastic forces w.r.t the gauss node applied on each nodes
+                    for (size_t i = 0; i < NumberOfNodes; ++i) {
+                        const auto dx = dN_dx.row(i).transpose();
+                        const Vector<Dimension> f_ = (detJ * w) * F*S*dx;
+                        for (size_t j = 0; j < Dimension; ++j) {
+                            nodal_forces(i, j) += f_[j];
+                        }
+                    }
                 }
-            }
-        }
 
-        for (size_t i = 0; i < NumberOfNodes; ++i) {
-            for (size_t j = 0; j < Dimension; ++j) {
-                sofa_f[node_indices[i]][j] -= nodal_forces.row(i)[j];
+                for (size_t i = 0; i < NumberOfNodes; ++i) {
+                    for (size_t j = 0; j < Dimension; ++j) {
+                        forces(node_indices[i], j) -= nodal_forces(i, j);
+                    }
+                }
+            };
+
+            const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
+            if (nb_threads == 1 or p_elements_colors.empty()) {
+                for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+                    add_element_force(element_id);
+                }
+            } else {
+                // Elements of a same color do not share any node, and the colors are ordered such that the forces are
+                // accumulated on each node in the same order than the sequential loop.
+                for (const auto & color : p_elements_colors) {
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+                    for (std::size_t i = 0; i < color.size(); ++i) {
+                        add_element_force(color[i]);
+                    }
+                }
             }
-        }
+        });
     }
 
     sofa::helper::AdvancedTimer::stepEnd("HyperelasticForcefield::addForce");
 
-    elements_stiffness_matrices_are_up_to_date = false;
-    sparse_K_is_up_to_date = false;
-    eigenvalues_are_up_to_date = false;
+    // The tangent stiffness is kept while it is frozen (modified newton)
+    if (not p_tangent_stiffness_is_frozen) {
+        elements_stiffness_matrices_are_up_to_date = false;
+        sparse_K_is_up_to_date = false;
+        eigenvalues_are_up_to_date = false;
+    }
+}
+
+template <typename Element>
+void HyperelasticForcefield<Element>::set_tangent_stiffness_frozen(bool frozen)
+{
+    if (p_tangent_stiffness_is_frozen and not frozen) {
+        // The tangent stiffness will be rebuilt at the positions of the last addForce
+        elements_stiffness_matrices_are_up_to_date = false;
+        sparse_K_is_up_to_date = false;
+        eigenvalues_are_up_to_date = false;
+    }
+    p_tangent_stiffness_is_frozen = frozen;
 }
 
 template <typename Element>
@@ -220,27 +374,56 @@ void HyperelasticForcefield<Element>::addDForce(
     sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::addDForce");
 
     const auto nb_elements = number_of_elements();
-    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+    const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
 
-        // Fetch the node indices of the element
-        const Index * node_indices = get_element_nodes_indices(element_id);
+    if (nb_threads == 1 or p_node_elements.number_of_nodes() != sofa_df.size()) {
+        for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
 
-        // Fetch the incremental displacement
-        Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> displacements;
+            // Fetch the node indices of the element
+            const Index * node_indices = get_element_nodes_indices(element_id);
 
-        for (std::size_t i = 0; i < NumberOfNodes; ++i) {
-            displacements.row(i) = DX.row(node_indices[i]);
+            // Fetch the incremental displacement
+            Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> U;
+
+            for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                U.row(i) = DX.row(node_indices[i]);
+            }
+
+            // Compute the elemental force increment vector
+            const Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> F = element_force_increment(element_id, U) * kFactor;
+
+            // Write the elemental incremental force vector into the global force vector
+            for (size_t i = 0; i < NumberOfNodes; ++i) {
+                DF.row(node_indices[i]) -= F.row(i);
+            }
+        }
+    } else {
+        if (p_elements_force_increments.size() != nb_elements) {
+            p_elements_force_increments.resize(nb_elements);
         }
-        MapVector<NumberOfNodes*Dimension> U(displacements.data());
 
-        // Compute the elemental force increment vector
-        const auto & K = p_elements_stiffness_matrices[element_id];
-        const auto forces = (K.template selfadjointView<Eigen::Upper>()*U*kFactor).eval();
-        Map<NumberOfNodes, Dimension> F (forces.data());
+        // First, compute the elemental force increment vectors
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+        for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+            const Index * node_indices = get_element_nodes_indices(element_id);
 
-        // Write the elemental incremental force vector into the global force vector
-        for (size_t i = 0; i < NumberOfNodes; ++i) {
-            DF.row(node_indices[i]) -= F.row(i);
+            Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> U;
+            for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                U.row(i) = DX.row(node_indices[i]);
+            }
+
+            p_elements_force_increments[element_id] = element_force_increment(element_id, U) * kFactor;
+        }
+
+        // Then, gather for each node the force increments of the elements containing it. Each node is written by a
+        // single thread, and the elements of a node are visited in the same order as the sequential loop.
+        const auto & adjacency = p_node_elements;
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+        for (std::size_t node_id = 0; node_id < adjacency.number_of_nodes(); ++node_id) {
+            for (auto k = adjacency.begin(node_id); k < adjacency.end(node_id); ++k) {
+                const auto & entry = adjacency[k];
+                DF.row(node_id) -= p_elements_force_increments[entry.element_id].row(entry.local_node_id);
+            }
         }
     }
 
@@ -271,15 +454,14 @@ void HyperelasticForcefield<Element>::addKToMatrix(
 
         // Since the matrix K is block symmetric, we only kept the DxD blocks on the upper-triangle the matrix.
         // Here we need to accumulate the full matrix into Sofa's BaseMatrix.
-        const auto & K = p_elements_stiffness_matrices[element_id];
 
         // Blocks on the diagonal
         for (size_t i = 0; i < NumberOfNodes; ++i) {
-            const auto x = (i*Dimension);
+            const auto Kii = element_stiffness_block(element_id, i, i);
             sofa::defaulttype::Mat<Dimension, Dimension, Real> k;
             for (size_t m = 0; m < Dimension; ++m) {
                 for (size_t n = 0; n < Dimension; ++n) {
-                    k(m, n) = K(x+m, x+n);
+                    k(m, n) = Kii(m, n);
                 }
             }
 
@@ -291,13 +473,12 @@ void HyperelasticForcefield<Element>::addKToMatrix(
         // Blocks on the upper triangle
         for (size_t i = 0; i < NumberOfNodes; ++i) {
             for (size_t j = i+1; j < NumberOfNodes; ++j) {
-                const auto x = (i*Dimension);
-                const auto y = (j*Dimension);
+                const auto Kij = element_stiffness_block(element_id, i, j);
 
                 sofa::defaulttype::Mat<Dimension, Dimension, Real> k;
                 for (size_t m = 0; m < Dimension; ++m) {
                     for (size_t n = 0; n < Dimension; ++n) {
-                        k(m, n) = K(x+m, y+n);
+                        k(m, n) = Kij(m, n);
                     }
                 }
 
@@ -313,6 +494,47 @@ void HyperelasticForcefield<Element>::addKToMatrix(
     sofa::helper::AdvancedTimer::stepEnd("HyperelasticForcefield::addKToMatrix");
 }
 
+template <typename Element>
+void HyperelasticForcefield<Element>::add_stiffness_diagonal_blocks(const MechanicalParams * mparams, Blocks & blocks)
+{
+    if (not elements_stiffness_matrices_are_up_to_date) {
+        update_stiffness();
+    }
+
+    const auto material = d_material.get();
+    if (!material) {
+        return;
+    }
+
+    sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::add_stiffness_diagonal_blocks");
+
+    const auto kFactor = static_cast<Real> (mparams->kFactorIncludingRayleighDamping(this->rayleighStiffness.getValue()));
+    const auto nb_elements = number_of_elements();
+    const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
+
+    if (nb_threads == 1 or p_node_elements.number_of_nodes() != blocks.size()) {
+        for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+            const Index * node_indices = get_element_nodes_indices(element_id);
+            for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                blocks[node_indices[i]] -= (element_stiffness_block(element_id, i, i) * kFactor).template cast<FLOATING_POINT_TYPE>();
+            }
+        }
+    } else {
+        // Each node gathers the diagonal blocks of the elements containing it, hence it is written by a single thread
+        const auto & adjacency = p_node_elements;
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+        for (std::size_t node_id = 0; node_id < adjacency.number_of_nodes(); ++node_id) {
+            for (auto k = adjacency.begin(node_id); k < adjacency.end(node_id); ++k) {
+                const auto & entry = adjacency[k];
+                const auto Kii = element_stiffness_block(entry.element_id, entry.local_node_id, entry.local_node_id);
+                blocks[node_id] -= (Kii * kFactor).template cast<FLOATING_POINT_TYPE>();
+            }
+        }
+    }
+
+    sofa::helper::AdvancedTimer::stepEnd("HyperelasticForcefield::add_stiffness_diagonal_blocks");
+}
+
 template <typename Element>
 SReal HyperelasticForcefield<Element>::getPotentialEnergy (
     const MechanicalParams* mparams,
@@ -341,7 +563,7 @@ SReal HyperelasticForcefield<Element>::getPotentialEnergy (
     if (nb_nodes == 0 || nb_elements == 0)
         return 0;
 
-    if (p_elements_quadrature_nodes.size() != nb_elements)
+    if (not gauss_nodes_are_initialized(nb_elements))
         return 0;
 
     const Map<Eigen::Dynamic, Dimension>    X       (sofa_x.ref().data()->data(),  nb_nodes, Dimension);
@@ -351,53 +573,56 @@ SReal HyperelasticForcefield<Element>::getPotentialEnergy (
 
     sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::getPotentialEnergy");
 
-    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
-        // Fetch the node indices of the element
-        const Index * node_indices = get_element_nodes_indices(element_id);
+    dispatch_material(material, [&](const auto & m) {
+        for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+            // Fetch the node indices of the element
+            const Index * node_indices = get_element_nodes_indices(element_id);
 
-        // Fetch the initial and current positions of the element's nodes
-        Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> initial_nodes_position;
-        Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> current_nodes_position;
+            // Fetch the initial and current positions of the element's nodes
+            Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> initial_nodes_position;
+            Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> current_nodes_position;
 
-        for (std::size_t i = 0; i < NumberOfNodes; ++i) {
-            initial_nodes_position.row(i).noalias() = X0.row(node_indices[i]);
-            current_nodes_position.row(i).noalias() = X.row(node_indices[i]);
-        }
+            for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                initial_nodes_position.row(i).noalias() = X0.row(node_indices[i]);
+                current_nodes_position.row(i).noalias() = X.row(node_indices[i]);
+            }
 
-        // Compute the nodal displacement
-        Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> U;
-        for (size_t i = 0; i < NumberOfNodes; ++i) {
-            const auto u = sofa_x[node_indices[i]] - sofa_x0[node_indices[i]];
-            for (size_t j = 0; j < Dimension; ++j) {
-                U(i, j) = u[j];
+            // Compute the nodal displacement
+            Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> U;
+            for (size_t i = 0; i < NumberOfNodes; ++i) {
+                const auto u = sofa_x[node_indices[i]] - sofa_x0[node_indices[i]];
+                for (size_t j = 0; j < Dimension; ++j) {
+                    U(i, j) = u[j];
+                }
             }
-        }
 
-        // Compute the nodal forces
+            // Compute the nodal forces
 
-        for (const GaussNode & gauss_node : p_elements_quadrature_nodes[element_id]) {
+            for (std::size_t gauss_node_id = 0; gauss_node_id < NumberOfGaussNodes; ++gauss_node_id) {
+                const GaussNode gauss_node = get_gauss_node(element_id, gauss_node_id);
 
-            // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
-            const auto & detJ = gauss_node.jacobian_determinant;
+                // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
+                const auto & detJ = gauss_node.jacobian_determinant;
 
-            // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
-            const auto & dN_dx = gauss_node.dN_dx;
+                // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
+                const auto & dN_dx = gauss_node.dN_dx;
 
-            // Gauss quadrature node weight
-            const auto & w = gauss_node.weight;
+                // Gauss quadrature node weight
+                const auto & w = gauss_node.weight;
 
-            // Deformation tensor at gauss node
-            const auto & F = caribou::mechanics::elasticity::strain::F(dN_dx, U).transpose();
-            const auto J = F.determinant();
+                // Deformation tensor at gauss node
+                const auto & F = caribou::mechanics::elasticity::strain::F(dN_dx, U).transpose();
+                const auto J = F.determinant();
 
-            // Strain tensor at gauss node
-            const Mat33 C = F.transpose() * F;
-            const Mat33 E = 1/2. * (C - I);
+                // Strain tensor at gauss node
+                const Mat33 C = F.transpose() * F;
+                const Mat33 E = 1/2. * (C - I);
 
-            // Add the potential energy at gauss node
-            Psi += (detJ * w) *  material->strain_energy_density(J, E);
+                // Add the potential energy at gauss node
+                Psi += (detJ * w) *  m.strain_energy_density(J, E);
+            }
         }
-    }
+    });
 
     sofa::helper::AdvancedTimer::stepEnd("HyperelasticForcefield::getPotentialEnergy");
 
@@ -487,12 +712,193 @@ void HyperelasticForcefield<Element>::initialize_elements()
 }
 
 template <typename Element>
-void HyperelasticForcefield<Element>::update_stiffness()
+void HyperelasticForcefield<Element>::initialize_elements_batches()
+{
+    sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::initialize_elements_batches");
+
+    const auto nb_elements = p_elements_quadrature_nodes.size();
+    const auto nb_batches = (nb_elements + BatchSize - 1) / BatchSize;
+    p_elements_batches.resize(nb_batches);
+
+    for (std::size_t batch_id = 0; batch_id < nb_batches; ++batch_id) {
+        const auto first_element_id = batch_id*BatchSize;
+        for (std::size_t gauss_node_id = 0; gauss_node_id < NumberOfGaussNodes; ++gauss_node_id) {
+            GaussNodesBatch & batch = p_elements_batches[batch_id][gauss_node_id];
+            for (std::size_t l = 0; l < BatchSize; ++l) {
+                const auto element_id = first_element_id + l;
+                if (element_id < nb_elements) {
+                    const GaussNode & gauss_node = p_elements_quadrature_nodes[element_id][gauss_node_id];
+                    batch.weight[l] = gauss_node.weight;
+                    batch.jacobian_determinant[l] = gauss_node.jacobian_determinant;
+                    for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                        for (std::size_t j = 0; j < Dimension; ++j) {
+                            batch.dN_dx[i*Dimension+j][l] = gauss_node.dN_dx(i, j);
+                        }
+                    }
+                    for (std::size_t i = 0; i < Dimension; ++i) {
+                        for (std::size_t j = 0; j < Dimension; ++j) {
+                            batch.F[i*Dimension+j][l] = gauss_node.F(i, j);
+                        }
+                    }
+                } else {
+                    // Padding lane: null weight and undeformed state, its contribution is discarded
+                    batch.weight[l] = 0;
+                    batch.jacobian_determinant[l] = 0;
+                    for (std::size_t i = 0; i < NumberOfNodes*Dimension; ++i) {
+                        batch.dN_dx[i][l] = 0;
+                    }
+                    for (std::size_t i = 0; i < Dimension; ++i) {
+                        for (std::size_t j = 0; j < Dimension; ++j) {
+                            batch.F[i*Dimension+j][l] = (i == j) ? 1 : 0;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // The batches are the only storage of the gauss nodes
+    std::vector<std::array<GaussNode, NumberOfGaussNodes>>().swap(p_elements_quadrature_nodes);
+
+    sofa::helper::AdvancedTimer::stepEnd("HyperelasticForcefield::initialize_elements_batches");
+}
+
+template <typename Element>
+auto HyperelasticForcefield<Element>::get_gauss_node(const std::size_t & element_id, const std::size_t & gauss_node_id) const -> GaussNode
+{
+    if (p_elements_batches.empty()) {
+        return p_elements_quadrature_nodes[element_id][gauss_node_id];
+    }
+
+    const GaussNodesBatch & batch = p_elements_batches[element_id / BatchSize][gauss_node_id];
+    const auto l = element_id % BatchSize;
+
+    GaussNode gauss_node;
+    gauss_node.weight = batch.weight[l];
+    gauss_node.jacobian_determinant = batch.jacobian_determinant[l];
+    for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+        for (std::size_t j = 0; j < Dimension; ++j) {
+            gauss_node.dN_dx(i, j) = batch.dN_dx[i*Dimension+j][l];
+        }
+    }
+    for (std::size_t i = 0; i < Dimension; ++i) {
+        for (std::size_t j = 0; j < Dimension; ++j) {
+            gauss_node.F(i, j) = batch.F[i*Dimension+j][l];
+        }
+    }
+    return gauss_node;
+}
+
+template <typename Element>
+auto HyperelasticForcefield<Element>::gauss_nodes_are_initialized(const std::size_t & nb_elements) const -> bool
+{
+    if (d_batched_kernels.getValue()) {
+        return p_elements_batches.size() == (nb_elements + BatchSize - 1) / BatchSize;
+    }
+    return p_elements_quadrature_nodes.size() == nb_elements;
+}
+
+template <typename Element>
+template <typename Material>
+void HyperelasticForcefield<Element>::compute_batched_elements_forces(const Material & material, const VecCoord & x, const VecCoord & x0)
 {
     const auto nb_elements = number_of_elements();
-    if (p_elements_stiffness_matrices.size() != nb_elements) {
-        p_elements_stiffness_matrices.resize(nb_elements);
+    const auto nb_batches = p_elements_batches.size();
+    if (p_elements_force_increments.size() != nb_elements) {
+        p_elements_force_increments.resize(nb_elements);
+    }
+
+    const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+    for (std::size_t batch_id = 0; batch_id < nb_batches; ++batch_id) {
+        const auto first_element_id = batch_id*BatchSize;
+        const auto count = std::min<std::size_t>(BatchSize, nb_elements - first_element_id);
+
+        // Gather the nodal displacements of the elements of the batch
+        alignas(64) Real U[NumberOfNodes*Dimension][BatchSize] = {};
+        alignas(64) Real forces[NumberOfNodes*Dimension][BatchSize] = {};
+        for (std::size_t l = 0; l < count; ++l) {
+            const Index * node_indices = get_element_nodes_indices(first_element_id + l);
+            for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                const auto u = x[node_indices[i]] - x0[node_indices[i]];
+                for (std::size_t j = 0; j < Dimension; ++j) {
+                    U[i*Dimension+j][l] = u[j];
+                }
+            }
+        }
+
+        for (std::size_t gauss_node_id = 0; gauss_node_id < NumberOfGaussNodes; ++gauss_node_id) {
+            GaussNodesBatch & batch = p_elements_batches[batch_id][gauss_node_id];
+
+            // Deformation and strain tensors of the gauss node
+            alignas(64) Real J[BatchSize];
+            alignas(64) Real E[Dimension*Dimension][BatchSize];
+            kernels::deformation_gradients(NumberOfNodes, &batch.dN_dx[0][0], &U[0][0], &batch.F[0][0]);
+            kernels::green_lagrange_strains(&batch.F[0][0], J, &E[0][0]);
+
+            // Second Piola-Kirchhoff stress tensors, evaluated one element at a time by the material
+            alignas(64) Real S[Dimension*Dimension][BatchSize];
+            alignas(64) Real w[BatchSize];
+            for (std::size_t l = 0; l < BatchSize; ++l) {
+                w[l] = batch.weight[l] * batch.jacobian_determinant[l];
+                if (l >= count) {
+                    for (std::size_t i = 0; i < Dimension*Dimension; ++i) {
+                        S[i][l] = 0;
+                    }
+                    continue;
+                }
+
+                Mat33 E_l;
+                for (std::size_t i = 0; i < Dimension; ++i) {
+                    for (std::size_t j = 0; j < Dimension; ++j) {
+                        E_l(i, j) = E[i*Dimension+j][l];
+                    }
+                }
+
+                const Mat33 S_l = material.PK2_stress(J[l], E_l);
+                for (std::size_t i = 0; i < Dimension; ++i) {
+                    for (std::size_t j = 0; j < Dimension; ++j) {
+                        S[i*Dimension+j][l] = S_l(i, j);
+                    }
+                }
+            }
+
+            kernels::nodal_forces(NumberOfNodes, &batch.dN_dx[0][0], &batch.F[0][0], &S[0][0], w, &forces[0][0]);
+        }
+
+        // Scatter the nodal forces of the batch back to their elements
+        for (std::size_t l = 0; l < count; ++l) {
+            auto & nodal_forces = p_elements_force_increments[first_element_id + l];
+            for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                for (std::size_t j = 0; j < Dimension; ++j) {
+                    nodal_forces(i, j) = forces[i*Dimension+j][l];
+                }
+            }
+        }
     }
+}
+
+template <typename Element>
+void HyperelasticForcefield<Element>::update_stiffness()
+{
+    const auto nb_elements = number_of_elements();
+    const bool packed = (tangent_storage() == TangentStorage::PackedSymmetric);
+    const bool matrix_free = (tangent_storage() == TangentStorage::MatrixFree);
+    const bool single = single_precision_stiffness() and not matrix_free;
+
+    // Only allocate the selected storage, and release the memory of the other ones
+    const auto allocate_if = [nb_elements] (auto & matrices, const bool & selected) {
+        if (selected) {
+            matrices.resize(nb_elements);
+        } else {
+            std::remove_reference_t<decltype(matrices)>().swap(matrices);
+        }
+    };
+    allocate_if(p_elements_stiffness_matrices,                         not packed and not single and not matrix_free);
+    allocate_if(p_elements_packed_stiffness_matrices,                  packed and not single);
+    allocate_if(p_elements_single_precision_stiffness_matrices,        not packed and single);
+    allocate_if(p_elements_single_precision_packed_stiffness_matrices, packed and single);
+    allocate_if(p_elements_quadrature_tangents,                        matrix_free);
 
     const auto material = d_material.get();
     if (!material) {
@@ -505,67 +911,94 @@ void HyperelasticForcefield<Element>::update_stiffness()
     static const auto I = Matrix<Dimension, Dimension, Eigen::RowMajor>::Identity();
 
     sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::update_stiffness");
-    for (std::size_t element_id = 0; element_id < number_of_elements(); ++element_id) {
-        Matrix<NumberOfNodes*Dimension, NumberOfNodes*Dimension> & K = p_elements_stiffness_matrices[element_id];
-        K.fill(0);
-
-        for (GaussNode &gauss_node : p_elements_quadrature_nodes[element_id]) {
-            // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
-            const auto detJ = gauss_node.jacobian_determinant;
 
-            // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
-            const auto dN_dx = gauss_node.dN_dx;
-
-            // Gauss quadrature node weight
-            const auto w = gauss_node.weight;
-
-            // Deformation tensor at gauss node
-            const auto F = gauss_node.F;
-            const auto J = F.determinant();
+    // Every elemental stiffness matrices are independent. Elements are distributed dynamically in small chunks
+    // to balance the load between threads, since the cost of an element can vary (more gauss nodes, cache misses).
+    const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
+    dispatch_material(material, [&](const auto & m) {
+#pragma omp parallel for num_threads(nb_threads) schedule(dynamic, 64)
+        for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+            // Unless it is stored as a dense double precision matrix, the element matrix is first computed in a
+            // temporary dense matrix
+            ElementStiffnessMatrix<Real> K_dense;
+            ElementStiffnessMatrix<Real> & K = (packed or single or matrix_free) ? K_dense : p_elements_stiffness_matrices[element_id];
+            K.fill(0);
+
+            for (std::size_t gauss_node_id = 0; gauss_node_id < NumberOfGaussNodes; ++gauss_node_id) {
+                const GaussNode gauss_node = get_gauss_node(element_id, gauss_node_id);
+
+                // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
+                const auto detJ = gauss_node.jacobian_determinant;
+
+                // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
+                const auto dN_dx = gauss_node.dN_dx;
+
+                // Gauss quadrature node weight
+                const auto w = gauss_node.weight;
+
+                // Deformation tensor at gauss node
+                const auto F = gauss_node.F;
+                const auto J = F.determinant();
+
+                // Strain tensor at gauss node
+                const Mat33 C = F * F.transpose();
+                const Mat33 E = 1/2. * (C - I);
+
+                // Second Piola-Kirchhoff stress tensor at gauss node and its jacobian
+                const auto material_point = m.PK2_stress_and_jacobian(J, E, false);
+                const auto & S = material_point.S;
+                const auto & D = material_point.D;
+
+                if (matrix_free) {
+                    // Only keep the deformation gradient, the stress and its jacobian, the products K*dx will be
+                    // computed from them
+                    auto & tangent = p_elements_quadrature_tangents[element_id][gauss_node_id];
+                    tangent.F = F;
+                    tangent.S << S(0,0), S(1,1), S(2,2), S(0,1), S(1,2), S(0,2);
+                    std::size_t k = 0;
+                    for (std::size_t i = 0; i < 6; ++i) {
+                        for (std::size_t j = i; j < 6; ++j) {
+                            tangent.D[k++] = D(i, j);
+                        }
+                    }
+                    continue;
+                }
 
-            // Strain tensor at gauss node
-            const Mat33 C = F * F.transpose();
-            const Mat33 E = 1/2. * (C - I);
+                // Computation of the tangent-stiffness matrix
+                for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                    // Derivatives of the ith shape function at the gauss node with respect to global coordinates x,y and z
+                    const Vec3 dxi = dN_dx.row(i).transpose();
+                    const Matrix<6,3> Bi = strain_displacement_matrix(F, dxi);
 
-            // Second Piola-Kirchhoff stress tensor at gauss node
-            const auto S = material->PK2_stress(J, E);
+                    for (std::size_t j = i; j < NumberOfNodes; ++j) {
+                        // Derivatives of the jth shape function at the gauss node with respect to global coordinates x,y and z
+                        const Vec3 dxj = dN_dx.row(j).transpose();
+                        const Matrix<6,3> Bj = strain_displacement_matrix(F, dxj);
 
-            // Jacobian of the Second Piola-Kirchhoff stress tensor at gauss node
-            const auto D = material->PK2_stress_jacobian(J, E);
+                        K.template block<Dimension, Dimension>(i*Dimension, j*Dimension).noalias() += (dxi.dot(S*dxj)*I + Bi.transpose()*D*Bj) * detJ * w;
+                    }
+                }
+            }
 
-            // Computation of the tangent-stiffness matrix
-            for (std::size_t i = 0; i < NumberOfNodes; ++i) {
-                // Derivatives of the ith shape function at the gauss node with respect to global coordinates x,y and z
-                const Vec3 dxi = dN_dx.row(i).transpose();
-
-                Matrix<6,3> Bi;
-                Bi <<
-                        F(0,0)*dxi[0],                 F(1,0)*dxi[0],                 F(2,0)*dxi[0],
-                        F(0,1)*dxi[1],                 F(1,1)*dxi[1],                 F(2,1)*dxi[1],
-                        F(0,2)*dxi[2],                 F(1,2)*dxi[2],                 F(2,2)*dxi[2],
-                F(0,0)*dxi[1] + F(0,1)*dxi[0], F(1,0)*dxi[1] + F(1,1)*dxi[0], F(2,0)*dxi[1] + F(2,1)*dxi[0],
-                F(0,1)*dxi[2] + F(0,2)*dxi[1], F(1,1)*dxi[2] + F(1,2)*dxi[1], F(2,1)*dxi[2] + F(2,2)*dxi[1],
-                F(0,0)*dxi[2] + F(0,2)*dxi[0], F(0,1)*dxi[2] + F(1,2)*dxi[0], F(2,0)*dxi[2] + F(2,2)*dxi[0];
-
-                for (std::size_t j = i; j < NumberOfNodes; ++j) {
-                    // Derivatives of the jth shape function at the gauss node with respect to global coordinates x,y and z
-                    const Vec3 dxj = dN_dx.row(j).transpose();
-
-                    Matrix<6,3> Bj;
-                    Bj <<
-                                F(0,0)*dxj[0],                 F(1,0)*dxj[0],                 F(2,0)*dxj[0],
-                                F(0,1)*dxj[1],                 F(1,1)*dxj[1],                 F(2,1)*dxj[1],
-                                F(0,2)*dxj[2],                 F(1,2)*dxj[2],                 F(2,2)*dxj[2],
-                        F(0,0)*dxj[1] + F(0,1)*dxj[0], F(1,0)*dxj[1] + F(1,1)*dxj[0], F(2,0)*dxj[1] + F(2,1)*dxj[0],
-                        F(0,1)*dxj[2] + F(0,2)*dxj[1], F(1,1)*dxj[2] + F(1,2)*dxj[1], F(2,1)*dxj[2] + F(2,2)*dxj[1],
-                        F(0,0)*dxj[2] + F(0,2)*dxj[0], F(0,1)*dxj[2] + F(1,2)*dxj[0], F(2,0)*dxj[2] + F(2,2)*dxj[0];
-                    
-
-                    K.template block<Dimension, Dimension>(i*Dimension, j*Dimension).noalias() += (dxi.dot(S*dxj)*I + Bi.transpose()*D*Bj) * detJ * w;
+            if (packed and single) {
+                auto & P = p_elements_single_precision_packed_stiffness_matrices[element_id];
+                for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                    for (std::size_t j = i; j < NumberOfNodes; ++j) {
+                        P[packed_block_index(i, j)] = K.template block<Dimension, Dimension>(i*Dimension, j*Dimension).template cast<float>();
+                    }
+                }
+            } else if (packed) {
+                auto & P = p_elements_packed_stiffness_matrices[element_id];
+                for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+                    for (std::size_t j = i; j < NumberOfNodes; ++j) {
+                        P[packed_block_index(i, j)] = K.template block<Dimension, Dimension>(i*Dimension, j*Dimension);
+                    }
                 }
+            } else if (single) {
+                p_elements_single_precision_stiffness_matrices[element_id] = K.template cast<float>();
             }
         }
-    }
+    });
     sofa::helper::AdvancedTimer::stepEnd("HyperelasticForcefield::update_stiffness");
 
     elements_stiffness_matrices_are_up_to_date = true;
@@ -573,6 +1006,224 @@ void HyperelasticForcefield<Element>::update_stiffness()
     eigenvalues_are_up_to_date = false;
 }
 
+template <typename Element>
+auto HyperelasticForcefield<Element>::element_stiffness_block(const std::size_t & element_id, const std::size_t & i, const std::size_t & j) const -> Matrix<Dimension, Dimension, Eigen::RowMajor>
+{
+    if (tangent_storage() == TangentStorage::MatrixFree) {
+        static const auto I = Matrix<Dimension, Dimension, Eigen::RowMajor>::Identity();
+        Matrix<Dimension, Dimension, Eigen::RowMajor> Kij = Matrix<Dimension, Dimension, Eigen::RowMajor>::Zero();
+        for (std::size_t gauss_node_id = 0; gauss_node_id < NumberOfGaussNodes; ++gauss_node_id) {
+            const GaussNode gauss_node = get_gauss_node(element_id, gauss_node_id);
+            const GaussNodeTangent & tangent = p_elements_quadrature_tangents[element_id][gauss_node_id];
+            Mat33 S;
+            Matrix<6, 6> D;
+            unpack_gauss_node_tangent(tangent, S, D);
+
+            const Vec3 dxi = gauss_node.dN_dx.row(i).transpose();
+            const Vec3 dxj = gauss_node.dN_dx.row(j).transpose();
+            const Matrix<6,3> Bi = strain_displacement_matrix(tangent.F, dxi);
+            const Matrix<6,3> Bj = strain_displacement_matrix(tangent.F, dxj);
+            Kij.noalias() += (dxi.dot(S*dxj)*I + Bi.transpose()*D*Bj) * gauss_node.jacobian_determinant * gauss_node.weight;
+        }
+        return Kij;
+    }
+
+    const bool packed = (tangent_storage() == TangentStorage::PackedSymmetric);
+    if (single_precision_stiffness()) {
+        if (packed) {
+            return p_elements_single_precision_packed_stiffness_matrices[element_id][packed_block_index(i, j)].template cast<Real>();
+        }
+        return p_elements_single_precision_stiffness_matrices[element_id].template block<Dimension, Dimension>(i*Dimension, j*Dimension).template cast<Real>();
+    }
+
+    if (packed) {
+        return p_elements_packed_stiffness_matrices[element_id][packed_block_index(i, j)];
+    }
+
+    return p_elements_stiffness_matrices[element_id].template block<Dimension, Dimension>(i*Dimension, j*Dimension);
+}
+
+template <typename Element>
+auto HyperelasticForcefield<Element>::element_force_increment(const std::size_t & element_id, const Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> & U) const -> Matrix<NumberOfNodes, Dimension, Eigen::RowMajor>
+{
+    if (tangent_storage() == TangentStorage::MatrixFree) {
+        return element_matrix_free_force_increment(element_id, U);
+    }
+
+    const bool packed = (tangent_storage() == TangentStorage::PackedSymmetric);
+
+    // Single precision blocks are promoted to Real one at a time, the products being accumulated in Real
+    if (single_precision_stiffness()) {
+        if (packed) {
+            const auto & P = p_elements_single_precision_packed_stiffness_matrices[element_id];
+            return symmetric_blocks_product([&P] (const std::size_t & i, const std::size_t & j) {
+                return P[packed_block_index(i, j)].template cast<Real>();
+            }, U);
+        }
+
+        const auto & K = p_elements_single_precision_stiffness_matrices[element_id];
+        return symmetric_blocks_product([&K] (const std::size_t & i, const std::size_t & j) {
+            return K.template block<Dimension, Dimension>(i*Dimension, j*Dimension).template cast<Real>();
+        }, U);
+    }
+
+    if (packed) {
+        const auto & P = p_elements_packed_stiffness_matrices[element_id];
+        return symmetric_blocks_product([&P] (const std::size_t & i, const std::size_t & j) -> const auto & {
+            return P[packed_block_index(i, j)];
+        }, U);
+    }
+
+    const auto & K = p_elements_stiffness_matrices[element_id];
+    MapVector<NumberOfNodes*Dimension> u (U.data());
+    const Vector<NumberOfNodes*Dimension> f = K.template selfadjointView<Eigen::Upper>()*u;
+    return Map<NumberOfNodes, Dimension>(f.data());
+}
+
+template <typename Element>
+auto HyperelasticForcefield<Element>::element_matrix_free_force_increment(const std::size_t & element_id, const Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> & U) const -> Matrix<NumberOfNodes, Dimension, Eigen::RowMajor>
+{
+    // At a gauss node, the block Kij of the tangent stiffness matrix is (dxi . S dxj) I + Bi^T D Bj. Hence, summing
+    // over the nodes j, the force increment of the node i is H S dxi + Bi^T D e where H = sum_j uj dxj^T is the
+    // gradient of the displacement increment and e = sum_j Bj uj is the Green-Lagrange strain increment.
+    Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> F = Matrix<NumberOfNodes, Dimension, Eigen::RowMajor>::Zero();
+
+    for (std::size_t gauss_node_id = 0; gauss_node_id < NumberOfGaussNodes; ++gauss_node_id) {
+        const GaussNode gauss_node = get_gauss_node(element_id, gauss_node_id);
+        const auto & dN_dx = gauss_node.dN_dx;
+        const auto w = gauss_node.weight * gauss_node.jacobian_determinant;
+
+        const GaussNodeTangent & tangent = p_elements_quadrature_tangents[element_id][gauss_node_id];
+        Mat33 S;
+        Matrix<6, 6> D;
+        unpack_gauss_node_tangent(tangent, S, D);
+
+        // Strain-displacement matrices of the element nodes, at the deformation gradient of the stored stress
+        std::array<Matrix<6,3>, NumberOfNodes> B;
+        Vector<6> e = Vector<6>::Zero();
+        for (std::size_t j = 0; j < NumberOfNodes; ++j) {
+            B[j] = strain_displacement_matrix(tangent.F, dN_dx.row(j).transpose());
+            e.noalias() += B[j] * U.row(j).transpose();
+        }
+
+        const Vector<6> s = D*e;
+        const Mat33 HS = U.transpose() * dN_dx * S;
+
+        for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+            F.row(i).noalias() += w * (HS*dN_dx.row(i).transpose() + B[i].transpose()*s).transpose();
+        }
+    }
+
+    return F;
+}
+
+template <typename Element>
+auto HyperelasticForcefield<Element>::strain_displacement_matrix(const Mat33 & F, const Vec3 & dx) -> Matrix<6, 3>
+{
+    Matrix<6,3> B;
+    B <<
+                    F(0,0)*dx[0],                 F(1,0)*dx[0],                 F(2,0)*dx[0],
+                    F(0,1)*dx[1],                 F(1,1)*dx[1],                 F(2,1)*dx[1],
+                    F(0,2)*dx[2],                 F(1,2)*dx[2],                 F(2,2)*dx[2],
+            F(0,0)*dx[1] + F(0,1)*dx[0], F(1,0)*dx[1] + F(1,1)*dx[0], F(2,0)*dx[1] + F(2,1)*dx[0],
+            F(0,1)*dx[2] + F(0,2)*dx[1], F(1,1)*dx[2] + F(1,2)*dx[1], F(2,1)*dx[2] + F(2,2)*dx[1],
+            F(0,0)*dx[2] + F(0,2)*dx[0], F(0,1)*dx[2] + F(1,2)*dx[0], F(2,0)*dx[2] + F(2,2)*dx[0];
+
+    return B;
+}
+
+template <typename Element>
+void HyperelasticForcefield<Element>::unpack_gauss_node_tangent(const GaussNodeTangent & tangent, Mat33 & S, Matrix<6, 6> & D)
+{
+    S <<
+        tangent.S[0], tangent.S[3], tangent.S[5],
+        tangent.S[3], tangent.S[1], tangent.S[4],
+        tangent.S[5], tangent.S[4], tangent.S[2];
+
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < 6; ++i) {
+        for (std::size_t j = i; j < 6; ++j) {
+            D(i, j) = D(j, i) = tangent.D[k++];
+        }
+    }
+}
+
+template <typename Element>
+auto HyperelasticForcefield<Element>::tangent_storage_size() const -> std::size_t
+{
+    return p_elements_stiffness_matrices.capacity() * sizeof(ElementStiffnessMatrix<Real>)
+         + p_elements_packed_stiffness_matrices.capacity() * sizeof(PackedStiffnessMatrix<Real>)
+         + p_elements_single_precision_stiffness_matrices.capacity() * sizeof(ElementStiffnessMatrix<float>)
+         + p_elements_single_precision_packed_stiffness_matrices.capacity() * sizeof(PackedStiffnessMatrix<float>)
+         + p_elements_quadrature_tangents.capacity() * sizeof(std::array<GaussNodeTangent, NumberOfGaussNodes>);
+}
+
+template <typename Element>
+template <typename BlockGetter>
+auto HyperelasticForcefield<Element>::symmetric_blocks_product(const BlockGetter & block, const Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> & U) -> Matrix<NumberOfNodes, Dimension, Eigen::RowMajor>
+{
+    Matrix<NumberOfNodes, Dimension, Eigen::RowMajor> F;
+    F.fill(0);
+    for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+        F.row(i).noalias() += U.row(i) * block(i, i).transpose();
+        for (std::size_t j = i+1; j < NumberOfNodes; ++j) {
+            const auto & Kij = block(i, j);
+            F.row(i).noalias() += U.row(j) * Kij.transpose();
+            F.row(j).noalias() += U.row(i) * Kij;
+        }
+    }
+
+    return F;
+}
+
+template <typename Element>
+void HyperelasticForcefield<Element>::color_elements()
+{
+    const auto nb_elements = number_of_elements();
+
+    sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::color_elements");
+    p_elements_colors = caribou::topology::color_elements(nb_elements, NumberOfNodes, [this] (const std::size_t & element_id) {
+        return get_element_nodes_indices(element_id);
+    });
+    sofa::helper::AdvancedTimer::stepEnd("HyperelasticForcefield::color_elements");
+
+    msg_info() << "Elements were partitioned into " << p_elements_colors.size() << " colors.";
+}
+
+template <typename Element>
+void HyperelasticForcefield<Element>::initialize_node_elements_adjacency()
+{
+    if (!this->mstate)
+        return;
+
+    const auto nb_nodes = this->mstate->getSize();
+    const auto nb_elements = number_of_elements();
+
+    p_node_elements = caribou::topology::NodeElementAdjacency(nb_nodes, nb_elements, NumberOfNodes, [this] (const std::size_t & element_id) {
+        return get_element_nodes_indices(element_id);
+    });
+}
+
+template <typename Element>
+template <typename Function>
+void HyperelasticForcefield<Element>::dispatch_material(const material::HyperelasticMaterial<DataTypes> * material, Function && f)
+{
+    if constexpr (Dimension == 3) {
+        // Only the exact types are dispatched: a subclass of these materials may override their methods
+        if (typeid(*material) == typeid(material::NeoHookeanMaterial<DataTypes>)) {
+            f(internal::ExactMaterial<material::NeoHookeanMaterial<DataTypes>, DataTypes> {static_cast<const material::NeoHookeanMaterial<DataTypes> &>(*material)});
+            return;
+        }
+
+        if (typeid(*material) == typeid(material::SaintVenantKirchhoffMaterial<DataTypes>)) {
+            f(internal::ExactMaterial<material::SaintVenantKirchhoffMaterial<DataTypes>, DataTypes> {static_cast<const material::SaintVenantKirchhoffMaterial<DataTypes> &>(*material)});
+            return;
+        }
+    }
+
+    f(*material);
+}
+
 static const unsigned long long kelly_colors_hex[] =
 {
     0xFFFFB300, // Vivid Yellow
@@ -0,0 +1,147 @@
+#include "HyperelasticKernels.h"
+
+// Each kernel is cloned for every instruction sets below, the right clone being resolved by the dynamic loader
+#ifdef CARIBOU_WITH_RUNTIME_DISPATCH
+#define CARIBOU_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define CARIBOU_TARGET_CLONES
+#endif
+
+// The implementations are forced inline inside each clone so that they are compiled for the clone's instruction set
+#if defined(__GNUC__)
+#define CARIBOU_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define CARIBOU_ALWAYS_INLINE inline
+#endif
+
+namespace SofaCaribou::GraphComponents::forcefield::kernels {
+
+namespace {
+
+template <typename Real>
+CARIBOU_ALWAYS_INLINE
+void deformation_gradients_impl(std::size_t nb_nodes, const Real * dN_dx, const Real * U, Real * F)
+{
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            Real * f = F + (i*3+j)*BatchSize;
+            for (std::size_t l = 0; l < BatchSize; ++l) {
+                f[l] = (i == j) ? 1 : 0;
+            }
+
+            for (std::size_t n = 0; n < nb_nodes; ++n) {
+                const Real * u = U     + (n*3+i)*BatchSize;
+                const Real * d = dN_dx + (n*3+j)*BatchSize;
+                for (std::size_t l = 0; l < BatchSize; ++l) {
+                    f[l] += u[l] * d[l];
+                }
+            }
+        }
+    }
+}
+
+template <typename Real>
+CARIBOU_ALWAYS_INLINE
+void green_lagrange_strains_impl(const Real * F, Real * J, Real * E)
+{
+    const auto f = [F] (std::size_t i, std::size_t j, std::size_t l) -> const Real & {
+        return F[(i*3+j)*BatchSize + l];
+    };
+
+    for (std::size_t l = 0; l < BatchSize; ++l) {
+        J[l] = f(0,0,l) * (f(1,1,l)*f(2,2,l) - f(1,2,l)*f(2,1,l))
+             - f(0,1,l) * (f(1,0,l)*f(2,2,l) - f(1,2,l)*f(2,0,l))
+             + f(0,2,l) * (f(1,0,l)*f(2,1,l) - f(1,1,l)*f(2,0,l));
+    }
+
+    // E is symmetric, only compute its upper triangle
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = i; j < 3; ++j) {
+            Real * e = E + (i*3+j)*BatchSize;
+            for (std::size_t l = 0; l < BatchSize; ++l) {
+                const Real c = f(0,i,l)*f(0,j,l) + f(1,i,l)*f(1,j,l) + f(2,i,l)*f(2,j,l);
+                e[l] = Real(0.5) * (c - ((i == j) ? 1 : 0));
+            }
+            if (i != j) {
+                Real * et = E + (j*3+i)*BatchSize;
+                for (std::size_t l = 0; l < BatchSize; ++l) {
+                    et[l] = e[l];
+                }
+            }
+        }
+    }
+}
+
+template <typename Real>
+CARIBOU_ALWAYS_INLINE
+void nodal_forces_impl(std::size_t nb_nodes, const Real * dN_dx, const Real * F, const Real * S, const Real * w, Real * forces)
+{
+    // First Piola-Kirchhoff stress tensor P = F S, weighted by the integration weight
+    Real P[9*BatchSize];
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            Real * p = P + (i*3+j)*BatchSize;
+            for (std::size_t l = 0; l < BatchSize; ++l) {
+                p[l] = (F[(i*3+0)*BatchSize+l]*S[(0*3+j)*BatchSize+l]
+                     +  F[(i*3+1)*BatchSize+l]*S[(1*3+j)*BatchSize+l]
+                     +  F[(i*3+2)*BatchSize+l]*S[(2*3+j)*BatchSize+l]) * w[l];
+            }
+        }
+    }
+
+    for (std::size_t n = 0; n < nb_nodes; ++n) {
+        const Real * d = dN_dx + n*3*BatchSize;
+        for (std::size_t i = 0; i < 3; ++i) {
+            Real * f = forces + (n*3+i)*BatchSize;
+            const Real * p = P + i*3*BatchSize;
+            for (std::size_t l = 0; l < BatchSize; ++l) {
+                f[l] += p[l]*d[l] + p[BatchSize+l]*d[BatchSize+l] + p[2*BatchSize+l]*d[2*BatchSize+l];
+            }
+        }
+    }
+}
+
+} // namespace
+
+CARIBOU_TARGET_CLONES
+void deformation_gradients(std::size_t nb_nodes, const double * dN_dx, const double * U, double * F) {
+    deformation_gradients_impl(nb_nodes, dN_dx, U, F);
+}
+
+CARIBOU_TARGET_CLONES
+void deformation_gradients(std::size_t nb_nodes, const float * dN_dx, const float * U, float * F) {
+    deformation_gradients_impl(nb_nodes, dN_dx, U, F);
+}
+
+CARIBOU_TARGET_CLONES
+void green_lagrange_strains(const double * F, double * J, double * E) {
+    green_lagrange_strains_impl(F, J, E);
+}
+
+CARIBOU_TARGET_CLONES
+void green_lagrange_strains(const float * F, float * J, float * E) {
+    green_lagrange_strains_impl(F, J, E);
+}
+
+CARIBOU_TARGET_CLONES
+void nodal_forces(std::size_t nb_nodes, const double * dN_dx, const double * F, const double * S, const double * w, double * forces) {
+    nodal_forces_impl(nb_nodes, dN_dx, F, S, w, forces);
+}
+
+CARIBOU_TARGET_CLONES
+void nodal_forces(std::size_t nb_nodes, const float * dN_dx, const float * F, const float * S, const float * w, float * forces) {
+    nodal_forces_impl(nb_nodes, dN_dx, F, S, w, forces);
+}
+
+auto instruction_set() -> const char * {
+#ifdef CARIBOU_WITH_RUNTIME_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return "avx512f";
+    if (__builtin_cpu_supports("avx2"))
+        return "avx2";
+#endif
+    return "default";
+}
+
+} // namespace SofaCaribou::GraphComponents::forcefield::kernels
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Element kernels of the HyperelasticForcefield working on batches of elements.
+ *
+ * The data of a batch is stored as a structure of arrays: every scalar quantity of an element (a component of its
+ * deformation gradient, the derivative of one of its shape function, etc.) is stored in an array of BatchSize
+ * values, one per element (lane) of the batch. The loops over the lanes are hence contiguous and are vectorized by
+ * the compiler, one AVX-512 register (or two AVX2 registers) holding the same quantity of 8 elements.
+ *
+ * When Caribou is compiled with CARIBOU_WITH_RUNTIME_DISPATCH, every kernel is compiled for several instruction
+ * sets (AVX-512, AVX2 and the default one of the build) and the best one supported by the CPU is selected when the
+ * library is loaded. The same binary can therefore be used on AVX2 and AVX-512 hosts.
+ *
+ * All the kernels are for 3D elements, the tensors being stored row by row (F[i*3+j] is the component (i, j)).
+ */
+namespace SofaCaribou::GraphComponents::forcefield::kernels {
+
+/// Number of elements in a batch
+static constexpr std::size_t BatchSize = 8;
+
+/**
+ * Compute the deformation gradient F = I + sum_n u_n dN_n^T of each element of the batch.
+ *
+ * @param nb_nodes Number of nodes per element.
+ * @param dN_dx    [nb_nodes*3][BatchSize] Derivatives of the shape functions, dN_dx[n*3+j] being the derivative of
+ *                 the shape function of the node n w.r.t the world coordinate j.
+ * @param U        [nb_nodes*3][BatchSize] Displacements of the nodes, U[n*3+i] being the component i of the
+ *                 displacement of the node n.
+ * @param F        [9][BatchSize] Output deformation gradients.
+ */
+void deformation_gradients(std::size_t nb_nodes, const double * dN_dx, const double * U, double * F);
+void deformation_gradients(std::size_t nb_nodes, const float  * dN_dx, const float  * U, float  * F);
+
+/**
+ * Compute the determinant J and the Green-Lagrange strain tensor E = 1/2 (F^T F - I) of each element of the batch.
+ *
+ * @param F [9][BatchSize] Deformation gradients.
+ * @param J [BatchSize]    Output determinants of F.
+ * @param E [9][BatchSize] Output strain tensors.
+ */
+void green_lagrange_strains(const double * F, double * J, double * E);
+void green_lagrange_strains(const float  * F, float  * J, float  * E);
+
+/**
+ * Accumulate the nodal forces w * F S dN_n of each element of the batch.
+ *
+ * @param nb_nodes Number of nodes per element.
+ * @param dN_dx    [nb_nodes*3][BatchSize] Derivatives of the shape functions.
+ * @param F        [9][BatchSize] Deformation gradients.
+ * @param S        [9][BatchSize] Second Piola-Kirchhoff stress tensors.
+ * @param w        [BatchSize] Integration weights (gauss weight times the jacobian determinant).
+ * @param forces   [nb_nodes*3][BatchSize] Nodal forces, forces[n*3+i] being the component i of the force of node n.
+ */
+void nodal_forces(std::size_t nb_nodes, const double * dN_dx, const double * F, const double * S, const double * w, double * forces);
+void nodal_forces(std::size_t nb_nodes, const float  * dN_dx, const float  * F, const float  * S, const float  * w, float  * forces);
+
+/** Name of the instruction set of the kernels selected for the current CPU ("avx512f", "avx2" or "default") */
+auto instruction_set() -> const char *;
+
+} // namespace SofaCaribou::GraphComponents::forcefield::kernels
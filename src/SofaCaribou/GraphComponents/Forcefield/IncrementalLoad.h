@@ -0,0 +1,33 @@
+#pragma once
+
+namespace SofaCaribou::GraphComponents::forcefield {
+
+/**
+ * Interface of the forcefields applying their total load through a sequence of load increments (ex. TractionForce
+ * with a slope). The load is given as a fraction of the total load (the load factor).
+ *
+ * This is used by the adaptive load stepping of the StaticODESolver (see its adaptive_load_stepping option), which
+ * grows the load increments when newton converges in a few iterations, and cuts back the increment of a time step
+ * (going back to the load of the last equilibrium) when newton diverges.
+ */
+class IncrementalLoad {
+public:
+    virtual ~IncrementalLoad() = default;
+
+    /** Fraction of the total load currently applied, in [0, 1]. */
+    virtual auto load_factor() const -> double = 0;
+
+    /** Fraction of the total load applied at the beginning of the current time step, i.e. before its increment. */
+    virtual auto previous_load_factor() const -> double = 0;
+
+    /** Apply the given fraction of the total load now. The load of the beginning of the time step is kept. */
+    virtual void set_load_factor(const double & factor) = 0;
+
+    /** Fraction of the total load added by the next increments (0 when the total load is applied at once). */
+    virtual auto load_increment() const -> double = 0;
+
+    /** Set the fraction of the total load added by the next increments. */
+    virtual void set_load_increment(const double & increment) = 0;
+};
+
+} // namespace SofaCaribou::GraphComponents::forcefield
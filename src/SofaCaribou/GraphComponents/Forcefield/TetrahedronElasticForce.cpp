@@ -7,6 +7,7 @@
 #include <Caribou/Mechanics/Elasticity/Strain.h>
 
 #include "TetrahedronElasticForce.h"
+#include <SofaCaribou/GraphComponents/Forcefield/ElementThreads.h>
 
 namespace SofaCaribou::GraphComponents::forcefield {
 using namespace caribou::mechanics;
@@ -29,6 +30,10 @@ TetrahedronElasticForce<CanonicalTetrahedron>::TetrahedronElasticForce()
     bool(true), "corotated",
     "Whether or not to use corotated elements for the strain computation.",
     true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_number_of_threads(initData(&d_number_of_threads,
+    int(1), "number_of_threads",
+    number_of_threads_description,
+    true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
 , d_topology_container(initLink(
     "topology_container", "Topology that contains the elements on which this force will be computed."))
 {
@@ -139,6 +144,11 @@ void TetrahedronElasticForce<CanonicalTetrahedron>::reinit()
     // Initialize the stiffness matrix of every tetrahedrons
     p_stiffness_matrices.resize(topology->getNbTetrahedra());
 
+    // Compute the list of tetrahedrons containing each nodes (used to gather the force increments in parallel)
+    p_node_elements = caribou::topology::NodeElementAdjacency(X.size(), topology->getNbTetrahedra(), NumberOfNodes, [topology] (const std::size_t & element_id) {
+        return topology->getTetrahedron(element_id);
+    });
+
     // Compute the initial tangent stiffness matrix
     compute_K();
 }
@@ -315,8 +325,10 @@ void TetrahedronElasticForce<CanonicalTetrahedron>::addDForce(
 
     sofa::helper::AdvancedTimer::stepBegin("TetrahedronElasticForce::addDForce");
     const auto number_of_elements = topology->getNbTetrahedra();
-    for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+    const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
 
+    // Compute the rotated force increment vector of a tetrahedron
+    const auto element_force_increment = [&](const std::size_t & element_id) -> Vector<NumberOfNodes*3> {
         const Mat33 & R  = current_rotation[element_id];
         const Mat33 & Rt = R.transpose();
 
@@ -336,17 +348,47 @@ void TetrahedronElasticForce<CanonicalTetrahedron>::addDForce(
         const auto & K = p_stiffness_matrices[element_id];
         Vector<NumberOfNodes*3> F = K*U*kFactor;
 
-        // Write the forces into the output vector
-        i = 0;
-        for (const auto & node_id : topology->getTetrahedron(element_id)) {
-            Vec3 force {F[i*3+0], F[i*3+1], F[i*3+2]};
-            force = R*force;
+        for (i = 0; i < NumberOfNodes; ++i) {
+            F.template segment<3>(i*3) = (R*F.template segment<3>(i*3)).eval();
+        }
+
+        return F;
+    };
+
+    if (nb_threads == 1 or p_node_elements.number_of_nodes() != df.size()) {
+        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            const Vector<NumberOfNodes*3> F = element_force_increment(element_id);
 
-            df[node_id][0] -= force[0];
-            df[node_id][1] -= force[1];
-            df[node_id][2] -= force[2];
+            // Write the forces into the output vector
+            size_t i = 0;
+            for (const auto & node_id : topology->getTetrahedron(element_id)) {
+                df[node_id][0] -= F[i*3+0];
+                df[node_id][1] -= F[i*3+1];
+                df[node_id][2] -= F[i*3+2];
 
-            ++i;
+                ++i;
+            }
+        }
+    } else {
+        p_elements_force_increments.resize(number_of_elements);
+
+        // First, compute the force increment vector of every tetrahedrons
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            p_elements_force_increments[element_id] = element_force_increment(element_id);
+        }
+
+        // Then, gather for each node the force increments of the tetrahedrons containing it
+        const auto & adjacency = p_node_elements;
+#pragma omp parallel for num_threads(nb_threads) schedule(static)
+        for (std::size_t node_id = 0; node_id < adjacency.number_of_nodes(); ++node_id) {
+            for (auto k = adjacency.begin(node_id); k < adjacency.end(node_id); ++k) {
+                const auto & F = p_elements_force_increments[adjacency[k].element_id];
+                const auto i = adjacency[k].local_node_id;
+                df[node_id][0] -= F[i*3+0];
+                df[node_id][1] -= F[i*3+1];
+                df[node_id][2] -= F[i*3+2];
+            }
         }
     }
     sofa::helper::AdvancedTimer::stepEnd("TetrahedronElasticForce::addDForce");
@@ -404,6 +446,39 @@ void TetrahedronElasticForce<CanonicalTetrahedron>::addKToMatrix(
     sofa::helper::AdvancedTimer::stepEnd("TetrahedronElasticForce::addKToMatrix");
 }
 
+template<typename CanonicalTetrahedron>
+void TetrahedronElasticForce<CanonicalTetrahedron>::add_stiffness_diagonal_blocks(const MechanicalParams * mparams, Blocks & blocks)
+{
+    auto * topology = d_topology_container.get();
+
+    if (!topology)
+        return;
+
+    if (recompute_compute_tangent_stiffness)
+        compute_K();
+
+    if (p_stiffness_matrices.size() != topology->getNbTetrahedra())
+        return;
+
+    const auto kFactor = static_cast<Real>(mparams->kFactorIncludingRayleighDamping(this->rayleighStiffness.getValue()));
+
+    sofa::helper::AdvancedTimer::stepBegin("TetrahedronElasticForce::add_stiffness_diagonal_blocks");
+
+    const auto number_of_elements = topology->getNbTetrahedra();
+    for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+        const auto & node_indices = topology->getTetrahedron(element_id);
+        const Mat33 & R  = p_current_rotation[element_id];
+        const auto & K = p_stiffness_matrices[element_id];
+
+        for (std::size_t i = 0; i < NumberOfNodes; ++i) {
+            const Mat33 k = -kFactor * R*K.template block<3, 3>(3*i, 3*i)*R.transpose();
+            blocks[node_indices[i]] += k.template cast<FLOATING_POINT_TYPE>();
+        }
+    }
+
+    sofa::helper::AdvancedTimer::stepEnd("TetrahedronElasticForce::add_stiffness_diagonal_blocks");
+}
+
 template<typename CanonicalTetrahedron>
 void TetrahedronElasticForce<CanonicalTetrahedron>::computeBBox(const sofa::core::ExecParams* params, bool onlyVisible)
 {
@@ -518,6 +593,8 @@ void TetrahedronElasticForce<CanonicalTetrahedron>::compute_K()
     sofa::helper::AdvancedTimer::stepBegin("TetrahedronElasticForce::compute_k");
 
     const auto number_of_elements = topology->getNbTetrahedra();
+    const auto nb_threads = number_of_threads(d_number_of_threads.getValue());
+#pragma omp parallel for num_threads(nb_threads) schedule(dynamic, 64)
     for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
         auto & K = p_stiffness_matrices[element_id];
         K.fill(0.);
@@ -7,6 +7,8 @@
 #include <sofa/core/behavior/ForceField.h>
 
 #include <Caribou/Geometry/Tetrahedron.h>
+#include <Caribou/Topology/NodeElementAdjacency.h>
+#include <SofaCaribou/GraphComponents/Forcefield/BlockDiagonalStiffness.h>
 
 namespace SofaCaribou::GraphComponents::forcefield {
 
@@ -17,7 +19,7 @@ using namespace sofa::core::topology;
 using sofa::defaulttype::Vec3Types;
 
 template<typename CanonicalTetrahedronType>
-class TetrahedronElasticForce : public ForceField<Vec3Types> {
+class TetrahedronElasticForce : public ForceField<Vec3Types>, public BlockDiagonalStiffness<3> {
 public:
     SOFA_CLASS(SOFA_TEMPLATE(TetrahedronElasticForce, CanonicalTetrahedronType), SOFA_TEMPLATE(ForceField, Vec3Types));
 
@@ -30,6 +32,7 @@ public:
     using Coord    = typename DataTypes::Coord;
     using Deriv    = typename DataTypes::Deriv;
     using Real     = typename Coord::value_type;
+    using Blocks   = BlockDiagonalStiffness<3>::Blocks;
 
 
     template<int nRows, int nColumns, int Options=Eigen::RowMajor>
@@ -87,6 +90,9 @@ public:
             SReal /*kFact*/,
             unsigned int & /*offset*/) override;
 
+    /** Add the diagonal node blocks of kFactor * df/dx to blocks (see BlockDiagonalStiffness) */
+    void add_stiffness_diagonal_blocks(const MechanicalParams * mparams, Blocks & blocks) override;
+
     SReal getPotentialEnergy(
             const MechanicalParams* /* mparams */,
             const Data<VecCoord>& /* d_x */) const override
@@ -119,6 +125,7 @@ private:
     Data< Real > d_poissonRatio;
     Data< bool > d_linear_strain;
     Data< bool > d_corotated;
+    Data< int > d_number_of_threads;
     Link<BaseMeshTopology>   d_topology_container;
 
 private:
@@ -127,6 +134,8 @@ private:
     std::vector<std::vector<GaussNode>> p_quadrature_nodes;
     std::vector<Mat33> p_initial_rotation;
     std::vector<Mat33> p_current_rotation;
+    caribou::topology::NodeElementAdjacency p_node_elements;
+    std::vector<Vector<NumberOfNodes*3>> p_elements_force_increments;
     Eigen::SparseMatrix<Real> p_K;
     Vector<Eigen::Dynamic> p_eigenvalues;
     bool K_is_up_to_date;
@@ -96,14 +96,19 @@ void TractionForce<DataTypes>::init()
     if (d_slope.getValue() > -EPSILON && d_slope.getValue() < EPSILON)
         m_traction_is_constant = true;
 
+    m_load_increment = d_slope.getValue();
+
     nodal_forces.resize(rest_positions.size());
 
     // Do an increment on the first step of the simulation
     m_number_of_steps_since_last_increment = d_number_of_steps_before_increment.getValue();
 
     // If all the load is applied at once, increment now the load since it will be used for the computation of the first time step
-    if (m_traction_is_constant)
+    if (m_traction_is_constant) {
+        m_current_traction = d_traction.getValue();
+        m_previous_traction = m_current_traction;
         increment_load(d_traction.getValue());
+    }
 }
 
 template<class DataTypes>
@@ -117,6 +122,8 @@ void TractionForce<DataTypes>::reset()
     nodal_forces.clear();
     d_total_load.setValue(0.);
     m_current_traction = Deriv();
+    m_previous_traction = Deriv();
+    m_load_increment = d_slope.getValue();
 }
 
 template<class DataTypes>
@@ -129,10 +136,12 @@ void TractionForce<DataTypes>::handleEvent(sofa::core::objectmodel::Event* event
         return;
 
     const Deriv & maximum_traction_to_apply = d_traction.getValue();
-    const Real &  slope = d_slope.getValue();
     const unsigned int number_of_steps_before_increment = d_number_of_steps_before_increment.getValue();
     unsigned int & number_of_steps_since_last_increment = m_number_of_steps_since_last_increment;
 
+    // Load of the last equilibrium, to which the time step can go back if its increment is cut back
+    m_previous_traction = m_current_traction;
+
     // If we've reach the total traction threshold, do not increment the load again
     if (m_current_traction.norm() >= maximum_traction_to_apply.norm())
         return;
@@ -147,8 +156,8 @@ void TractionForce<DataTypes>::handleEvent(sofa::core::objectmodel::Event* event
     // We reached the amount of steps required, reset the counter as we will do an increment right now
     number_of_steps_since_last_increment = 0;
 
-    // Compute the increment value from the given slope
-    Deriv increment = maximum_traction_to_apply * slope;
+    // Compute the increment value from the given slope (or the increment set by set_load_increment)
+    Deriv increment = maximum_traction_to_apply * m_load_increment;
 
     // Add the increment to the current applied load to get an idea of the traction we would apply
     Deriv traction_to_apply = m_current_traction + increment;
@@ -231,7 +240,41 @@ void TractionForce<DataTypes>::increment_load(Deriv traction_increment_per_unit_
         }
     }
 
-    current_load += load.norm();
+    // The increment is negative when the load is decreased (ex. a load increment cut back by the StaticODESolver)
+    if (traction_increment_per_unit_area * d_traction.getValue() < 0)
+        current_load -= load.norm();
+    else
+        current_load += load.norm();
+}
+
+template<class DataTypes>
+double TractionForce<DataTypes>::load_factor() const
+{
+    const auto total_traction = d_traction.getValue().norm();
+    if (total_traction < EPSILON)
+        return 0.;
+
+    return static_cast<double>(m_current_traction.norm() / total_traction);
+}
+
+template<class DataTypes>
+double TractionForce<DataTypes>::previous_load_factor() const
+{
+    const auto total_traction = d_traction.getValue().norm();
+    if (total_traction < EPSILON)
+        return 0.;
+
+    return static_cast<double>(m_previous_traction.norm() / total_traction);
+}
+
+template<class DataTypes>
+void TractionForce<DataTypes>::set_load_factor(const double & factor)
+{
+    const Deriv traction_to_apply = d_traction.getValue() * static_cast<Real>(factor);
+    const Deriv increment = traction_to_apply - m_current_traction;
+
+    m_current_traction = traction_to_apply;
+    increment_load(increment);
 }
 
 template<class DataTypes>
@@ -251,6 +294,25 @@ void TractionForce<DataTypes>::addForce(const sofa::core::MechanicalParams* mpar
     sofa::helper::AdvancedTimer::stepEnd("TractionForce::addForce");
 }
 
+template<class DataTypes>
+SReal TractionForce<DataTypes>::getPotentialEnergy(const sofa::core::MechanicalParams* mparams, const Data<VecCoord>& d_x) const
+{
+    SOFA_UNUSED(mparams);
+    if (! d_mechanicalState.get())
+        return 0.;
+
+    // The nodal forces are dead loads (computed on the rest surface), hence their potential is -f.u
+    sofa::helper::ReadAccessor<Data<VecDeriv>> nodal_forces = d_nodal_forces;
+    sofa::helper::ReadAccessor<Data<VecCoord>> x = d_x;
+    const auto rest_positions = d_mechanicalState.get()->readRestPositions();
+
+    SReal energy = 0.;
+    for (size_t i = 0; i < nodal_forces.size() and i < x.size(); ++i)
+        energy -= nodal_forces[i] * (x[i] - rest_positions[i]);
+
+    return energy;
+}
+
 template<class DataTypes>
 void TractionForce<DataTypes>::draw(const sofa::core::visual::VisualParams* vparams)
 {
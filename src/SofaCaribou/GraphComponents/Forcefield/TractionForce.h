@@ -6,6 +6,7 @@
 #include <SofaBaseTopology/TriangleSetTopologyContainer.h>
 #include <SofaBaseTopology/QuadSetTopologyContainer.h>
 #include <sofa/core/behavior/MechanicalState.h>
+#include <SofaCaribou/GraphComponents/Forcefield/IncrementalLoad.h>
 
 namespace SofaCaribou::GraphComponents::forcefield {
 
@@ -21,13 +22,14 @@ using namespace sofa::component::topology;
  * of the component.
  *
  * This component allows to apply the total tractive force from a set of smaller load increments following a linear slope until
- * the total load is reach, or apply all the load at once.
+ * the total load is reach, or apply all the load at once. The size of the increments can be driven by another component
+ * (see IncrementalLoad), ex. the adaptive load stepping of the StaticODESolver.
  *
  * @tparam DataTypes The datatype of the coordinates/derivatives vectors (3D float vector, 3D double vector, 2D float
  * vector or 2D double vector).
  */
 template<class DataTypes>
-class TractionForce : public sofa::core::behavior::ForceField<DataTypes>
+class TractionForce : public sofa::core::behavior::ForceField<DataTypes>, public IncrementalLoad
 {
 public:
     SOFA_CLASS(SOFA_TEMPLATE(TractionForce, DataTypes), SOFA_TEMPLATE(sofa::core::behavior::ForceField, DataTypes));
@@ -62,15 +64,26 @@ public:
     void addKToMatrix(sofa::defaulttype::BaseMatrix * /*matrix*/, SReal /*kFact*/, unsigned int & /*offset*/) override {}
     void draw(const sofa::core::visual::VisualParams* vparams) override;
     void handleEvent(sofa::core::objectmodel::Event* event) override;
-    SReal getPotentialEnergy(const sofa::core::MechanicalParams* /*mparams*/, const Data<VecDeriv>&  /* x */) const override
-    {
-        msg_error() << "Get potentialEnergy not implemented";
-        return 0.0;
-    }
+    SReal getPotentialEnergy(const sofa::core::MechanicalParams* mparams, const Data<VecCoord>& d_x) const override;
 
     /** Increment the traction load by an increment of traction_increment (vector of tractive force per unit area). */
     void increment_load(Deriv traction_increment_per_unit_area) ;
 
+    /** Fraction of the traction load currently applied. */
+    auto load_factor() const -> double override;
+
+    /** Fraction of the traction load applied at the beginning of the current time step. */
+    auto previous_load_factor() const -> double override;
+
+    /** Apply the given fraction of the traction load by incrementing (or decrementing) the current load. */
+    void set_load_factor(const double & factor) override;
+
+    /** Fraction of the traction load added at each increment (initially the slope). */
+    auto load_increment() const -> double override { return static_cast<double>(m_load_increment); }
+
+    /** Set the fraction of the traction load added at each increment (in place of the slope). */
+    void set_load_increment(const double & increment) override { m_load_increment = static_cast<Real>(increment); }
+
     // Inputs
     Data<Deriv> d_traction; ///< Tractive force per unit area
     Data<sofa::helper::vector<Triange> > d_triangles; ///< List of triangles (ex: [t1p1 t1p2 t1p3 t2p1 t2p2 t2p3 ...])
@@ -88,6 +101,8 @@ private:
 
     bool m_traction_is_constant = false;
     Deriv m_current_traction;
+    Deriv m_previous_traction; ///< Traction applied at the beginning of the current time step
+    Real m_load_increment = 0; ///< Fraction of the traction added at each increment
     unsigned int m_number_of_steps_since_last_increment = 0;
 };
 
@@ -16,6 +16,13 @@ public:
 
     SOFA_CLASS(SOFA_TEMPLATE(HyperelasticMaterial, DataTypes), sofa::core::objectmodel::BaseObject);
 
+    /** Quantities evaluated at a material point by PK2_stress_and_jacobian. */
+    struct StressAndJacobian {
+        Eigen::Matrix<Real, Dimension, Dimension> S; ///< Second Piola-Kirchhoff stress tensor
+        Eigen::Matrix<Real, 6, 6> D;                 ///< Jacobian of S w.r.t E (compressed format)
+        Real Psi = 0;                                ///< Strain energy density (only computed on demand)
+    };
+
     /**
      * This is called just before the material is updated on every points (usually just before a Newton step).
      * It can be used to update some coefficients that will be used on material points (for example, compute
@@ -52,6 +59,25 @@ public:
     virtual Eigen::Matrix<Real, 6, 6>
     PK2_stress_jacobian(const Real & J, const Eigen::Matrix<Real, Dimension, Dimension>  & E) const = 0;
 
+    /**
+     * Get the second Piola-Kirchhoff stress tensor S, its jacobian D, and optionally the strain energy density Psi
+     * in a single evaluation. This is the method to use when more than one of these quantities is needed at the
+     * same material point, since the intermediate terms (for example, the inverse of the right Cauchy-Green tensor)
+     * are computed only once.
+     *
+     * The default implementation simply calls PK2_stress, PK2_stress_jacobian and strain_energy_density.
+     */
+    virtual StressAndJacobian
+    PK2_stress_and_jacobian(const Real & J, const Eigen::Matrix<Real, Dimension, Dimension>  & E, bool compute_strain_energy_density) const {
+        StressAndJacobian r;
+        r.S = PK2_stress(J, E);
+        r.D = PK2_stress_jacobian(J, E);
+        if (compute_strain_energy_density) {
+            r.Psi = strain_energy_density(J, E);
+        }
+        return r;
+    }
+
 
     // Sofa's scene methods
 
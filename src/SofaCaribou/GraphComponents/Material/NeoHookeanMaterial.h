@@ -50,7 +50,7 @@ public:
     }
 
     /** Get the second Piola-Kirchhoff stress tensor from the Green-Lagrange strain tensor E. */
-    virtual Eigen::Matrix<Real, Dimension, Dimension>
+    Eigen::Matrix<Real, Dimension, Dimension>
     PK2_stress(const Real & J, const Eigen::Matrix<Real, Dimension, Dimension>  & E) const override {
 
         static const auto I = Eigen::Matrix<Real, Dimension, Dimension, Eigen::RowMajor>::Identity();
@@ -61,7 +61,7 @@ public:
     }
 
     /** Get the jacobian of the second Piola-Kirchhoff stress tensor w.r.t the Green-Lagrange strain tensor E. */
-    virtual Eigen::Matrix<Real, 6, 6>
+    Eigen::Matrix<Real, 6, 6>
     PK2_stress_jacobian(const Real & J, const Eigen::Matrix<Real, Dimension, Dimension> & E) const override {
         using caribou::algebra::symmetric_dyad_1;
         using caribou::algebra::symmetric_dyad_2;
@@ -75,6 +75,28 @@ public:
         return D;
     }
 
+    /**
+     * Get the stress tensor, its jacobian and optionally the strain energy density, computing C^-1 and ln(J) once.
+     */
+    typename HyperelasticMaterial<DataTypes>::StressAndJacobian
+    PK2_stress_and_jacobian(const Real & J, const Eigen::Matrix<Real, Dimension, Dimension> & E, bool compute_strain_energy_density) const override {
+        using caribou::algebra::symmetric_dyad_1;
+        using caribou::algebra::symmetric_dyad_2;
+
+        static const auto I = Eigen::Matrix<Real, Dimension, Dimension, Eigen::RowMajor>::Identity();
+        const auto C  = (I + 2*E).eval(); // Right Cauchy-Green tensor
+        const auto Ci = C.inverse().eval();
+        const auto lnJ = log(J);
+
+        typename HyperelasticMaterial<DataTypes>::StressAndJacobian r;
+        r.S = (I - Ci)*mu + Ci*(l*lnJ);
+        r.D = l*symmetric_dyad_1(Ci) + 2*(mu - l*lnJ)*symmetric_dyad_2(Ci);
+        if (compute_strain_energy_density) {
+            r.Psi = mu*E.trace() - mu*lnJ + l/2 *lnJ*lnJ;
+        }
+        return r;
+    }
+
 private:
     // Private members
     Real mu; // Lame's mu parameter
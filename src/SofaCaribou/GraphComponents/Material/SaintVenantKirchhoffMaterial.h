@@ -72,6 +72,21 @@ public:
         return C;
     }
 
+    /** Get the stress tensor, its (constant) jacobian and optionally the strain energy density. */
+    typename HyperelasticMaterial<DataTypes>::StressAndJacobian
+    PK2_stress_and_jacobian(const Real & /*J*/, const Eigen::Matrix<Real, Dimension, Dimension> & E, bool compute_strain_energy_density) const override {
+        static const auto I = Eigen::Matrix<Real, Dimension, Dimension, Eigen::RowMajor>::Identity();
+        const auto trE  = E.trace();
+
+        typename HyperelasticMaterial<DataTypes>::StressAndJacobian r;
+        r.S = l*trE*I + 2*mu*E;
+        r.D = C;
+        if (compute_strain_energy_density) {
+            r.Psi = l/2.*(trE*trE) + mu*(E*E).trace();
+        }
+        return r;
+    }
+
 private:
     // Private members
     Real mu; // Lame's mu parameter
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <sofa/core/MechanicalParams.h>
+#include <sofa/core/objectmodel/BaseContext.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/MechanicalComputeEnergyVisitor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SofaCaribou::GraphComponents::ode {
+
+/**
+ * Backtracking line search on the total potential energy phi(a) of the positions x + a d, for the static
+ * solvers. The step length is reduced until the Armijo condition phi(a) <= phi(0) + c a phi'(0) holds.
+ */
+
+/// Constant c of the Armijo condition (also used as the sufficient decrease of the residual's norm)
+constexpr double sufficient_decrease = 1e-4;
+
+/// Total potential energy of the mechanical objects of the context sub-graph at their current positions
+inline double compute_potential_energy(sofa::core::objectmodel::BaseContext * context) {
+    sofa::helper::AdvancedTimer::stepBegin("ComputeEnergy");
+    sofa::simulation::MechanicalComputeEnergyVisitor energy_visitor(sofa::core::MechanicalParams::defaultInstance());
+    energy_visitor.execute(context);
+    sofa::helper::AdvancedTimer::stepEnd("ComputeEnergy");
+    return energy_visitor.getPotentialEnergy();
+}
+
+/**
+ * Whether or not the energy at the step length a satisfies the Armijo condition. Near the equilibrium, the decrease
+ * of energy is lost in the rounding errors of its summation, which are tolerated.
+ *
+ * @param energy_start The energy phi(0) at the beginning of the step
+ * @param slope The slope phi'(0) of the energy along the direction (negative for a descent direction)
+ * @param step_length The current step length a
+ * @param energy The energy phi(a) at the current step length
+ */
+inline bool energy_sufficiently_decreases(double energy_start, double slope, double step_length, double energy) {
+    const double energy_rounding = 100 * std::numeric_limits<FLOATING_POINT_TYPE>::epsilon() * std::abs(energy_start);
+    return energy <= energy_start + sufficient_decrease * step_length * slope + energy_rounding;
+}
+
+/**
+ * Next step length of the backtracking: minimizer of the quadratic interpolating the energy and its slope at 0 and
+ * its value at the current step length a, safeguarded to [0.1, 0.5] times a.
+ */
+inline double backtracked_step_length(double energy_start, double slope, double step_length, double energy) {
+    const double a = step_length;
+    const double minimizer = -slope * a * a / (2. * (energy - energy_start - slope * a));
+    return std::min(std::max(minimizer, 0.1 * a), 0.5 * a);
+}
+
+} // namespace SofaCaribou::GraphComponents::ode
@@ -0,0 +1,342 @@
+#include "LBFGSODESolver.h"
+#include "EnergyLineSearch.h"
+#include <SofaCaribou/Algebra/EigenMatrixWrapper.h>
+#include <SofaCaribou/GraphComponents/Forcefield/BlockDiagonalStiffness.h>
+
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/VectorOperations.h>
+#include <sofa/simulation/PropagateEventVisitor.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <SofaEigen2Solver/EigenVectorWrapper.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SofaCaribou::GraphComponents::ode {
+
+using Timer = sofa::helper::AdvancedTimer;
+using sofa::component::linearsolver::EigenVectorWrapper;
+
+LBFGSODESolver::LBFGSODESolver()
+    : d_iterations(initData(&d_iterations,
+            (unsigned) 1000,
+            "iterations",
+            "Maximum number of L-BFGS iterations."))
+    , d_residual_tolerance_threshold(initData(&d_residual_tolerance_threshold,
+            (double) 1e-5,
+            "residual_tolerance_threshold",
+            "Convergence criterion: The iterations will stop when the ratio between norm of the residual R_k = |f_k - K(u_k)| at iteration k over R_0 is lower than this threshold."))
+    , d_history_size(initData(&d_history_size,
+            (unsigned) 10,
+            "history_size",
+            "Number m of updates (positions and residual increments) kept to approximate the inverse of the hessian. "
+            "The memory used is 2 m n, n being the number of degrees of freedom."))
+    , d_line_search_iterations(initData(&d_line_search_iterations,
+            (unsigned) 10,
+            "line_search_iterations",
+            "Maximum number of step length reductions of the line search at each iteration. The step length of the "
+            "last reduction is taken if none of them satisfy the decrease of the potential energy."))
+    , d_preconditioner(initData(&d_preconditioner,
+            "preconditioner",
+            R"(
+            Initial approximation of the inverse hessian used by the two-loop recursion.
+                None:             The scaled identity (s.y / y.y) I of the last update (default).
+                InitialStiffness: The LDL^T factorization of the stiffness matrix assembled at the start of the
+                                  first time step. It is only assembled and factorized once.
+                NodeBlockJacobi:  The inverse of the diagonal node blocks of the stiffness matrix at the start of
+                                  each time step, gathered from the forcefields without assembling the matrix.
+            )",
+            true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+    , d_converged(initData(&d_converged, false, "converged", "Whether or not the last call to solve converged", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+    , d_residuals(initData(&d_residuals, "residuals", "Norm of the residual |R| at the beginning of the last call to solve, followed by its norm after each iteration.", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+{
+    d_preconditioner.setValue(sofa::helper::OptionsGroup(std::vector<std::string> {"None", "InitialStiffness", "NodeBlockJacobi"}));
+    sofa::helper::WriteAccessor<Data< sofa::helper::OptionsGroup >> preconditioner = d_preconditioner;
+    preconditioner->setSelectedItem((unsigned int) 0);
+}
+
+auto LBFGSODESolver::get_preconditioner() const -> Preconditioner {
+    const auto & selected = d_preconditioner.getValue().getSelectedItem();
+    if (selected == "InitialStiffness") {
+        return Preconditioner::InitialStiffness;
+    }
+    if (selected == "NodeBlockJacobi") {
+        return Preconditioner::NodeBlockJacobi;
+    }
+    return Preconditioner::None;
+}
+
+void LBFGSODESolver::reset() {
+    p_number_of_updates = 0;
+    p_newest_update = -1;
+    p_stiffness_is_factorized = false;
+}
+
+void LBFGSODESolver::apply_initial_inverse_hessian(const Vector & q, Vector & r) const {
+    const auto preconditioner = get_preconditioner();
+    if (preconditioner == Preconditioner::InitialStiffness and p_stiffness_is_factorized) {
+        r = p_stiffness_ldlt.solve(q);
+    } else if (preconditioner == Preconditioner::NodeBlockJacobi and p_node_block_jacobi.rows() == q.size()) {
+        r = p_node_block_jacobi.solve(q);
+    } else if (p_number_of_updates > 0) {
+        // Scaled identity (s.y / y.y) I of the newest update
+        const auto & y = p_y.col(p_newest_update);
+        r = q / (p_rho[p_newest_update] * y.dot(y));
+    } else {
+        r = q;
+    }
+}
+
+void LBFGSODESolver::factorize_stiffness(sofa::simulation::common::MechanicalOperations & mop, const Eigen::Index & n) {
+    Timer::stepBegin("FactorizeStiffness");
+
+    // Assemble K = -df/dx (the projective constraints replace the rows and columns of the fixed degrees of freedom)
+    Algebra::EigenMatrixWrapper<SparseMatrix &> wrapper (p_K);
+    wrapper.resize(n, n);
+    p_accessor.setGlobalMatrix(&wrapper);
+    mop.addMBK_ToMatrix(&p_accessor, 0, 0, -1);
+    p_accessor.computeGlobalMatrix();
+    wrapper.compress();
+    p_accessor.setGlobalMatrix(nullptr);
+
+    p_stiffness_ldlt.compute(p_K);
+    p_stiffness_is_factorized = (p_stiffness_ldlt.info() == Eigen::Success);
+    if (not p_stiffness_is_factorized) {
+        msg_error() << "The LDL^T factorization of the stiffness matrix failed (the matrix may be singular), the "
+                    << "InitialStiffness preconditioner is disabled.";
+    }
+
+    Timer::stepEnd("FactorizeStiffness");
+}
+
+void LBFGSODESolver::factorize_node_blocks(sofa::simulation::common::MechanicalOperations & mop, const Eigen::Index & n, bool verbose) {
+    using Block = NodeBlockJacobi::Block;
+    Timer::stepBegin("FactorizeNodeBlocks");
+
+    if (n % 3 != 0) {
+        if (verbose) {
+            msg_warning() << "The NodeBlockJacobi preconditioner requires 3D nodes, it is disabled.";
+        }
+        Timer::stepEnd("FactorizeNodeBlocks");
+        return;
+    }
+
+    // Blocks of K = -df/dx, i.e. kFactor = -1
+    sofa::core::MechanicalParams mparams (mop.mparams);
+    mparams.setMFactor(0);
+    mparams.setBFactor(0);
+    mparams.setKFactor(-1);
+
+    std::vector<Block, Eigen::aligned_allocator<Block>> blocks (static_cast<std::size_t>(n/3), Block::Zero());
+    const auto ignored = forcefield::add_diagonal_node_blocks(this->getContext(), p_accessor, &mparams, blocks);
+    if (verbose) {
+        for (const auto * forcefield : ignored) {
+            msg_warning() << "The component '" << forcefield->getPathName() << "' doesn't give the diagonal node "
+                          << "blocks of its stiffness, it is ignored by the NodeBlockJacobi preconditioner.";
+        }
+    }
+
+    p_node_block_jacobi.factorize(blocks);
+
+    Timer::stepEnd("FactorizeNodeBlocks");
+}
+
+void LBFGSODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId /*vResult*/) {
+    using namespace sofa::core::behavior;
+    sofa::simulation::common::VectorOperations vop( params, this->getContext() );
+    sofa::simulation::common::MechanicalOperations mop( params, this->getContext() );
+    MultiVecCoord x(&vop, xResult /*core::VecCoordId::position()*/ );
+    MultiVecDeriv force( &vop, sofa::core::VecDerivId::force() );
+    p_dx.realloc( &vop, true );
+
+    // MO vector dx is not allocated by default, it will seg fault if the CG is used (dx is taken by default) with an IdentityMapping
+    MultiVecDeriv tempdx(&vop, sofa::core::VecDerivId::dx() ); tempdx.realloc( &vop, true, true );
+
+    msg_info() << "======= Starting L-BFGS static solver in time step " << this->getTime();
+
+    Timer::stepBegin("LBFGSODESolver::Solve");
+
+    // Global dimension and offsets of the mechanical objects in the flat vectors
+    p_accessor.clear();
+    mop.getMatrixDimension(nullptr, nullptr, &p_accessor);
+    p_accessor.setupMatrices();
+    const auto n = static_cast<Eigen::Index>(p_accessor.getGlobalDimension());
+    const auto m = static_cast<Eigen::Index>(std::max(d_history_size.getValue(), 1u));
+    if (p_s.rows() != n or p_s.cols() != m) {
+        // The history (and the stiffness) is only valid for the same system
+        reset();
+        p_s.resize(n, m);
+        p_y.resize(n, m);
+        p_rho.resize(m);
+    }
+
+    const auto & iterations = d_iterations.getValue();
+    const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
+    const auto & line_search_iterations = d_line_search_iterations.getValue();
+    const auto preconditioner = get_preconditioner();
+    sofa::helper::vector<double> residuals;
+    bool converged = false;
+
+    // Gradient of the potential energy, i.e. minus the (projected) residual
+    const auto compute_gradient = [&](Vector & g) {
+        Timer::stepBegin("ComputeForce");
+        force.clear();
+        mop.computeForce(force);
+        mop.projectResponse(force);
+        Timer::stepEnd("ComputeForce");
+
+        g.resize(n);
+        EigenVectorWrapper<FLOATING_POINT_TYPE> g_wrapper(g);
+        mop.multiVector2BaseVector(force.id(), &g_wrapper, &p_accessor);
+        g = -g;
+    };
+
+    // Project the direction in the constrained space
+    const auto project = [&](Vector & v) {
+        EigenVectorWrapper<FLOATING_POINT_TYPE> v_wrapper(v);
+        mop.baseVector2MultiVector(&v_wrapper, p_dx.id(), &p_accessor);
+        mop.projectResponse(p_dx);
+        mop.multiVector2BaseVector(p_dx.id(), &v_wrapper, &p_accessor);
+    };
+
+    // Move the positions by a*d from the positions at the start of the line search
+    double moved_length = 0;
+    const auto move = [&](const double & step_length) {
+        x.peq(p_dx, step_length - moved_length);
+        moved_length = step_length;
+
+        // Solving constraints
+        mop.solveConstraint(x, sofa::core::ConstraintParams::POS);
+
+        //propagate positions to mapped nodes (calls apply, applyJ)
+        sofa::core::MechanicalParams mp;
+        sofa::simulation::MechanicalPropagateOnlyPositionAndVelocityVisitor(&mp).execute(this->getContext());
+    };
+
+    Vector g, g_new, d, q, r;
+    Vector alpha (m);
+    compute_gradient(g);
+    double R = g.norm();
+    const double R0 = R;
+    residuals.push_back(R);
+    if (residual_tolerance_threshold > 0 && R <= residual_tolerance_threshold) {
+        msg_info() << "The ODE has already reached an equilibrium state";
+        converged = true;
+    }
+
+    // Preconditioners at the current positions (the stiffness depends on the last computeForce)
+    if (not converged) {
+        if (preconditioner == Preconditioner::InitialStiffness and not p_stiffness_is_factorized) {
+            factorize_stiffness(mop, n);
+        } else if (preconditioner == Preconditioner::NodeBlockJacobi) {
+            factorize_node_blocks(mop, n, p_node_block_jacobi.rows() != n);
+        }
+    }
+
+    double energy = (converged) ? 0. : compute_potential_energy(this->getContext());
+    unsigned int n_it = 0;
+    for (; not converged and n_it < iterations; ++n_it) {
+        Timer::stepBegin("LBFGSStep");
+
+        // Two-loop recursion: d = -H g
+        Timer::stepBegin("TwoLoopRecursion");
+        q = g;
+        for (Eigen::Index k = 0; k < p_number_of_updates; ++k) {
+            const auto i = (p_newest_update - k + m) % m;
+            alpha[i] = p_rho[i] * p_s.col(i).dot(q);
+            q.noalias() -= alpha[i] * p_y.col(i);
+        }
+        apply_initial_inverse_hessian(q, r);
+        for (Eigen::Index k = p_number_of_updates - 1; k >= 0; --k) {
+            const auto i = (p_newest_update - k + m) % m;
+            const FLOATING_POINT_TYPE beta = p_rho[i] * p_y.col(i).dot(r);
+            r.noalias() += (alpha[i] - beta) * p_s.col(i);
+        }
+        d = -r;
+        project(d);
+        Timer::stepEnd("TwoLoopRecursion");
+
+        // The approximation of the hessian may not be positive definite anymore, restart from the steepest descent
+        double slope = g.dot(d);
+        if (slope >= 0) {
+            msg_info() << "The L-BFGS direction is not a descent direction, the updates history is cleared.";
+            p_number_of_updates = 0;
+            p_newest_update = -1;
+            d = -g;
+            project(d);
+            slope = g.dot(d);
+        }
+
+        // Without any curvature information, the first step moves the positions by a length of at most 1
+        double step_length = (p_number_of_updates == 0 and preconditioner == Preconditioner::None) ? std::min(1., 1. / R) : 1.;
+
+        // Backtracking line search on the potential energy (Armijo condition)
+        Timer::stepBegin("LineSearch");
+        EigenVectorWrapper<FLOATING_POINT_TYPE> d_wrapper(d);
+        mop.baseVector2MultiVector(&d_wrapper, p_dx.id(), &p_accessor);
+        moved_length = 0;
+        double energy_new = energy;
+        for (unsigned int line_search_iteration = 0; ; ++line_search_iteration) {
+            move(step_length);
+            compute_gradient(g_new);
+            energy_new = compute_potential_energy(this->getContext());
+
+            if (energy_sufficiently_decreases(energy, slope, step_length, energy_new) or
+                line_search_iteration >= line_search_iterations) {
+                break;
+            }
+            step_length = backtracked_step_length(energy, slope, step_length, energy_new);
+        }
+        Timer::stepEnd("LineSearch");
+
+        // New update, only kept if it satisfies the curvature condition y.s > 0 (the approximation stays positive
+        // definite)
+        const FLOATING_POINT_TYPE step = static_cast<FLOATING_POINT_TYPE>(step_length);
+        const FLOATING_POINT_TYPE ys = step * (g_new - g).dot(d);
+        if (ys > std::numeric_limits<FLOATING_POINT_TYPE>::epsilon() * step * d.norm() * (g_new - g).norm()) {
+            p_newest_update = (p_newest_update + 1) % m;
+            p_s.col(p_newest_update).noalias() = step * d;
+            p_y.col(p_newest_update).noalias() = g_new - g;
+            p_rho[p_newest_update] = 1 / ys;
+            p_number_of_updates = std::min(p_number_of_updates + 1, m);
+        }
+
+        g.swap(g_new);
+        energy = energy_new;
+        R = g.norm();
+        residuals.push_back(R);
+
+        msg_info() << "L-BFGS iteration #" << n_it + 1
+                   << ": |R|/|R0| = " << R/R0 << " (threshold of " << residual_tolerance_threshold << ")"
+                   << "  step length = " << step_length;
+        Timer::valSet("residual", R);
+        Timer::valSet("step_length", step_length);
+        Timer::stepEnd("LBFGSStep");
+
+        if (residual_tolerance_threshold > 0 and R < residual_tolerance_threshold*R0) {
+            converged = true;
+            msg_info() << "[CONVERGED] The residual's ratio |R|/|R0| = " << R/R0 << " is smaller than the threshold of "
+                       << residual_tolerance_threshold;
+        }
+    }
+
+    if (not converged) {
+        msg_info() << "[DIVERGED] The number of L-BFGS iterations reached the maximum of " << iterations << " iterations";
+    }
+
+    d_converged.setValue(converged);
+    d_residuals.setValue(residuals);
+
+    Timer::valSet("has_converged", converged ? 1 : 0);
+    Timer::valSet("nb_iterations", n_it);
+    Timer::valSet("residual", R);
+    Timer::stepEnd("LBFGSODESolver::Solve");
+}
+
+int LBFGSODESolverClass = sofa::core::RegisterObject("Static ODE solver minimizing the potential energy with L-BFGS quasi-newton iterations")
+    .add< LBFGSODESolver >()
+;
+
+} // namespace SofaCaribou::GraphComponents::ode
@@ -0,0 +1,178 @@
+#ifndef SOFACARIBOU_GRAPHCOMPONENTS_ODE_LBFGSODESOLVER_H
+#define SOFACARIBOU_GRAPHCOMPONENTS_ODE_LBFGSODESOLVER_H
+
+#include <Caribou/config.h>
+#include <SofaCaribou/Algebra/BlockDiagonalPreconditioner.h>
+#include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/core/behavior/MultiVec.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <sofa/helper/vector.h>
+#include <sofa/helper/OptionsGroup.h>
+#include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+namespace SofaCaribou::GraphComponents::ode {
+
+using sofa::core::objectmodel::Data;
+
+/**
+ * Static ODE solver finding the equilibrium positions by minimizing the total potential energy with the limited
+ * memory BFGS quasi-newton method.
+ *
+ * Unlike the StaticODESolver, no tangent stiffness matrix is needed (and no linear solver): every iterations only
+ * compute the forces (computeForce) and the potential energy (getPotentialEnergy) of the forcefields. The inverse of
+ * the hessian is approximated from the last m updates of the positions s_k = x_k+1 - x_k and of the gradient
+ * (minus the residual) y_k = R_k - R_k+1, applied to the gradient with the two-loop recursion. Only these 2m vectors
+ * are stored, hence the memory stays O(m n) for n degrees of freedom. The length of each step is found by a
+ * backtracking line search on the potential energy (Armijo condition), so every forcefields must implement
+ * getPotentialEnergy (ex. HyperelasticForcefield and TractionForce).
+ *
+ * The initial approximation of the inverse hessian used by the two-loop recursion can be given by a cheap
+ * preconditioner:
+ *   None:             The scaled identity (s.y / y.y) I of the last update.
+ *   InitialStiffness: The LDL^T factorization of the stiffness matrix assembled at the start of the first time
+ *                     step (usually the linear stiffness at rest). It is only assembled and factorized once.
+ *   NodeBlockJacobi:  The inverse of the diagonal node blocks of the current stiffness matrix, gathered from the
+ *                     forcefields without assembling the matrix (see BlockDiagonalStiffness).
+ *
+ * The updates are kept between time steps since the hessian of the internal energy doesn't depend on the load.
+ */
+class LBFGSODESolver : public sofa::core::behavior::OdeSolver
+{
+public:
+    SOFA_CLASS(LBFGSODESolver, sofa::core::behavior::OdeSolver);
+    using SparseMatrix = Eigen::SparseMatrix<FLOATING_POINT_TYPE, Eigen::ColMajor>;
+    using Vector = Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 1>;
+    using DenseMatrix = Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic>;
+    using NodeBlockJacobi = Algebra::BlockDiagonalPreconditioner<FLOATING_POINT_TYPE, 3>;
+
+    /// Initial approximations of the inverse hessian
+    enum class Preconditioner : unsigned int {
+        /// Scaled identity (default)
+        None = 0,
+
+        /// LDL^T factorization of the stiffness matrix at the start of the simulation
+        InitialStiffness = 1,
+
+        /// Inverse of the diagonal node blocks of the current stiffness matrix
+        NodeBlockJacobi = 2
+    };
+
+    LBFGSODESolver();
+
+    void solve (const sofa::core::ExecParams* params /* PARAMS FIRST */, double dt, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId vResult) override;
+
+    /// Clear the updates history and the preconditioner
+    void reset() override;
+
+    /// Same integration factors as the StaticODESolver (see its documentation)
+    double getVelocityIntegrationFactor() const override
+    {
+        return 1.0;
+    }
+
+    double getPositionIntegrationFactor() const override
+    {
+        return getContext()->getDt();
+    }
+
+    double getIntegrationFactor(int inputDerivative, int outputDerivative) const override
+    {
+        const double dt = getContext()->getDt();
+        double matrix[3][3] =
+            {
+                { 1, dt, 0},
+                { 0, 1, 0},
+                { 0, 0, 0}
+            };
+        if (inputDerivative >= 3 || outputDerivative >= 3)
+            return 0;
+        else
+            return matrix[outputDerivative][inputDerivative];
+    }
+
+    double getSolutionIntegrationFactor(int outputDerivative) const override
+    {
+        const double dt = getContext()->getDt();
+        double vect[3] = { dt, 1, 1/dt};
+        if (outputDerivative >= 3)
+            return 0;
+        else
+            return vect[outputDerivative];
+    }
+
+protected:
+    /// INPUTS
+    Data<unsigned int> d_iterations;
+    Data<double> d_residual_tolerance_threshold;
+    Data<unsigned int> d_history_size;
+    Data<unsigned int> d_line_search_iterations;
+    Data<sofa::helper::OptionsGroup> d_preconditioner;
+
+    /// OUTPUTS
+    Data<bool> d_converged; ///< Whether or not the last call to solve converged
+    Data<sofa::helper::vector<double>> d_residuals; ///< Norm of the residual at each iteration of the last call to solve
+
+private:
+    /// Private methods
+    /// Get the preconditioner selected by the user
+    Preconditioner get_preconditioner() const;
+
+    /**
+     * Compute r = H0 q, H0 being the initial approximation of the inverse hessian (the preconditioner, or the scaled
+     * identity of the last update).
+     */
+    void apply_initial_inverse_hessian(const Vector & q, Vector & r) const;
+
+    /**
+     * Assemble the stiffness matrix K = -df/dx of the mechanical objects (using the accessor's global offsets) and
+     * factorize it.
+     */
+    void factorize_stiffness(sofa::simulation::common::MechanicalOperations & mop, const Eigen::Index & n);
+
+    /**
+     * Gather the diagonal node blocks of the stiffness matrix K = -df/dx from the forcefields and invert them. The
+     * forcefields not giving their blocks are ignored (with a warning if verbose is true).
+     */
+    void factorize_node_blocks(sofa::simulation::common::MechanicalOperations & mop, const Eigen::Index & n, bool verbose);
+
+    /// Private members
+    ///< Correction of the positions
+    sofa::core::behavior::MultiVecDeriv p_dx;
+
+    ///< Accessor used to determine the index of each mechanical object vector in the global vectors.
+    sofa::component::linearsolver::DefaultMultiMatrixAccessor p_accessor;
+
+    ///< Last m updates of the positions (one per column, in a circular buffer)
+    DenseMatrix p_s;
+
+    ///< Last m updates of the gradient (one per column, in a circular buffer)
+    DenseMatrix p_y;
+
+    ///< 1 / (y.s) of the last m updates
+    Vector p_rho;
+
+    ///< Number of updates stored
+    Eigen::Index p_number_of_updates = 0;
+
+    ///< Column of the newest update
+    Eigen::Index p_newest_update = -1;
+
+    ///< Stiffness matrix of the InitialStiffness preconditioner
+    SparseMatrix p_K;
+
+    ///< Factorization of the InitialStiffness preconditioner
+    Eigen::SimplicialLDLT<SparseMatrix> p_stiffness_ldlt;
+
+    ///< Whether or not the stiffness of the InitialStiffness preconditioner was assembled and factorized
+    bool p_stiffness_is_factorized = false;
+
+    ///< NodeBlockJacobi preconditioner
+    NodeBlockJacobi p_node_block_jacobi;
+};
+
+} // namespace SofaCaribou::GraphComponents::ode
+
+#endif //SOFACARIBOU_GRAPHCOMPONENTS_ODE_LBFGSODESOLVER_H
@@ -1,11 +1,19 @@
 #include "StaticODESolver.h"
+#include "EnergyLineSearch.h"
+#include <SofaCaribou/GraphComponents/Forcefield/FrozenTangentStiffness.h>
+#include <SofaCaribou/GraphComponents/Solver/IterativeLinearSolver.h>
 
 #include <sofa/core/ObjectFactory.h>
+#include <sofa/core/behavior/BaseForceField.h>
+#include <sofa/core/behavior/LinearSolver.h>
 #include <sofa/helper/AdvancedTimer.h>
 #include <sofa/simulation/MechanicalOperations.h>
 #include <sofa/simulation/VectorOperations.h>
 #include <sofa/simulation/PropagateEventVisitor.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace SofaCaribou {
 namespace GraphComponents {
 namespace ode {
@@ -32,11 +40,209 @@ StaticODESolver::StaticODESolver()
             false,
             "shoud_diverge_when_residual_is_growing",
             "Divergence criterion: The newton iterations will stop when the residual is greater than the one from the previous iteration."))
+    , d_inexact_newton(initData(&d_inexact_newton,
+            false,
+            "inexact_newton",
+            "Use an inexact newton method: the relative residual threshold of the (iterative) linear solver is set at every newton "
+            "iteration from the decrease of the newton residual (Eisenstat-Walker forcing terms). The linear system is "
+            "then solved loosely far from the equilibrium, and more and more accurately when approaching it. "
+            "The linear solver must be an iterative solver of SofaCaribou (ex. ConjugateGradientSolver)."))
+    , d_maximum_forcing_term(initData(&d_maximum_forcing_term,
+            (double) 0.1,
+            "maximum_forcing_term",
+            "Maximum relative residual threshold of the linear solver with the inexact newton method (see inexact_newton). "
+            "It is also the threshold of the first newton iteration."))
+    , d_line_search(initData(&d_line_search,
+            "line_search",
+            R"(
+            Line search method used to choose the length of the newton steps.
+                None:     Always take the full newton step (default).
+                Energy:   Backtrack along the newton direction until the total potential energy sufficiently decreases
+                          (Armijo condition). Every forcefields must implement getPotentialEnergy (ex.
+                          HyperelasticForcefield and TractionForce).
+                Residual: Backtrack along the newton direction until the norm of the residual sufficiently decreases.
+            )",
+            true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+    , d_line_search_iterations(initData(&d_line_search_iterations,
+            (unsigned int) 5,
+            "line_search_iterations",
+            "Maximum number of step length reductions of the line search at each newton iteration. The step length of "
+            "the last reduction is taken if none of them satisfy the decrease condition."))
+    , d_tangent_reuse(initData(&d_tangent_reuse,
+            (unsigned int) 0,
+            "tangent_reuse",
+            "Modified newton method: maximum number of consecutive newton iterations reusing the tangent stiffness "
+            "matrix of a previous iteration instead of rebuilding it. The forcefields implementing it (ex. "
+            "HyperelasticForcefield) keep their elements tangent stiffness, and the system matrix is not given again to "
+            "the linear solver (an assembled matrix and its factorization or preconditioner are hence reused). The "
+            "tangent is always rebuilt at the first newton iteration of a time step. "
+            "Set to 0 to rebuild the tangent stiffness at every newton iterations (full newton, default)."))
+    , d_tangent_reuse_ratio(initData(&d_tangent_reuse_ratio,
+            (double) 0.5,
+            "tangent_reuse_ratio",
+            "Modified newton method: the tangent stiffness is rebuilt before the maximum number of reuses (see "
+            "tangent_reuse) when the convergence slows down, i.e. when the ratio |R_k|/|R_k-1| between the residual "
+            "norms of the last two newton iterations is greater than this ratio."))
+    , d_adaptive_load_stepping(initData(&d_adaptive_load_stepping,
+            false,
+            "adaptive_load_stepping",
+            "Adaptive load stepping: the size of the load increments of the incremental loads (ex. TractionForce with a "
+            "slope) is driven by the newton convergence. When newton diverges (it reached its maximum number of "
+            "iterations, or the residual grew with shoud_diverge_when_residual_is_growing), the positions and loads go "
+            "back to the last equilibrium and the increment is halved, until newton converges or the maximum number of "
+            "cutbacks is reached (the time step is then cancelled). When newton converged in a few iterations, the "
+            "next increments are grown (see load_increment_growth_iterations)."))
+    , d_load_increment_growth_iterations(initData(&d_load_increment_growth_iterations,
+            (unsigned int) 5,
+            "load_increment_growth_iterations",
+            "Adaptive load stepping: the next load increments are grown when newton converged in at most this number of "
+            "iterations without any cutbacks."))
+    , d_load_increment_growth_factor(initData(&d_load_increment_growth_factor,
+            (double) 2,
+            "load_increment_growth_factor",
+            "Adaptive load stepping: factor by which the load increments are grown (up to the total load)."))
+    , d_maximum_load_cutbacks(initData(&d_maximum_load_cutbacks,
+            (unsigned int) 5,
+            "maximum_load_cutbacks",
+            "Adaptive load stepping: maximum number of times the load increment of a time step is halved."))
     , d_converged(initData(&d_converged, false, "converged", "Whether or not the last call to solve converged", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+    , d_residuals(initData(&d_residuals, "residuals", "Norm of the residual |R| at the beginning of the last call to solve, followed by its norm after each newton iteration.", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+    , d_linear_solver_iterations(initData(&d_linear_solver_iterations, "linear_solver_iterations", "Number of iterations of the (iterative) linear solver at each newton iteration of the last call to solve.", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+    , d_step_lengths(initData(&d_step_lengths, "step_lengths", "Length of the step taken along the newton direction (1 for the full newton step) at each newton iteration of the last call to solve.", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+    , d_number_of_tangent_updates(initData(&d_number_of_tangent_updates, (unsigned int) 0, "number_of_tangent_updates", "Number of times the tangent stiffness matrix was rebuilt during the last call to solve.", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+    , d_number_of_tangent_reuses(initData(&d_number_of_tangent_reuses, (unsigned int) 0, "number_of_tangent_reuses", "Number of newton iterations that reused the tangent stiffness matrix of a previous iteration (modified newton) during the last call to solve, i.e. the number of rebuilds saved.", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+    , d_number_of_load_cutbacks(initData(&d_number_of_load_cutbacks, (unsigned int) 0, "number_of_load_cutbacks", "Number of times the load increment was halved (adaptive load stepping) during the last call to solve.", true /*is_displayed_in_gui*/, true /*is_read_only*/))
+{
+    d_line_search.setValue(sofa::helper::OptionsGroup(std::vector<std::string> {"None", "Energy", "Residual"}));
+    sofa::helper::WriteAccessor<Data< sofa::helper::OptionsGroup >> line_search = d_line_search;
+    line_search->setSelectedItem((unsigned int) 0);
+}
 
-{}
+auto StaticODESolver::get_line_search() const -> LineSearch {
+    const auto & selected = d_line_search.getValue().getSelectedItem();
+    if (selected == "Energy") {
+        return LineSearch::Energy;
+    }
+    if (selected == "Residual") {
+        return LineSearch::Residual;
+    }
+    return LineSearch::None;
+}
 
 void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId /*vResult*/) {
+    sofa::helper::AdvancedTimer::stepBegin("StaticODESolver::Solve");
+
+    // Adaptive load stepping: the loads whose increments are controlled (loads applied at once are left aside)
+    std::vector<forcefield::IncrementalLoad *> loads;
+    if (d_adaptive_load_stepping.getValue()) {
+        std::vector<sofa::core::behavior::BaseForceField *> forcefields;
+        this->getContext()->getObjects<sofa::core::behavior::BaseForceField>(&forcefields, sofa::core::objectmodel::BaseContext::SearchDown);
+        for (auto * ff : forcefields) {
+            auto * load = dynamic_cast<forcefield::IncrementalLoad *>(ff);
+            if (load and load->load_increment() > 0) {
+                loads.push_back(load);
+            }
+        }
+
+        if (loads.empty()) {
+            msg_warning() << "The adaptive load stepping requires a load applied by increments (ex. a TractionForce with "
+                          << "a slope), the load increments are not controlled.";
+        }
+    }
+
+    if (loads.empty()) {
+        solve_newton(params, xResult);
+        d_number_of_load_cutbacks.setValue(0);
+    } else {
+        solve_adaptive_load_step(params, xResult, loads);
+    }
+
+    sofa::helper::AdvancedTimer::stepEnd("StaticODESolver::Solve");
+}
+
+void StaticODESolver::solve_adaptive_load_step(const sofa::core::ExecParams* params, sofa::core::MultiVecCoordId xResult, const std::vector<forcefield::IncrementalLoad *> & loads) {
+    sofa::simulation::common::VectorOperations vop( params, this->getContext() );
+    sofa::simulation::common::MechanicalOperations mop( params, this->getContext() );
+    MultiVecCoord x(&vop, xResult /*core::VecCoordId::position()*/ );
+
+    const auto & load_increment_growth_iterations = d_load_increment_growth_iterations.getValue();
+    const auto & load_increment_growth_factor = d_load_increment_growth_factor.getValue();
+    const auto & maximum_load_cutbacks = d_maximum_load_cutbacks.getValue();
+
+    // The equilibrium of the beginning of the step (positions, total displacement and loads), and the loads to reach
+    // at its end
+    x_equilibrium.realloc( &vop );
+    x_equilibrium.eq(x);
+    U.realloc( &vop, true );
+    U_equilibrium.realloc( &vop );
+    U_equilibrium.eq(U);
+    std::vector<double> start_load_factors, end_load_factors;
+    for (const auto * load : loads) {
+        start_load_factors.push_back(load->previous_load_factor());
+        end_load_factors.push_back(load->load_factor());
+    }
+
+    const auto restore_equilibrium = [&]() {
+        x.eq(x_equilibrium);
+        U.eq(U_equilibrium);
+
+        //propagate positions to mapped nodes (calls apply, applyJ)
+        sofa::core::MechanicalParams mp;
+        sofa::simulation::MechanicalPropagateOnlyPositionAndVelocityVisitor(&mp).execute(this->getContext());
+    };
+
+    solve_newton(params, xResult);
+
+    unsigned int number_of_cutbacks = 0;
+    while (not d_converged.getValue() and number_of_cutbacks < maximum_load_cutbacks) {
+        // Nothing to cut back if the load wasn't incremented during this step (ex. the total load is already reached)
+        bool load_was_incremented = false;
+        for (std::size_t i = 0; i < loads.size(); ++i) {
+            load_was_incremented = load_was_incremented or end_load_factors[i] > start_load_factors[i];
+        }
+        if (not load_was_incremented) {
+            break;
+        }
+
+        // Go back to the last equilibrium and only apply half of the increment (the next increments are halved too)
+        number_of_cutbacks++;
+        restore_equilibrium();
+        for (std::size_t i = 0; i < loads.size(); ++i) {
+            end_load_factors[i] = start_load_factors[i] + (end_load_factors[i] - start_load_factors[i]) / 2.;
+            loads[i]->set_load_factor(end_load_factors[i]);
+            loads[i]->set_load_increment(loads[i]->load_increment() / 2.);
+        }
+
+        msg_info() << "[CUTBACK] Newton diverged, the load increment is halved (cutback #" << number_of_cutbacks
+                   << " of a maximum of " << maximum_load_cutbacks << ")";
+        solve_newton(params, xResult);
+    }
+
+    // Number of newton iterations of the last attempt (the first residual is the one of the beginning of the step)
+    const auto number_of_newton_iterations = d_residuals.getValue().size() - 1;
+    if (d_converged.getValue()) {
+        if (number_of_cutbacks == 0 and number_of_newton_iterations <= load_increment_growth_iterations) {
+            for (auto * load : loads) {
+                load->set_load_increment(std::min(load->load_increment() * load_increment_growth_factor, 1.));
+            }
+            msg_info() << "Newton converged in " << number_of_newton_iterations << " iterations, the next load "
+                       << "increments are grown by a factor of " << load_increment_growth_factor;
+        }
+    } else {
+        // The step is cancelled, the next one will start again from the last equilibrium with the smallest increment
+        restore_equilibrium();
+        for (std::size_t i = 0; i < loads.size(); ++i) {
+            loads[i]->set_load_factor(start_load_factors[i]);
+        }
+        msg_warning() << "Newton diverged after " << number_of_cutbacks << " cutbacks of the load increment, the time "
+                      << "step is cancelled (the positions and loads of the last equilibrium are restored).";
+    }
+
+    d_number_of_load_cutbacks.setValue(number_of_cutbacks);
+    sofa::helper::AdvancedTimer::valSet("load_cutbacks", number_of_cutbacks);
+}
+
+void StaticODESolver::solve_newton(const sofa::core::ExecParams* params, sofa::core::MultiVecCoordId xResult) {
     sofa::simulation::common::VectorOperations vop( params, this->getContext() );
     sofa::simulation::common::MechanicalOperations mop( params, this->getContext() );
     sofa::simulation::common::VisitorExecuteFunc executeVisitor(*this->getContext());
@@ -63,8 +269,46 @@ void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/,
     const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
     bool converged = false;
     const auto & newton_iterations = d_newton_iterations.getValue();
+    sofa::helper::vector<double> residuals;
+    sofa::helper::vector<unsigned int> linear_solver_iterations;
+    sofa::helper::vector<double> step_lengths;
+
+    // Line search: backtrack from the full newton step until the Armijo condition phi(a) <= phi(0) + c a phi'(0) holds,
+    // phi being the potential energy or the norm of the residual along the newton direction
+    const auto line_search = get_line_search();
+    const auto & line_search_iterations = d_line_search_iterations.getValue();
+
+    // Modified newton: the tangent stiffness is only rebuilt periodically, or when the convergence slows down
+    const auto & tangent_reuse = d_tangent_reuse.getValue();
+    const auto & tangent_reuse_ratio = d_tangent_reuse_ratio.getValue();
+    unsigned int number_of_tangent_updates = 0, number_of_tangent_reuses = 0, number_of_consecutive_reuses = 0;
+    std::vector<forcefield::FrozenTangentStiffness *> frozen_tangent_forcefields;
+    if (tangent_reuse > 0) {
+        std::vector<sofa::core::behavior::BaseForceField *> forcefields;
+        this->getContext()->getObjects<sofa::core::behavior::BaseForceField>(&forcefields, sofa::core::objectmodel::BaseContext::SearchDown);
+        for (auto * ff : forcefields) {
+            if (auto * frozen_tangent_forcefield = dynamic_cast<forcefield::FrozenTangentStiffness *>(ff)) {
+                frozen_tangent_forcefields.push_back(frozen_tangent_forcefield);
+            }
+        }
+    }
 
-    sofa::helper::AdvancedTimer::stepBegin("StaticODESolver::Solve");
+    // Inexact newton: forcing term eta of the linear solver, |r|/|b| < eta, computed from the ratio of successive
+    // residuals with the choice 2 of Eisenstat and Walker, eta_k = gamma (|R_k| / |R_k-1|)^alpha
+    static constexpr double forcing_term_gamma = 0.9;
+    static constexpr double forcing_term_alpha = 1.618033988749895; // (1 + sqrt(5)) / 2
+    auto * linear_solver = dynamic_cast<solver::IterativeLinearSolver *>(
+        this->getContext()->get<sofa::core::behavior::LinearSolver>(sofa::core::objectmodel::BaseContext::SearchDown)
+    );
+    const bool inexact_newton = d_inexact_newton.getValue() and linear_solver;
+    if (d_inexact_newton.getValue() and not linear_solver) {
+        msg_warning() << "The inexact newton method requires an iterative linear solver of SofaCaribou (ex. "
+                      << "ConjugateGradientSolver). The linear system will be solved with the linear solver's own threshold.";
+    }
+    const auto & maximum_forcing_term = d_maximum_forcing_term.getValue();
+    double forcing_term = maximum_forcing_term;
+    double R_previous_iteration = 0; // |R| at the beginning of the previous newton iteration
+    bool diverged = false;
 
     while (n_it < newton_iterations) {
         sofa::helper::AdvancedTimer::stepBegin("NewtonStep");
@@ -91,6 +335,7 @@ void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/,
             // Compute the initial residual
             R = sqrt(force.dot(force));
             R0 = R;
+            residuals.push_back(R);
 
             if (residual_tolerance_threshold > 0 && R <= residual_tolerance_threshold) {
                 msg_info() << "The ODE has already reached an equilibrium state";
@@ -98,6 +343,12 @@ void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/,
             }
         }
 
+        // Modified newton: reuse the tangent of the previous iteration unless the maximum number of reuses is reached
+        // or the residual didn't decrease enough during the last iteration
+        const bool reuse_tangent = tangent_reuse > 0 and n_it > 0 and not converged and
+                                   number_of_consecutive_reuses < tangent_reuse and
+                                   R <= tangent_reuse_ratio * R_previous_iteration;
+
         sofa::helper::AdvancedTimer::stepBegin("MBKBuild");
         // 1. The MechanicalMatrix::K is an empty matrix that stores three floats called factors: m, b and k.
         // 2. the * operator simply multiplies each of the three factors a value. No matrix is built yet.
@@ -108,8 +359,24 @@ void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/,
         //    B. For LinearSolver using other type of matrices (FullMatrix, SparseMatrix, CompressedRowSparseMatrix),
         //       the "addMBKToMatrix" method is called on each BaseForceField objects and the "applyConstraint" method
         //       is called on every BaseProjectiveConstraintSet objects.
+        // When the tangent is reused, the linear solver keeps the system matrix it was given at the last rebuild.
         sofa::core::behavior::MultiMatrix<sofa::simulation::common::MechanicalOperations> matrix(&mop);
-        matrix = MechanicalMatrix::K * -1.0;
+        if (reuse_tangent) {
+            number_of_consecutive_reuses++;
+            number_of_tangent_reuses++;
+        } else {
+            // The forcefields will rebuild their tangent at the current positions, and keep it for the next iterations
+            for (auto * ff : frozen_tangent_forcefields) {
+                ff->set_tangent_stiffness_frozen(false);
+            }
+            matrix = MechanicalMatrix::K * -1.0;
+            for (auto * ff : frozen_tangent_forcefields) {
+                ff->set_tangent_stiffness_frozen(true);
+            }
+            number_of_consecutive_reuses = 0;
+            number_of_tangent_updates++;
+        }
+        sofa::helper::AdvancedTimer::valSet("tangent_reused", reuse_tangent ? 1 : 0);
         sofa::helper::AdvancedTimer::stepEnd("MBKBuild");
 
         if (not converged) {
@@ -118,30 +385,104 @@ void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/,
             // for LDL: solves the system, everything's already assembled
             sofa::helper::AdvancedTimer::stepBegin("MBKSolve");
 
+            // Inexact newton: the linear system only needs to be solved accurately near the equilibrium
+            if (inexact_newton) {
+                if (n_it > 0) {
+                    double eta = forcing_term_gamma * std::pow(R / R_previous_iteration, forcing_term_alpha);
+
+                    // Safeguard against a too fast decrease of the forcing term (Eisenstat and Walker)
+                    const double eta_safeguard = forcing_term_gamma * std::pow(forcing_term, forcing_term_alpha);
+                    if (eta_safeguard > 0.1) {
+                        eta = std::max(eta, eta_safeguard);
+                    }
+
+                    // Don't solve more accurately than what is needed to reach the residual threshold
+                    if (residual_tolerance_threshold > 0) {
+                        eta = std::max(eta, 0.5 * residual_tolerance_threshold * R0 / R);
+                    }
+
+                    forcing_term = std::min(eta, maximum_forcing_term);
+                }
+                linear_solver->set_residual_tolerance_threshold(static_cast<FLOATING_POINT_TYPE>(forcing_term));
+                sofa::helper::AdvancedTimer::valSet("forcing_term", forcing_term);
+            }
+            R_previous_iteration = R;
+
             // Calls methods "setSystemRHVector", "setSystemLHVector" and "solveSystem" of the LinearSolver component
             matrix.solve(dx, force);
+            if (linear_solver) {
+                linear_solver_iterations.push_back(linear_solver->number_of_iterations());
+            }
             sofa::helper::AdvancedTimer::stepEnd("MBKSolve");
 
-            // Updating the geometry
-            x.eq(x_start, dx, 1);
-
-            // Solving constraints
-            // Calls "solveConstraint" method of every ConstraintSolver objects found in the current context tree.
-            mop.solveConstraint(x, sofa::core::ConstraintParams::POS);
+            // Values at the beginning of the step needed by the line search. Since the force is minus the gradient of
+            // the potential energy, the slope of the energy along the newton direction is -f.dx
+            const double R_start = R;
+            const double energy_slope = -force.dot(dx);
+            const double energy_start = (line_search == LineSearch::Energy) ? compute_potential_energy(this->getContext()) : 0.;
+            if (line_search == LineSearch::Energy and energy_slope >= 0) {
+                msg_warning() << "The newton direction is not a descent direction of the potential energy, the full step is taken.";
+            }
 
-            //propagate positions to mapped nodes (calls apply, applyJ)
-            sofa::core::MechanicalParams mp;
-            sofa::simulation::MechanicalPropagateOnlyPositionAndVelocityVisitor(&mp).execute(this->getContext());
+            double step_length = 1;
+            double moved_length = 0; // Length of the step currently applied to the positions
+            for (unsigned int line_search_iteration = 0; ; ++line_search_iteration) {
+                // Updating the geometry
+                if (moved_length == 0) {
+                    x.eq(x_start, dx, step_length);
+                } else {
+                    x.peq(dx, step_length - moved_length);
+                }
+                moved_length = step_length;
+
+                // Solving constraints
+                // Calls "solveConstraint" method of every ConstraintSolver objects found in the current context tree.
+                mop.solveConstraint(x, sofa::core::ConstraintParams::POS);
+
+                //propagate positions to mapped nodes (calls apply, applyJ)
+                sofa::core::MechanicalParams mp;
+                sofa::simulation::MechanicalPropagateOnlyPositionAndVelocityVisitor(&mp).execute(this->getContext());
+
+                // compute addForce, in mapped: addForce + applyJT (vec)
+                sofa::helper::AdvancedTimer::stepBegin("ComputeForce");
+                force.clear();
+                mop.computeForce(force);
+                mop.projectResponse(force);
+                sofa::helper::AdvancedTimer::stepEnd("ComputeForce");
+
+                // Residual
+                R = sqrt(force.dot(force));
+
+                if (line_search == LineSearch::None or line_search_iteration >= line_search_iterations) {
+                    break;
+                }
+
+                if (line_search == LineSearch::Residual) {
+                    if (R <= (1. - sufficient_decrease * step_length) * R_start) {
+                        break;
+                    }
+                    step_length *= 0.5;
+                } else { // LineSearch::Energy
+                    if (energy_slope >= 0) {
+                        break;
+                    }
+                    const double energy = compute_potential_energy(this->getContext());
+                    if (energy_sufficiently_decreases(energy_start, energy_slope, step_length, energy)) {
+                        break;
+                    }
+                    step_length = backtracked_step_length(energy_start, energy_slope, step_length, energy);
+                }
+            }
 
-            // compute addForce, in mapped: addForce + applyJT (vec)
-            sofa::helper::AdvancedTimer::stepBegin("ComputeForce");
-            force.clear();
-            mop.computeForce(force);
-            mop.projectResponse(force);
-            sofa::helper::AdvancedTimer::stepEnd("ComputeForce");
+            if (step_length < 1) {
+                // The correction taken is the scaled newton direction
+                dx.teq(step_length);
+                msg_info() << "Line search: step length of " << step_length;
+            }
+            step_lengths.push_back(step_length);
+            sofa::helper::AdvancedTimer::valSet("step_length", step_length);
 
-            // Residual
-            R = sqrt(force.dot(force));
+            residuals.push_back(R);
 
             if (n_it == 0) {
                 R0 = R;
@@ -164,6 +505,7 @@ void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/,
         sofa::helper::AdvancedTimer::stepEnd("NewtonStep");
 
         if (not converged and shoud_diverge_when_residual_is_growing and R > Rn and n_it > 1) {
+            diverged = true;
             msg_info() << "[DIVERGED] Residual's norm increased from "<< Rn << " to " << R;
         }
 
@@ -183,7 +525,7 @@ void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/,
         // Save the last residual to check the growing residual criterion at the next step
         Rn = R;
 
-        if (converged) {
+        if (converged or diverged) {
             break;
         }
 
@@ -196,14 +538,28 @@ void StaticODESolver::solve(const sofa::core::ExecParams* params, double /*dt*/,
         msg_info() << "[DIVERGED] The number of Newton iterations reached the maximum of " << newton_iterations << " iterations";
     }
 
+    // Let the forcefields update their tangent at every addForce again
+    for (auto * ff : frozen_tangent_forcefields) {
+        ff->set_tangent_stiffness_frozen(false);
+    }
+
+    // Restore the linear solver's own threshold
+    if (inexact_newton) {
+        linear_solver->set_residual_tolerance_threshold(0);
+    }
+
     d_converged.setValue(converged);
+    d_residuals.setValue(residuals);
+    d_linear_solver_iterations.setValue(linear_solver_iterations);
+    d_step_lengths.setValue(step_lengths);
+    d_number_of_tangent_updates.setValue(number_of_tangent_updates);
+    d_number_of_tangent_reuses.setValue(number_of_tangent_reuses);
 
     sofa::helper::AdvancedTimer::valSet("has_converged", converged ? 1 : 0);
     sofa::helper::AdvancedTimer::valSet("nb_iterations", n_it+1);
     sofa::helper::AdvancedTimer::valSet("residual", Rn);
     sofa::helper::AdvancedTimer::valSet("correction", dx_norm);
     sofa::helper::AdvancedTimer::valSet("displacement", du_norm);
-    sofa::helper::AdvancedTimer::stepEnd("StaticODESolver::Solve");
 }
 
 
@@ -4,6 +4,11 @@
 #include <sofa/core/behavior/OdeSolver.h>
 #include <sofa/simulation/MechanicalMatrixVisitor.h>
 #include <sofa/core/behavior/MultiVec.h>
+#include <sofa/helper/vector.h>
+#include <sofa/helper/OptionsGroup.h>
+#include <SofaCaribou/GraphComponents/Forcefield/IncrementalLoad.h>
+
+#include <vector>
 
 namespace SofaCaribou::GraphComponents::ode {
 
@@ -15,6 +20,18 @@ public:
     SOFA_CLASS(StaticODESolver, sofa::core::behavior::OdeSolver);
     StaticODESolver();
 
+    /// Line search methods used to choose the length of the newton steps
+    enum class LineSearch : unsigned int {
+        /// Always take the full newton step (default)
+        None = 0,
+
+        /// Backtrack until the total potential energy sufficiently decreases (Armijo condition)
+        Energy = 1,
+
+        /// Backtrack until the norm of the residual sufficiently decreases
+        Residual = 2
+    };
+
 public:
     void solve (const sofa::core::ExecParams* params /* PARAMS FIRST */, double dt, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId vResult) override;
 
@@ -99,14 +116,50 @@ protected:
     /// Total displacement since the beginning of the step
     sofa::core::behavior::MultiVecDeriv U;
 
+    /// Positions at the beginning of the step, restored when its load increment is cut back
+    sofa::core::behavior::MultiVecCoord x_equilibrium;
+
+    /// Total displacement at the beginning of the step, restored with the positions
+    sofa::core::behavior::MultiVecDeriv U_equilibrium;
+
     /// INPUTS
     Data<unsigned> d_newton_iterations;
     Data<double> d_correction_tolerance_threshold;
     Data<double> d_residual_tolerance_threshold;
     Data<bool> d_shoud_diverge_when_residual_is_growing;
+    Data<bool> d_inexact_newton;
+    Data<double> d_maximum_forcing_term;
+    Data<sofa::helper::OptionsGroup> d_line_search;
+    Data<unsigned int> d_line_search_iterations;
+    Data<unsigned int> d_tangent_reuse;
+    Data<double> d_tangent_reuse_ratio;
+    Data<bool> d_adaptive_load_stepping;
+    Data<unsigned int> d_load_increment_growth_iterations;
+    Data<double> d_load_increment_growth_factor;
+    Data<unsigned int> d_maximum_load_cutbacks;
 
     /// OUTPUTS
     Data<bool> d_converged; ///< Whether or not the last call to solve converged
+    Data<sofa::helper::vector<double>> d_residuals; ///< Norm of the residual at each newton iteration of the last call to solve
+    Data<sofa::helper::vector<unsigned int>> d_linear_solver_iterations; ///< Number of iterations of the linear solver at each newton iteration of the last call to solve
+    Data<sofa::helper::vector<double>> d_step_lengths; ///< Length of the step taken at each newton iteration of the last call to solve
+    Data<unsigned int> d_number_of_tangent_updates; ///< Number of tangent stiffness rebuilds during the last call to solve
+    Data<unsigned int> d_number_of_tangent_reuses; ///< Number of newton iterations that reused the tangent stiffness during the last call to solve
+    Data<unsigned int> d_number_of_load_cutbacks; ///< Number of times the load increment was halved during the last call to solve
+
+private:
+    /// Newton iterations solving the equilibrium of the current load
+    void solve_newton(const sofa::core::ExecParams* params, sofa::core::MultiVecCoordId xResult);
+
+    /**
+     * Adaptive load stepping: solve the equilibrium of the current load increment with newton, halving the increment
+     * (from the positions and loads of the beginning of the step) every time newton diverges. The next increments are
+     * grown when newton converged in a few iterations.
+     */
+    void solve_adaptive_load_step(const sofa::core::ExecParams* params, sofa::core::MultiVecCoordId xResult, const std::vector<forcefield::IncrementalLoad *> & loads);
+
+    /// Get the line search method selected by the user
+    LineSearch get_line_search() const;
 };
 
 
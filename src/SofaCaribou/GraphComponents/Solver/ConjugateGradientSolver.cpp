@@ -1,12 +1,18 @@
 #include "ConjugateGradientSolver.h"
 #include<SofaCaribou/Algebra/EigenMatrixWrapper.h>
+#include <SofaCaribou/Algebra/BlockSparseMatrixWrapper.h>
+#include <SofaCaribou/GraphComponents/Forcefield/BlockDiagonalStiffness.h>
 #include <Caribou/macros.h>
 #include <sofa/core/ObjectFactory.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/behavior/MechanicalState.h>
+#include <sofa/defaulttype/VecTypes.h>
 #include <sofa/helper/AdvancedTimer.h>
 #include <sofa/simulation/MechanicalOperations.h>
 #include <sofa/simulation/VectorOperations.h>
 #include <SofaBaseLinearSolver/FullMatrix.h>
 #include <SofaEigen2Solver/EigenVectorWrapper.h>
+#include <functional>
 #include <iomanip>
 
 #if !EIGEN_VERSION_AT_LEAST(3,3,0)
@@ -19,6 +25,7 @@ namespace SofaCaribou::GraphComponents::solver {
 
 using Timer = sofa::helper::AdvancedTimer;
 using Algebra::EigenMatrixWrapper;
+using Algebra::BlockSparseMatrixWrapper;
 
 ConjugateGradientSolver::ConjugateGradientSolver()
 : d_maximum_number_of_iterations(initData(&d_maximum_number_of_iterations,
@@ -46,8 +53,81 @@ ConjugateGradientSolver::ConjugateGradientSolver()
 #endif
     R"(
             IncompleteLU:        Preconditioning based on the incomplete LU factorization.
+            BlockDiagonal:       Preconditioning using the inverse of the 3x3 (or 2x2) diagonal node blocks of A.
+            BlockIncompleteCholesky: Preconditioning based on the block incomplete Cholesky factorization of A.
+                                 The block preconditioners store A as a block sparse matrix of 3x3 (or 2x2) blocks.
+            GeometricMultigrid:  Preconditioning using a multigrid V-cycle on a hierarchy of regular grids. The nodes
+                                 of the mechanical state must lie on a regular grid (ex. FictitiousGrid).
+            SmoothedAggregation: Preconditioning using a smoothed aggregation algebraic multigrid V-cycle, the rigid
+                                 body modes of the rest positions being its near-nullspace (unstructured meshes).
+            NodeBlockJacobi:     Preconditioning using the inverse of the 3x3 diagonal node blocks of A, gathered
+                                 directly from the forcefields and the masses. A is never assembled and the CG
+                                 iterations stay matrix-free (as with None).
     )",
     true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_flat_vectors(initData(&d_flat_vectors,
+    false,
+    "flat_vectors",
+    "When no preconditioning method is used, gather the vectors of the mechanical objects into contiguous vectors "
+    "once per solve and do the CG vector operations directly on them. The scene graph is then only traversed for "
+    "the matrix-vector products, instead of being traversed for every dot products and vector updates."))
+, d_pipelined(initData(&d_pipelined,
+    false,
+    "pipelined",
+    "Use the pipelined conjugate gradient (Ghysels and Vanroose), which computes the dot products of an iteration "
+    "in the same pass over the vectors as their updates. The dot products are not overlapped with the "
+    "matrix-vector product, and an iteration updates 8 vectors instead of 3: it only pays off when the passes over "
+    "the vectors dominate the matrix-vector product and the preconditioner. When no preconditioning method is used, "
+    "this implies flat_vectors."))
+, d_preconditioner_reuse(initData(&d_preconditioner_reuse,
+    (unsigned int) 0,
+    "preconditioner_reuse",
+    "Number of consecutive assemblies of the system matrix (usually one per newton iteration) reusing the last "
+    "factorization of the preconditioner instead of refactorizing it. The default (0) refactorizes the "
+    "preconditioner at every assembly."))
+, d_preconditioner_reuse_ratio(initData(&d_preconditioner_reuse_ratio,
+    (FLOATING_POINT_TYPE) 0,
+    "preconditioner_reuse_ratio",
+    "When the last factorization of the preconditioner is reused, refactorize it as soon as the number of CG "
+    "iterations of a solve is greater than this ratio times the number of iterations of the first solve following "
+    "the factorization. A value of 0 disables this criterion."))
+, d_asynchronous_factorization(initData(&d_asynchronous_factorization,
+    false,
+    "asynchronous_factorization",
+    "Factorize the IncompleteCholesky, IncompleteLU and BlockIncompleteCholesky preconditioners on a background "
+    "thread. The solves keep using the current factorization until the new one is ready, in which case it "
+    "replaces the current one right before the next solve. A change of the sparsity pattern of the system "
+    "matrix is still factorized immediately."))
+, d_multigrid_smoothing_steps(initData(&d_multigrid_smoothing_steps,
+    (unsigned int) 2,
+    "multigrid_smoothing_steps",
+    "Number of Gauss-Seidel sweeps before and after the coarse grid correction of the GeometricMultigrid and "
+    "SmoothedAggregation preconditioners."))
+, d_single_precision_preconditioner(initData(&d_single_precision_preconditioner,
+    false,
+    "single_precision_preconditioner",
+    "Store and apply the factors of the Diagonal, IncompleteCholesky and IncompleteLU preconditioners in single "
+    "precision, while the CG iterations and residuals stay in double precision. This halves the memory traffic of "
+    "the preconditioner applications. For tight tolerances, use it with refinement_steps."))
+, d_refinement_steps(initData(&d_refinement_steps,
+    (unsigned int) 0,
+    "refinement_steps",
+    "Maximum number of iterative refinement steps of the preconditioned solves. At every step, the residual "
+    "r = b - Ax is recomputed from the current solution, and the correction A dx = r is solved with the relative "
+    "tolerance refinement_tolerance. The default (0) disables the iterative refinement."))
+, d_refinement_tolerance(initData(&d_refinement_tolerance,
+    (FLOATING_POINT_TYPE) 1e-3,
+    "refinement_tolerance",
+    "Relative residual threshold of the inner CG solves of the iterative refinement (see refinement_steps)."))
+, d_number_of_factorizations(initData(&d_number_of_factorizations,
+    (unsigned int) 0,
+    "number_of_factorizations",
+    "Number of factorizations of the preconditioner since the start of the simulation.",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+, d_iterations_per_solve(initData(&d_iterations_per_solve,
+    "iterations_per_solve",
+    "Number of CG iterations of every solve since the last factorization of the preconditioner.",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
 {
     // Explicitly state the available preconditioning methods
     p_preconditioners.emplace_back("None", PreconditioningMethod::None);
@@ -58,6 +138,11 @@ ConjugateGradientSolver::ConjugateGradientSolver()
     p_preconditioners.emplace_back("IncompleteCholesky", PreconditioningMethod::IncompleteCholesky);
 #endif
     p_preconditioners.emplace_back("IncompleteLU", PreconditioningMethod::IncompleteLU);
+    p_preconditioners.emplace_back("BlockDiagonal", PreconditioningMethod::BlockDiagonal);
+    p_preconditioners.emplace_back("BlockIncompleteCholesky", PreconditioningMethod::BlockIncompleteCholesky);
+    p_preconditioners.emplace_back("GeometricMultigrid", PreconditioningMethod::GeometricMultigrid);
+    p_preconditioners.emplace_back("SmoothedAggregation", PreconditioningMethod::SmoothedAggregation);
+    p_preconditioners.emplace_back("NodeBlockJacobi", PreconditioningMethod::NodeBlockJacobi);
 
     // Fill-in the data option group with the available preconditioning methods
     std::vector<std::string> preconditioner_names;
@@ -92,6 +177,110 @@ auto ConjugateGradientSolver::get_preconditioning_method_from_string(const std::
     return PreconditioningMethod::None;
 }
 
+bool ConjugateGradientSolver::preconditioner_must_be_factorized(bool pattern_has_changed) const {
+    // A new sparsity pattern has been analyzed, or the preconditioner was never factorized
+    if (pattern_has_changed or d_number_of_factorizations.getValue() == 0) {
+        return true;
+    }
+
+    // The factorization has been reused for the maximum number of assemblies
+    if (p_number_of_reuses >= d_preconditioner_reuse.getValue()) {
+        return true;
+    }
+
+    // The number of CG iterations grew too much since the first solve following the factorization
+    const auto & ratio = d_preconditioner_reuse_ratio.getValue();
+    const auto & iterations_per_solve = d_iterations_per_solve.getValue();
+    if (ratio > 0 and iterations_per_solve.size() > 1) {
+        const auto reference = std::max(iterations_per_solve.front(), 1u);
+        if (iterations_per_solve.back() > ratio*reference) {
+            msg_info() << "The number of CG iterations grew from " << iterations_per_solve.front() << " to "
+                       << iterations_per_solve.back() << ", the preconditioner is refactorized.";
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ConjugateGradientSolver::preconditioner_has_been_factorized() {
+    p_number_of_reuses = 0;
+    sofa::helper::WriteAccessor<Data<unsigned int>> number_of_factorizations = d_number_of_factorizations;
+    number_of_factorizations.wref() += 1;
+    sofa::helper::WriteAccessor<Data<sofa::helper::vector<unsigned int>>> iterations_per_solve = d_iterations_per_solve;
+    iterations_per_solve.clear();
+}
+
+auto ConjugateGradientSolver::get_block_size(const PreconditioningMethod & preconditioning_method, const Eigen::Index & n) const -> unsigned int {
+    if (preconditioning_method != PreconditioningMethod::BlockDiagonal and
+        preconditioning_method != PreconditioningMethod::BlockIncompleteCholesky) {
+        return 0;
+    }
+
+    const auto * mstate = this->getContext()->getMechanicalState();
+    const auto block_size = (mstate) ? static_cast<unsigned int>(mstate->getDerivDimension()) : 0u;
+    if ((block_size == 3 or block_size == 2) and n % block_size == 0) {
+        return block_size;
+    }
+
+    return 0;
+}
+
+auto ConjugateGradientSolver::get_scalar_preconditioning_method(const PreconditioningMethod & preconditioning_method) -> PreconditioningMethod {
+    if (preconditioning_method == PreconditioningMethod::BlockDiagonal) {
+        return PreconditioningMethod::Diagonal;
+    }
+
+    if (preconditioning_method == PreconditioningMethod::BlockIncompleteCholesky) {
+#if EIGEN_VERSION_AT_LEAST(3,3,0)
+        return PreconditioningMethod::IncompleteCholesky;
+#else
+        return PreconditioningMethod::Diagonal;
+#endif
+    }
+
+    return preconditioning_method;
+}
+
+bool ConjugateGradientSolver::initialize_multigrid(const PreconditioningMethod & preconditioning_method, const Eigen::Index & n) {
+    using Vec3Types = sofa::defaulttype::Vec3Types;
+    const auto * state = dynamic_cast<const sofa::core::behavior::MechanicalState<Vec3Types> *>(this->getContext()->getMechanicalState());
+    if (not state or 3*static_cast<Eigen::Index>(state->getSize()) != n) {
+        return false;
+    }
+
+    // The rigid body modes are computed from the rest positions of the nodes, the aggregates being built during
+    // the first factorization
+    if (preconditioning_method == PreconditioningMethod::SmoothedAggregation) {
+        p_smoothed_aggregation.set_number_of_smoothing_steps(d_multigrid_smoothing_steps.getValue());
+        p_smoothed_aggregation.set_nodes(state->readRestPositions().ref(), 3);
+        return true;
+    }
+
+    // The grid hierarchy is built from the rest positions of the nodes
+    p_multigrid.set_number_of_smoothing_steps(d_multigrid_smoothing_steps.getValue());
+    if (not p_multigrid.set_nodes(state->readRestPositions().ref(), 3)) {
+        return false;
+    }
+
+    msg_info() << "Geometric multigrid of " << p_multigrid.number_of_levels() << " levels (" << n << " to "
+               << p_multigrid.size_of_level(p_multigrid.number_of_levels()-1) << " degrees of freedom).";
+    return true;
+}
+
+auto ConjugateGradientSolver::gather_diagonal_node_blocks(const Eigen::Index & n, bool verbose) const -> std::vector<NodeBlock, Eigen::aligned_allocator<NodeBlock>> {
+    std::vector<NodeBlock, Eigen::aligned_allocator<NodeBlock>> blocks (static_cast<std::size_t>(n/3), NodeBlock::Zero());
+    const auto ignored = forcefield::add_diagonal_node_blocks(this->getContext(), p_accessor, p_mechanical_params, blocks);
+    if (verbose) {
+        for (const auto * forcefield : ignored) {
+            msg_warning() << "The component '" << forcefield->getPathName() << "' doesn't give the diagonal node "
+                          << "blocks of its matrix, it is ignored by the NodeBlockJacobi preconditioner.";
+        }
+    }
+
+    return blocks;
+}
+
 void ConjugateGradientSolver::setSystemMBKMatrix(const sofa::core::MechanicalParams* mparams) {
     Timer::stepBegin("ConjugateGradient::ComputeGlobalMatrix");
     // Save the current mechanical parameters (m, b and k factors of the mass (M), damping (B) and
@@ -99,7 +288,7 @@ void ConjugateGradientSolver::setSystemMBKMatrix(const sofa::core::MechanicalPar
     p_mechanical_params = mparams;
 
     // Get the preconditioning method
-    const PreconditioningMethod preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
+    PreconditioningMethod preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
 
     // If we have a preconditioning method, the global system matrix has to be constructed from the current context subgraph.
     if (preconditioning_method != PreconditioningMethod::None) {
@@ -124,78 +313,295 @@ void ConjugateGradientSolver::setSystemMBKMatrix(const sofa::core::MechanicalPar
         p_accessor.setupMatrices();
         Timer::stepEnd("SetupMatrixIndices");
 
-        Timer::stepBegin("Clear");
-        p_A.resize(n, n);
-        EigenMatrixWrapper<SparseMatrix &> wrapper (p_A);
-        p_accessor.setGlobalMatrix(&wrapper);
-        Timer::stepEnd("Clear");
-
-        Timer::stepEnd("PrepareMatrix");
-
-        Timer::stepBegin("BuildMatrix");
-        // Step 2. Building stage
-        //         Here we go down on the current context sub-graph and call :
-        //           1. ff->addMBKToMatrix(&K) for every force field "ff" found.
-        //           2. pc->applyConstraint(&K) for every BaseProjectiveConstraintSet "pc" found.
-        //         If a mechanical mapping "m" is found during the traversal, and m->areMatricesMapped() is false, the
-        //         traversal stops in the subgraph of the mapping.
-        Timer::stepBegin("TopLevelMatrices");
-        mops.addMBK_ToMatrix(&p_accessor, p_mechanical_params->mFactor(), p_mechanical_params->bFactor(), p_mechanical_params->kFactor());
-        Timer::stepEnd("TopLevelMatrices");
-        // Step 3. Mechanical mappings
-        //         In case we have mapped matrices, which is, system matrix of a slave mechanical object, accumulate its
-        //         contribution to the global system matrix with:
-        //           [A]ij += Jt * [A']ij * J
-        //         where A is the master mechanical object's matrix, A' is the slave mechanical object matrix and J=m.getJ()
-        //         is the mapping relation between the slave and its master.
-        Timer::stepBegin("MappedMatrices");
-        p_accessor.computeGlobalMatrix();
-        Timer::stepEnd("MappedMatrices");
-
-        // Step 4. Convert the system matrix to a compressed sparse matrix
-        Timer::stepBegin("ConvertToSparse");
-        wrapper.compress();
-        Timer::stepEnd("ConvertToSparse");
-        Timer::stepEnd("BuildMatrix");
-
-        // Step 5. Let the preconditioner analyse the matrix
-        if (matrix_shape_has_changed) {
-            Timer::stepBegin("PreconditionerAnalysis");
-            if (preconditioning_method == PreconditioningMethod::Identity) {
-                p_identity.analyzePattern(p_A);
-            } else if (preconditioning_method == PreconditioningMethod::Diagonal) {
-                p_diag.analyzePattern(p_A);
+        // Node block Jacobi: only the diagonal node blocks are gathered, the system matrix is never assembled. The
+        // global vectors are sized to the system by the matrix-free solve, which tells us if the system has changed.
+        if (preconditioning_method == PreconditioningMethod::NodeBlockJacobi) {
+            Timer::stepEnd("PrepareMatrix");
+            matrix_shape_has_changed = (n != p_x.size());
+            if (n % 3 != 0) {
+                if (matrix_shape_has_changed) {
+                    msg_warning() << "The NodeBlockJacobi preconditioner requires mechanical states having 3 degrees "
+                                  << "of freedom per node. No preconditioner will be used instead.";
+                }
+            } else if (not preconditioner_must_be_factorized(matrix_shape_has_changed or p_node_block_jacobi.rows() != n)) {
+                ++p_number_of_reuses;
+            } else {
+                Timer::stepBegin("GatherDiagonalBlocks");
+                const auto blocks = gather_diagonal_node_blocks(n, matrix_shape_has_changed);
+                Timer::stepEnd("GatherDiagonalBlocks");
+
+                Timer::stepBegin("PreconditionerFactorization");
+                p_node_block_jacobi.factorize(blocks);
+                Timer::stepEnd("PreconditionerFactorization");
+                preconditioner_has_been_factorized();
+            }
+
+            Timer::stepEnd("ConjugateGradient::ComputeGlobalMatrix");
+            return;
+        }
+
+        // Block preconditioners: the system matrix is assembled by blocks of 3x3 (or 2x2) entries
+        const auto assemble_block_system = [&](auto & system) {
+            using BlockMatrix = std::decay_t<decltype(system.A)>;
+            matrix_shape_has_changed = (n != system.A.rows());
+
+            Timer::stepBegin("Clear");
+            BlockSparseMatrixWrapper<BlockMatrix &> wrapper (system.A);
+            wrapper.set_pattern_locked(true);
+            wrapper.resize(n, n);
+            p_accessor.setGlobalMatrix(&wrapper);
+            Timer::stepEnd("Clear");
+
+            Timer::stepEnd("PrepareMatrix");
+
+            Timer::stepBegin("BuildMatrix");
+            Timer::stepBegin("TopLevelMatrices");
+            mops.addMBK_ToMatrix(&p_accessor, p_mechanical_params->mFactor(), p_mechanical_params->bFactor(), p_mechanical_params->kFactor());
+            Timer::stepEnd("TopLevelMatrices");
+
+            Timer::stepBegin("MappedMatrices");
+            p_accessor.computeGlobalMatrix();
+            Timer::stepEnd("MappedMatrices");
+
+            Timer::stepBegin("ConvertToSparse");
+            wrapper.compress();
+            Timer::stepEnd("ConvertToSparse");
+            Timer::stepEnd("BuildMatrix");
+
+            const bool pattern_has_changed = matrix_shape_has_changed or wrapper.pattern_has_changed();
+            if (pattern_has_changed) {
+                Timer::stepBegin("PreconditionerAnalysis");
+                if (preconditioning_method == PreconditioningMethod::BlockDiagonal) {
+                    system.diagonal.analyzePattern(system.A);
+                } else {
+                    system.incomplete_cholesky.analyzePattern(system.A);
+                }
+                Timer::stepEnd("PreconditionerAnalysis");
+            }
+
+            const bool asynchronous = d_asynchronous_factorization.getValue() and not pattern_has_changed and
+                                      preconditioning_method == PreconditioningMethod::BlockIncompleteCholesky;
+            if (not preconditioner_must_be_factorized(pattern_has_changed)) {
+                ++p_number_of_reuses;
+            } else if (asynchronous) {
+                // Keep solving with the current factorization while the new one is computed in the background
+                if (not system.incomplete_cholesky.running()) {
+                    Timer::stepBegin("PreconditionerFactorizationStart");
+                    system.incomplete_cholesky.start_factorization(system.A);
+                    Timer::stepEnd("PreconditionerFactorizationStart");
+                }
+                ++p_number_of_reuses;
+            } else {
+                Timer::stepBegin("PreconditionerFactorization");
+                if (preconditioning_method == PreconditioningMethod::BlockDiagonal) {
+                    system.diagonal.factorize(system.A);
+                } else {
+                    system.incomplete_cholesky.factorize(system.A);
+                    if (system.incomplete_cholesky.info() != Eigen::Success) {
+                        msg_warning() << "The block incomplete Cholesky factorization failed.";
+                    }
+                }
+                Timer::stepEnd("PreconditionerFactorization");
+                preconditioner_has_been_factorized();
+            }
+
+            p_accessor.setGlobalMatrix(nullptr);
+        };
+
+        p_block_size = get_block_size(preconditioning_method, n);
+        if (p_block_size == 3) {
+            assemble_block_system(p_block_system_3);
+        } else if (p_block_size == 2) {
+            assemble_block_system(p_block_system_2);
+        } else {
+            // The block preconditioners fall back to their scalar version when the matrix cannot be stored by blocks
+            const auto scalar_preconditioning_method = get_scalar_preconditioning_method(preconditioning_method);
+            if (scalar_preconditioning_method != preconditioning_method and matrix_shape_has_changed) {
+                msg_warning() << "The '" << d_preconditioning_method.getValue().getSelectedItem() << "' preconditioner "
+                              << "requires a mechanical state having 2 or 3 degrees of freedom per node. Its scalar "
+                              << "version will be used instead.";
+            }
+            preconditioning_method = scalar_preconditioning_method;
+
+            // The multigrid preconditioners fall back to the diagonal preconditioner when they cannot be initialized
+            // from the nodes (for the geometric multigrid, when the nodes aren't on a regular grid)
+            if (preconditioning_method == PreconditioningMethod::GeometricMultigrid or
+                preconditioning_method == PreconditioningMethod::SmoothedAggregation) {
+                if (matrix_shape_has_changed) {
+                    p_multigrid_is_ready = initialize_multigrid(preconditioning_method, n);
+                    if (not p_multigrid_is_ready) {
+                        msg_warning() << "The '" << d_preconditioning_method.getValue().getSelectedItem() << "' "
+                                      << "preconditioner requires a single mechanical state with 3 degrees of freedom "
+                                      << "per node" << (preconditioning_method == PreconditioningMethod::GeometricMultigrid ? ", the nodes lying on a regular grid" : "")
+                                      << ". The Diagonal preconditioner will be used instead.";
+                    }
+                }
+                if (not p_multigrid_is_ready) {
+                    preconditioning_method = PreconditioningMethod::Diagonal;
+                }
+            }
+
+            // The Diagonal, IncompleteCholesky and IncompleteLU preconditioners can be stored in single precision
+            const bool single_precision = d_single_precision_preconditioner.getValue();
+
+            Timer::stepBegin("Clear");
+            // The sparsity pattern of the previous assembly is kept, the entries are accumulated directly into it
+            // (the pattern is only rebuilt if a new nonzero entry appears).
+            EigenMatrixWrapper<SparseMatrix &> wrapper (p_A);
+            wrapper.set_pattern_locked(true);
+            wrapper.resize(n, n);
+            p_accessor.setGlobalMatrix(&wrapper);
+            Timer::stepEnd("Clear");
+
+            Timer::stepEnd("PrepareMatrix");
+
+            Timer::stepBegin("BuildMatrix");
+            // Step 2. Building stage
+            //         Here we go down on the current context sub-graph and call :
+            //           1. ff->addMBKToMatrix(&K) for every force field "ff" found.
+            //           2. pc->applyConstraint(&K) for every BaseProjectiveConstraintSet "pc" found.
+            //         If a mechanical mapping "m" is found during the traversal, and m->areMatricesMapped() is false, the
+            //         traversal stops in the subgraph of the mapping.
+            Timer::stepBegin("TopLevelMatrices");
+            mops.addMBK_ToMatrix(&p_accessor, p_mechanical_params->mFactor(), p_mechanical_params->bFactor(), p_mechanical_params->kFactor());
+            Timer::stepEnd("TopLevelMatrices");
+            // Step 3. Mechanical mappings
+            //         In case we have mapped matrices, which is, system matrix of a slave mechanical object, accumulate its
+            //         contribution to the global system matrix with:
+            //           [A]ij += Jt * [A']ij * J
+            //         where A is the master mechanical object's matrix, A' is the slave mechanical object matrix and J=m.getJ()
+            //         is the mapping relation between the slave and its master.
+            Timer::stepBegin("MappedMatrices");
+            p_accessor.computeGlobalMatrix();
+            Timer::stepEnd("MappedMatrices");
+
+            // Step 4. Convert the system matrix to a compressed sparse matrix
+            Timer::stepBegin("ConvertToSparse");
+            wrapper.compress();
+            Timer::stepEnd("ConvertToSparse");
+            Timer::stepEnd("BuildMatrix");
+
+            // Step 5. Let the preconditioner analyse the matrix
+            const bool pattern_has_changed = matrix_shape_has_changed or wrapper.pattern_has_changed();
+            if (pattern_has_changed) {
+                Timer::stepBegin("PreconditionerAnalysis");
+                if (preconditioning_method == PreconditioningMethod::Identity) {
+                    p_identity.analyzePattern(p_A);
+                } else if (preconditioning_method == PreconditioningMethod::Diagonal) {
+                    if (single_precision) {
+                        p_diag_single.analyzePattern(p_A);
+                    } else {
+                        p_diag.analyzePattern(p_A);
+                    }
 #if EIGEN_VERSION_AT_LEAST(3,3,0)
-            } else if (preconditioning_method == PreconditioningMethod::LeastSquareDiagonal) {
-                p_ls_diag.analyzePattern(p_A);
-            } else if (preconditioning_method == PreconditioningMethod::IncompleteCholesky) {
-                p_ichol.analyzePattern(p_A);
+                } else if (preconditioning_method == PreconditioningMethod::LeastSquareDiagonal) {
+                    p_ls_diag.analyzePattern(p_A);
+                } else if (preconditioning_method == PreconditioningMethod::IncompleteCholesky) {
+                    if (single_precision) {
+                        p_ichol_single.analyzePattern(p_A);
+                    } else {
+                        p_ichol.analyzePattern(p_A);
+                    }
 #endif
-            } else if (preconditioning_method == PreconditioningMethod::IncompleteLU) {
-                p_iLU.analyzePattern(p_A);
+                } else if (preconditioning_method == PreconditioningMethod::IncompleteLU) {
+                    if (single_precision) {
+                        p_iLU_single.analyzePattern(p_A);
+                    } else {
+                        p_iLU.analyzePattern(p_A);
+                    }
+                } else if (preconditioning_method == PreconditioningMethod::GeometricMultigrid) {
+                    p_multigrid.analyzePattern(p_A);
+                } else if (preconditioning_method == PreconditioningMethod::SmoothedAggregation) {
+                    p_smoothed_aggregation.analyzePattern(p_A);
+                }
+                Timer::stepEnd("PreconditionerAnalysis");
             }
-            Timer::stepEnd("PreconditionerAnalysis");
-        }
 
-        // Step 5. Factorize the preconditioner
-        Timer::stepBegin("PreconditionerFactorization");
-        if (preconditioning_method == PreconditioningMethod::Identity) {
-            p_identity.factorize(p_A);
-        } else if (preconditioning_method == PreconditioningMethod::Diagonal) {
-            p_diag.factorize(p_A);
+            // Step 6. Factorize the preconditioner, unless its last factorization can be reused
+            const bool asynchronous = d_asynchronous_factorization.getValue() and not pattern_has_changed and (
 #if EIGEN_VERSION_AT_LEAST(3,3,0)
-        } else if (preconditioning_method == PreconditioningMethod::LeastSquareDiagonal) {
-            p_ls_diag.factorize(p_A);
-        } else if (preconditioning_method == PreconditioningMethod::IncompleteCholesky) {
-            p_ichol.factorize(p_A);
+                                      preconditioning_method == PreconditioningMethod::IncompleteCholesky or
 #endif
-        } else if (preconditioning_method == PreconditioningMethod::IncompleteLU) {
-            p_iLU.factorize(p_A);
-        }
-        Timer::stepEnd("PreconditionerFactorization");
+                                      preconditioning_method == PreconditioningMethod::IncompleteLU);
+            if (not preconditioner_must_be_factorized(pattern_has_changed)) {
+                ++p_number_of_reuses;
+            } else if (asynchronous) {
+                // Keep solving with the current factorization while the new one is computed in the background
+                Timer::stepBegin("PreconditionerFactorizationStart");
+                const auto start_factorization = [this](auto & preconditioner) {
+                    if (not preconditioner.running()) {
+                        preconditioner.start_factorization(p_A);
+                    }
+                };
+#if EIGEN_VERSION_AT_LEAST(3,3,0)
+                if (preconditioning_method == PreconditioningMethod::IncompleteCholesky) {
+                    if (single_precision) {
+                        start_factorization(p_ichol_single);
+                    } else {
+                        start_factorization(p_ichol);
+                    }
+                }
+#endif
+                if (preconditioning_method == PreconditioningMethod::IncompleteLU) {
+                    if (single_precision) {
+                        start_factorization(p_iLU_single);
+                    } else {
+                        start_factorization(p_iLU);
+                    }
+                }
+                Timer::stepEnd("PreconditionerFactorizationStart");
+                ++p_number_of_reuses;
+            } else {
+                Timer::stepBegin("PreconditionerFactorization");
+                if (preconditioning_method == PreconditioningMethod::Identity) {
+                    p_identity.factorize(p_A);
+                } else if (preconditioning_method == PreconditioningMethod::Diagonal) {
+                    if (single_precision) {
+                        p_diag_single.factorize(p_A);
+                    } else {
+                        p_diag.factorize(p_A);
+                    }
+#if EIGEN_VERSION_AT_LEAST(3,3,0)
+                } else if (preconditioning_method == PreconditioningMethod::LeastSquareDiagonal) {
+                    p_ls_diag.factorize(p_A);
+                } else if (preconditioning_method == PreconditioningMethod::IncompleteCholesky) {
+                    if (single_precision) {
+                        p_ichol_single.factorize(p_A);
+                    } else {
+                        p_ichol.factorize(p_A);
+                    }
+#endif
+                } else if (preconditioning_method == PreconditioningMethod::IncompleteLU) {
+                    if (single_precision) {
+                        p_iLU_single.factorize(p_A);
+                    } else {
+                        p_iLU.factorize(p_A);
+                    }
+                } else if (preconditioning_method == PreconditioningMethod::GeometricMultigrid) {
+                    p_multigrid.factorize(p_A);
+                    if (p_multigrid.info() != Eigen::Success) {
+                        msg_warning() << "The factorization of the coarsest level of the multigrid failed.";
+                    }
+                } else if (preconditioning_method == PreconditioningMethod::SmoothedAggregation) {
+                    // The aggregates are only rebuilt after a change of the sparsity pattern
+                    const auto number_of_aggregations = p_smoothed_aggregation.number_of_aggregations();
+                    p_smoothed_aggregation.factorize(p_A);
+                    if (p_smoothed_aggregation.number_of_aggregations() != number_of_aggregations) {
+                        const auto nb_levels = p_smoothed_aggregation.number_of_levels();
+                        msg_info() << "Smoothed aggregation multigrid of " << nb_levels << " levels (" << n << " to "
+                                   << p_smoothed_aggregation.size_of_level(nb_levels-1) << " degrees of freedom).";
+                    }
+                    if (p_smoothed_aggregation.info() != Eigen::Success) {
+                        msg_warning() << "The factorization of the coarsest level of the multigrid failed.";
+                    }
+                }
+                Timer::stepEnd("PreconditionerFactorization");
+                preconditioner_has_been_factorized();
+            }
 
-        // Remove the global matrix from the accessor since the wrapper was temporary
-        p_accessor.setGlobalMatrix(nullptr);
+            // Remove the global matrix from the accessor since the wrapper was temporary
+            p_accessor.setGlobalMatrix(nullptr);
+        }
     }
 
     Timer::stepEnd("ConjugateGradient::ComputeGlobalMatrix");
@@ -211,8 +617,9 @@ void ConjugateGradientSolver::setSystemRHVector(sofa::core::MultiVecDerivId b_id
     const PreconditioningMethod preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
 
     // If we have a preconditioning method, we copy the vectors of the mechanical objects into a global eigen vector.
-    if (preconditioning_method != PreconditioningMethod::None) {
-        p_b.resize(p_A.rows());
+    // The matrix-free solves (None and NodeBlockJacobi) gather it themselves.
+    if (preconditioning_method != PreconditioningMethod::None and preconditioning_method != PreconditioningMethod::NodeBlockJacobi) {
+        p_b.resize(static_cast<Eigen::Index>(p_accessor.getGlobalDimension()));
         EigenVectorWrapper<FLOATING_POINT_TYPE> b(p_b);
         mop.multiVector2BaseVector(p_b_id, &b, &p_accessor);
     }
@@ -230,8 +637,9 @@ void ConjugateGradientSolver::setSystemLHVector(sofa::core::MultiVecDerivId x_id
     const PreconditioningMethod preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
 
     // If we have a preconditioning method, we copy the vectors of the mechanical objects into a global eigen vector.
-    if (preconditioning_method != PreconditioningMethod::None) {
-        p_x.resize(p_A.rows());
+    // The matrix-free solves (None and NodeBlockJacobi) gather it themselves.
+    if (preconditioning_method != PreconditioningMethod::None and preconditioning_method != PreconditioningMethod::NodeBlockJacobi) {
+        p_x.resize(static_cast<Eigen::Index>(p_accessor.getGlobalDimension()));
         EigenVectorWrapper<FLOATING_POINT_TYPE> x(p_x);
         mop.multiVector2BaseVector(p_x_id, &x, &p_accessor);
     }
@@ -250,7 +658,7 @@ void ConjugateGradientSolver::solve(MultiVecDeriv & b, MultiVecDeriv & x) {
 
     // Get the method parameters
     const auto & maximum_number_of_iterations = d_maximum_number_of_iterations.getValue();
-    const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
+    const auto residual_tolerance_threshold = this->residual_tolerance_threshold();
 
     // Get the matrices coefficient m, b and k : A = (mM + bB + kK)
     const auto  m_coef = p_mechanical_params->mFactor();
@@ -262,6 +670,7 @@ void ConjugateGradientSolver::solve(MultiVecDeriv & b, MultiVecDeriv & x) {
     FLOATING_POINT_TYPE rho0, rho1; // Stores r*r as it is used two times per iterations
     FLOATING_POINT_TYPE alpha, beta; // Alpha and Beta coefficients
     UNSIGNED_INTEGER_TYPE iteration_number = 0; // Current iteration number
+    p_squared_residuals.clear();
 
     // Make sure that the right hand side isn't zero
     b_norm = b.norm();
@@ -308,6 +717,7 @@ void ConjugateGradientSolver::solve(MultiVecDeriv & b, MultiVecDeriv & x) {
         // 3. Computes the new residual norm
         rho1 = r.dot(r);
         r_norm = sqrt(rho1);
+        p_squared_residuals.push_back(rho1);
 
         // 4. Print information on the current iteration
         msg_info() << "CG iteration #" << iteration_number+1
@@ -332,14 +742,371 @@ void ConjugateGradientSolver::solve(MultiVecDeriv & b, MultiVecDeriv & x) {
     }
 
     end:
+    p_number_of_iterations = iteration_number;
+    sofa::helper::AdvancedTimer::valSet("nb_iterations", iteration_number);
+}
+
+void ConjugateGradientSolver::solve_with_flat_vectors(MultiVecDeriv & b, MultiVecDeriv & x) {
+    sofa::simulation::common::VectorOperations vop( p_mechanical_params, this->getContext() );
+    sofa::simulation::common::MechanicalOperations mop( p_mechanical_params, this->getContext() );
+
+    // Temporary vectors of the mechanical objects, only used for the matrix-vector product
+    MultiVecDeriv dx(&vop);
+    MultiVecDeriv df(&vop);
+
+    // Get the method parameters
+    const auto & maximum_number_of_iterations = d_maximum_number_of_iterations.getValue();
+    const auto residual_tolerance_threshold = this->residual_tolerance_threshold();
+
+    // Get the matrices coefficient m, b and k : A = (mM + bB + kK)
+    const auto  m_coef = p_mechanical_params->mFactor();
+    const auto  b_coef = p_mechanical_params->bFactor();
+    const auto  k_coef = p_mechanical_params->kFactor();
+
+    p_squared_residuals.clear();
+
+    // Gather the vectors b and x of the mechanical objects into the global vectors p_b and p_x
+    Timer::stepBegin("GatherVectors");
+    p_accessor.clear();
+    mop.getMatrixDimension(nullptr, nullptr, &p_accessor);
+    p_accessor.setupMatrices();
+    const auto n = static_cast<Eigen::Index>(p_accessor.getGlobalDimension());
+    p_b.resize(n);
+    p_x.resize(n);
+    {
+        EigenVectorWrapper<FLOATING_POINT_TYPE> b_wrapper(p_b);
+        EigenVectorWrapper<FLOATING_POINT_TYPE> x_wrapper(p_x);
+        mop.multiVector2BaseVector(b.id(), &b_wrapper, &p_accessor);
+        mop.multiVector2BaseVector(x.id(), &x_wrapper, &p_accessor);
+    }
+    Timer::stepEnd("GatherVectors");
+
+    // Computes q = A*v by going down in the graph (v is scattered into the mechanical objects, and A*v is gathered back)
+    const auto A = [&](Vector & v, Vector & q) {
+        EigenVectorWrapper<FLOATING_POINT_TYPE> v_wrapper(v);
+        EigenVectorWrapper<FLOATING_POINT_TYPE> q_wrapper(q);
+        mop.baseVector2MultiVector(&v_wrapper, dx.id(), &p_accessor);
+        mop.propagateDxAndResetDf(dx, df); // Set df = 0 and calls applyJ(dx) on every mechanical mappings
+        mop.addMBKdx(df, m_coef, b_coef, k_coef, false); // df = (m M + b B + k K) dx
+        mop.projectResponse(df); // BaseProjectiveConstraintSet::projectResponse(df)
+        mop.multiVector2BaseVector(df.id(), &q_wrapper, &p_accessor);
+    };
+
+    const auto preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
+    if (preconditioning_method == PreconditioningMethod::NodeBlockJacobi and p_node_block_jacobi.rows() == n) {
+        // Matrix-free operator and node block Jacobi preconditioner, in the form expected by the preconditioned CG
+        struct MatrixFreeOperator {
+            std::function<void(Vector &, Vector &)> product;
+            Eigen::Index n;
+            Eigen::Index cols() const { return n; }
+            Vector operator*(const Vector & v) const {
+                Vector copy = v, q(n);
+                product(copy, q);
+                return q;
+            }
+        };
+
+        // The preconditioned residual is projected in the constrained space, as is the product A*v
+        struct ProjectedPreconditioner {
+            const Algebra::BlockDiagonalPreconditioner<FLOATING_POINT_TYPE, 3> & preconditioner;
+            std::function<void(Vector &)> project;
+            Vector solve(const Vector & r) const {
+                Vector z = preconditioner.solve(r);
+                project(z);
+                return z;
+            }
+        };
+
+        const auto project = [&](Vector & v) {
+            EigenVectorWrapper<FLOATING_POINT_TYPE> v_wrapper(v);
+            mop.baseVector2MultiVector(&v_wrapper, dx.id(), &p_accessor);
+            mop.projectResponse(dx); // BaseProjectiveConstraintSet::projectResponse(dx)
+            mop.multiVector2BaseVector(dx.id(), &v_wrapper, &p_accessor);
+        };
+
+        solve(ProjectedPreconditioner {p_node_block_jacobi, project}, MatrixFreeOperator {A, n}, p_b, p_x);
+    } else if (d_pipelined.getValue()) {
+        solve_pipelined(A, p_identity, p_b, p_x, residual_tolerance_threshold);
+    } else {
+        // Declare the method variables
+        FLOATING_POINT_TYPE b_norm, r_norm; // Residual norm
+        FLOATING_POINT_TYPE rho0, rho1; // Stores r*r as it is used two times per iterations
+        FLOATING_POINT_TYPE alpha, beta; // Alpha and Beta coefficients
+        UNSIGNED_INTEGER_TYPE iteration_number = 0; // Current iteration number
+        Vector r(n), p(n), q(n);
+
+        // Make sure that the right hand side isn't zero
+        b_norm = p_b.norm();
+        if (IN_OPEN_INTERVAL(-EPSILON, b_norm, EPSILON)) {
+            msg_info() << "Right-hand side of the system is zero, hence x = 0.";
+            x.clear();
+            p_number_of_iterations = iteration_number;
+            sofa::helper::AdvancedTimer::valSet("nb_iterations", iteration_number);
+            return;
+        }
+
+        // INITIAL RESIDUAL r = b - A*x
+        A(p_x, q);
+        r = p_b - q;
+
+        // Check for initial convergence: |r0|/|b| < threshold
+        rho0 = r.dot(r);
+        r_norm = sqrt(rho0);
+        if (r_norm < residual_tolerance_threshold*b_norm) {
+            msg_info() << "The linear system has already reached an equilibrium state";
+            msg_info() << "|R| = " << r_norm << ", |b| = " << b_norm << ", threshold = " << residual_tolerance_threshold;
+            p_number_of_iterations = iteration_number;
+            sofa::helper::AdvancedTimer::valSet("nb_iterations", iteration_number);
+            return;
+        }
+
+        // ITERATIONS
+        p = r; // p(0) = r(0)
+        while (iteration_number < maximum_number_of_iterations) {
+            Timer::stepBegin("cg_iteration");
+            // 1. Computes q(k+1) = A*p(k)
+            A(p, q);
+
+            // 2. Computes x(k+1) and r(k+1)
+            alpha = rho0 / p.dot(q);
+            p_x.noalias() += alpha*p;
+            r.noalias() -= alpha*q;
+
+            // 3. Computes the new residual norm
+            rho1 = r.dot(r);
+            r_norm = sqrt(rho1);
+            p_squared_residuals.push_back(rho1);
+
+            // 4. Print information on the current iteration
+            msg_info() << "CG iteration #" << iteration_number+1
+                       << ": |r0|/|b| = "  << r_norm/b_norm
+                       << ", threshold = " << residual_tolerance_threshold;
+
+            // 5. Check for convergence: |r|/|b| < threshold
+            if (r_norm< residual_tolerance_threshold*b_norm) {
+                Timer::stepEnd("cg_iteration");
+                msg_info() << "CG converged!";
+                ++iteration_number; // For the Timer value 'nb_iterations'
+                break;
+            }
+
+            // 6. Compute p(k+1)
+            beta = rho1 / rho0;
+            p = r + beta*p;
+
+            rho0 = rho1;
+            ++iteration_number;
+            Timer::stepEnd("cg_iteration");
+        }
+
+        p_number_of_iterations = iteration_number;
+
+        sofa::helper::AdvancedTimer::valSet("nb_iterations", iteration_number);
+    }
+
+    // Scatter the solution back into the mechanical objects
+    Timer::stepBegin("ScatterSolution");
+    EigenVectorWrapper<FLOATING_POINT_TYPE> x_wrapper(p_x);
+    mop.baseVector2MultiVector(&x_wrapper, x.id(), &p_accessor);
+    Timer::stepEnd("ScatterSolution");
+}
+
+template <typename Operator, typename Preconditioner>
+void ConjugateGradientSolver::solve_pipelined(const Operator & A, const Preconditioner & precond, const Vector & b, Vector & x, const FLOATING_POINT_TYPE & residual_tolerance_threshold) {
+    // Number of iterations between two replacements of the recursive residual by the true residual
+    static constexpr UNSIGNED_INTEGER_TYPE residual_replacement_period = 50;
+
+    // Get the method parameters
+    const auto & maximum_number_of_iterations = d_maximum_number_of_iterations.getValue();
+    const auto n = b.size();
+
+    // Declare the method variables
+    FLOATING_POINT_TYPE b_norm_2; // RHS norm
+    FLOATING_POINT_TYPE gamma = 0, gamma_previous = 0; // r.u of the current and previous iterations
+    FLOATING_POINT_TYPE delta = 0; // w.u
+    FLOATING_POINT_TYPE rho = 0; // r.r
+    FLOATING_POINT_TYPE alpha = 0, alpha_previous = 0, beta = 0; // Alpha and Beta coefficients
+    FLOATING_POINT_TYPE threshold; // Residual threshold
+    UNSIGNED_INTEGER_TYPE iteration_number = 0; // Current iteration number
+
+    // Residual r, preconditioned residual u = M^-1 r and w = A u
+    Vector r(n), u(n), w(n);
+    // m = M^-1 w and Am = A m, computed at the start of every iterations
+    Vector m(n), Am(n);
+    // Search direction p, with s = A p, q = M^-1 s and z = A q
+    Vector p = Vector::Zero(n), s = Vector::Zero(n), q = Vector::Zero(n), z = Vector::Zero(n);
+
+    // Replace the recursive residual (and the vectors computed from it) by the true residual
+    const auto replace_residual = [&](bool with_search_direction) {
+        A(x, w);
+        r = b - w;
+        u = precond.solve(r);
+        A(u, w);
+        if (with_search_direction) {
+            A(p, s);
+            q = precond.solve(s);
+            A(q, z);
+        }
+    };
+
+    // The three dot products of an iteration, in a single fused reduction
+    const auto reduce = [&]() {
+        FLOATING_POINT_TYPE r_u = 0, w_u = 0, r_r = 0;
+#pragma omp parallel for reduction(+:r_u,w_u,r_r) schedule(static)
+        for (Eigen::Index i = 0; i < n; ++i) {
+            r_u += r[i]*u[i];
+            w_u += w[i]*u[i];
+            r_r += r[i]*r[i];
+        }
+        gamma = r_u;
+        delta = w_u;
+        rho = r_r;
+    };
+
+    // Make sure that the right hand side isn't zero
+    b_norm_2 = b.squaredNorm();
+    if (b_norm_2 < EPSILON) {
+        msg_info() << "Right-hand side of the system is zero, hence x = 0.";
+        x.setZero();
+        p_number_of_iterations = iteration_number;
+        sofa::helper::AdvancedTimer::valSet("nb_iterations", iteration_number);
+        return;
+    }
+
+    // Compute the tolerance w.r.t |b| since |r|/|b| < threshold is equivalent to  r^2 < b^2 * threshold^2
+    threshold = residual_tolerance_threshold*residual_tolerance_threshold*b_norm_2;
+
+    // INITIAL RESIDUAL
+    replace_residual(false);
+    reduce();
+
+    // Check for initial convergence
+    if (rho < threshold) {
+        msg_info() << "The linear system has already reached an equilibrium state";
+        msg_info() << "|r0|/|b| = " << sqrt(rho/b_norm_2) << ", threshold = " << residual_tolerance_threshold;
+        p_number_of_iterations = iteration_number;
+        sofa::helper::AdvancedTimer::valSet("nb_iterations", iteration_number);
+        return;
+    }
+
+    // ITERATIONS
+    while (iteration_number < maximum_number_of_iterations) {
+        Timer::stepBegin("cg_iteration");
+        // 1. Computes m = M^-1 w and Am = A m (these do not depend on the dot products of the iteration)
+        m = precond.solve(w);
+        A(m, Am);
+
+        // 2. Computes the step lengths
+        if (iteration_number > 0) {
+            beta = gamma / gamma_previous;
+            alpha = gamma / (delta - beta*gamma/alpha_previous);
+        } else {
+            beta = 0;
+            alpha = gamma / delta;
+        }
+
+        // 3. Updates the search direction, the solution and the residual, and computes the dot products of the next
+        //    iteration while the updated values are still in cache, in a single pass over the vectors
+        gamma_previous = gamma;
+        alpha_previous = alpha;
+        FLOATING_POINT_TYPE r_u = 0, w_u = 0, r_r = 0;
+#pragma omp parallel for reduction(+:r_u,w_u,r_r) schedule(static)
+        for (Eigen::Index i = 0; i < n; ++i) {
+            z[i] = Am[i] + beta*z[i];
+            q[i] = m[i] + beta*q[i];
+            s[i] = w[i] + beta*s[i];
+            p[i] = u[i] + beta*p[i];
+            x[i] += alpha*p[i];
+            r[i] -= alpha*s[i];
+            u[i] -= alpha*q[i];
+            w[i] -= alpha*z[i];
+            r_u += r[i]*u[i];
+            w_u += w[i]*u[i];
+            r_r += r[i]*r[i];
+        }
+        gamma = r_u;
+        delta = w_u;
+        rho = r_r;
+
+        // 4. Periodically replace the recursive residual to avoid the loss of accuracy
+        if ((iteration_number+1) % residual_replacement_period == 0) {
+            replace_residual(true);
+            reduce();
+        }
+
+        // 5. Print information on the current iteration
+        p_squared_residuals.push_back(rho);
+        msg_info()  << "Pipelined CG iteration #" << iteration_number+1
+                    << ": |r0|/|b| = "  << sqrt(rho/b_norm_2)
+                    << ", threshold = " << residual_tolerance_threshold;
+
+        // 6. Check for convergence: |r|/|b| < threshold, confirmed with the true residual
+        if (rho < threshold) {
+            replace_residual(true);
+            reduce();
+            if (rho < threshold) {
+                Timer::stepEnd("cg_iteration");
+                msg_info() << "CG converged!";
+                ++iteration_number; // For the Timer value 'nb_iterations'
+                break;
+            }
+        }
+
+        ++iteration_number;
+        Timer::stepEnd("cg_iteration");
+    }
+
+    p_number_of_iterations = iteration_number;
+
     sofa::helper::AdvancedTimer::valSet("nb_iterations", iteration_number);
 }
 
 template <typename Matrix, typename Preconditioner>
 void ConjugateGradientSolver::solve(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x) {
+    p_squared_residuals.clear();
+    const auto & refinement_steps = d_refinement_steps.getValue();
+    const auto residual_tolerance_threshold = this->residual_tolerance_threshold();
+    if (refinement_steps == 0) {
+        solve_preconditioned(precond, A, b, x, residual_tolerance_threshold);
+        return;
+    }
+
+    // ITERATIVE REFINEMENT
+    // The residual is recomputed from the current solution at every step, and only the correction A dx = r is
+    // solved by the CG, with a looser tolerance (but never looser than the one needed to reach the threshold).
+    const auto & refinement_tolerance = d_refinement_tolerance.getValue();
+    const FLOATING_POINT_TYPE b_norm = b.norm();
+    UNSIGNED_INTEGER_TYPE number_of_iterations = 0;
+    Vector r, dx(b.size());
+    for (unsigned int step = 0; step < refinement_steps; ++step) {
+        r = b - A*x;
+        const FLOATING_POINT_TYPE r_norm = r.norm();
+        msg_info() << "Iterative refinement step #" << step+1
+                   << ": |r|/|b| = "  << ((b_norm > 0) ? r_norm/b_norm : r_norm)
+                   << ", threshold = " << residual_tolerance_threshold;
+        if (r_norm <= residual_tolerance_threshold*b_norm) {
+            break;
+        }
+
+        dx.setZero();
+        solve_preconditioned(precond, A, r, dx, std::max(refinement_tolerance, residual_tolerance_threshold*b_norm/r_norm));
+        x += dx;
+        number_of_iterations += p_number_of_iterations;
+    }
+
+    p_number_of_iterations = number_of_iterations;
+    sofa::helper::AdvancedTimer::valSet("nb_iterations", number_of_iterations);
+}
+
+template <typename Matrix, typename Preconditioner>
+void ConjugateGradientSolver::solve_preconditioned(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x, const FLOATING_POINT_TYPE & residual_tolerance_threshold) {
+    if (d_pipelined.getValue()) {
+        solve_pipelined([&A](const Vector & v, Vector & q) { q = A*v; }, precond, b, x, residual_tolerance_threshold);
+        return;
+    }
+
     // Get the method parameters
     const auto & maximum_number_of_iterations = d_maximum_number_of_iterations.getValue();
-    const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
     const auto zero = (std::numeric_limits<FLOATING_POINT_TYPE>::min)();
 
     // Declare the method variables
@@ -396,6 +1163,7 @@ void ConjugateGradientSolver::solve(const Preconditioner & precond, const Matrix
 
         // 3. Computes the new residual norm
         rho1 = r.dot(r);
+        p_squared_residuals.push_back(rho1);
 
         // 4. Print information on the current iteration
         msg_info()  << "CG iteration #" << iteration_number+1
@@ -422,6 +1190,7 @@ void ConjugateGradientSolver::solve(const Preconditioner & precond, const Matrix
     }
 
     end:
+    p_number_of_iterations = iteration_number;
     sofa::helper::AdvancedTimer::valSet("nb_iterations", iteration_number);
 }
 
@@ -434,31 +1203,90 @@ void ConjugateGradientSolver::solveSystem() {
     MultiVecDeriv b(&vop, p_b_id);
 
     // Get the preconditioning method
-    const PreconditioningMethod preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
+    PreconditioningMethod preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
 
 
     Timer::stepBegin("ConjugateGradient::solve");
     if (preconditioning_method == PreconditioningMethod::None) {
         // Solve without having filled the global matrix A (not needed since no preconditioning)
-        solve(b, x);
+        if (d_flat_vectors.getValue() or d_pipelined.getValue()) {
+            solve_with_flat_vectors(b, x);
+        } else {
+            solve(b, x);
+        }
+    } else if (preconditioning_method == PreconditioningMethod::NodeBlockJacobi) {
+        // Solve without having filled the global matrix A, only its diagonal node blocks were gathered
+        solve_with_flat_vectors(b, x);
+
+        // Keep track of the number of iterations for the preconditioner reuse policy
+        sofa::helper::WriteAccessor<Data<sofa::helper::vector<unsigned int>>> iterations_per_solve = d_iterations_per_solve;
+        iterations_per_solve.push_back(static_cast<unsigned int>(p_number_of_iterations));
     } else {
         // Solve using a preconditioning method. Here the global matrix A and the vectors x and b have been built
         // previously during the calls to setSystemMBKMatrix, setSystemLHVector and setSystemRHVector, respectively.
 
-        if (preconditioning_method == PreconditioningMethod::Identity) {
-            solve(p_identity, p_A, p_b, p_x);
-        } else if (preconditioning_method == PreconditioningMethod::Diagonal) {
-            solve(p_diag, p_A, p_b, p_x);
+        // Swap in the preconditioner factorized in the background (if any) once it is ready
+        const auto swap_asynchronous_factorization = [&](auto & preconditioner) {
+            if (preconditioner.swap_if_ready()) {
+                msg_info() << "The preconditioner factorized in the background is now used.";
+                preconditioner_has_been_factorized();
+            }
+        };
+
+        const auto solve_block_system = [&](auto & system) {
+            if (preconditioning_method == PreconditioningMethod::BlockDiagonal) {
+                solve(system.diagonal, system.A, p_b, p_x);
+            } else {
+                swap_asynchronous_factorization(system.incomplete_cholesky);
+                solve(system.incomplete_cholesky, system.A, p_b, p_x);
+            }
+        };
+
+        if (p_block_size == 3) {
+            solve_block_system(p_block_system_3);
+        } else if (p_block_size == 2) {
+            solve_block_system(p_block_system_2);
+        } else {
+            const bool single_precision = d_single_precision_preconditioner.getValue();
+            preconditioning_method = get_scalar_preconditioning_method(preconditioning_method);
+            if ((preconditioning_method == PreconditioningMethod::GeometricMultigrid or
+                 preconditioning_method == PreconditioningMethod::SmoothedAggregation) and not p_multigrid_is_ready) {
+                preconditioning_method = PreconditioningMethod::Diagonal;
+            }
+
+            if (preconditioning_method == PreconditioningMethod::Identity) {
+                solve(p_identity, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::Diagonal and single_precision) {
+                solve(p_diag_single, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::Diagonal) {
+                solve(p_diag, p_A, p_b, p_x);
 #if EIGEN_VERSION_AT_LEAST(3,3,0)
-        } else if (preconditioning_method == PreconditioningMethod::LeastSquareDiagonal) {
-            solve(p_ls_diag, p_A, p_b, p_x);
-        } else if (preconditioning_method == PreconditioningMethod::IncompleteCholesky) {
-            solve(p_ichol, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::LeastSquareDiagonal) {
+                solve(p_ls_diag, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::IncompleteCholesky and single_precision) {
+                swap_asynchronous_factorization(p_ichol_single);
+                solve(p_ichol_single, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::IncompleteCholesky) {
+                swap_asynchronous_factorization(p_ichol);
+                solve(p_ichol, p_A, p_b, p_x);
 #endif
-        } else if (preconditioning_method == PreconditioningMethod::IncompleteLU) {
-            solve(p_iLU, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::IncompleteLU and single_precision) {
+                swap_asynchronous_factorization(p_iLU_single);
+                solve(p_iLU_single, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::IncompleteLU) {
+                swap_asynchronous_factorization(p_iLU);
+                solve(p_iLU, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::GeometricMultigrid) {
+                solve(p_multigrid, p_A, p_b, p_x);
+            } else if (preconditioning_method == PreconditioningMethod::SmoothedAggregation) {
+                solve(p_smoothed_aggregation, p_A, p_b, p_x);
+            }
         }
 
+        // Keep track of the number of iterations for the preconditioner reuse policy
+        sofa::helper::WriteAccessor<Data<sofa::helper::vector<unsigned int>>> iterations_per_solve = d_iterations_per_solve;
+        iterations_per_solve.push_back(static_cast<unsigned int>(p_number_of_iterations));
+
         // Copy the solution into the mechanical objects of the current context sub-graph.
         EigenVectorWrapper<FLOATING_POINT_TYPE> x_wrapper(p_x);
         mop.baseVector2MultiVector(&x_wrapper, p_x_id, &p_accessor);
@@ -467,6 +1295,10 @@ void ConjugateGradientSolver::solveSystem() {
     Timer::stepEnd("ConjugateGradient::solve");
 }
 
+// The preconditioned solves with the diagonal preconditioners can also be called on a given matrix (see the unit tests)
+template void ConjugateGradientSolver::solve(const Eigen::DiagonalPreconditioner<FLOATING_POINT_TYPE> &, const SparseMatrix &, const Vector &, Vector &);
+template void ConjugateGradientSolver::solve(const Algebra::SinglePrecisionPreconditioner<Eigen::DiagonalPreconditioner<float>> &, const SparseMatrix &, const Vector &, Vector &);
+
 int CGLinearSolverClass = sofa::core::RegisterObject("Linear system solver using the conjugate gradient iterative algorithm")
                               .add< ConjugateGradientSolver>(true);
 
@@ -20,6 +20,15 @@
 
 #include <Eigen/IterativeLinearSolvers>
 
+#include <SofaCaribou/Algebra/BlockSparseMatrix.h>
+#include <SofaCaribou/Algebra/BlockDiagonalPreconditioner.h>
+#include <SofaCaribou/Algebra/BlockIncompleteCholesky.h>
+#include <SofaCaribou/Algebra/AsynchronousPreconditioner.h>
+#include <SofaCaribou/Algebra/GeometricMultigridPreconditioner.h>
+#include <SofaCaribou/Algebra/SmoothedAggregationPreconditioner.h>
+#include <SofaCaribou/Algebra/SinglePrecisionPreconditioner.h>
+#include <SofaCaribou/GraphComponents/Solver/IterativeLinearSolver.h>
+
 namespace SofaCaribou::GraphComponents::solver {
 
 using sofa::core::objectmodel::Data;
@@ -40,8 +49,20 @@ using namespace sofa::core::behavior;
  * to factorize it. In this case, the complete system matrix A and dense vector b are first
  * accumulated from the mechanical objects of the current scene context graph. Once the dense
  * vector x is found, it is propagated back to the mechanical object's vectors.
+ *
+ * The block preconditioners (BlockDiagonal and BlockIncompleteCholesky) assemble the system matrix as a block
+ * sparse matrix of 3x3 (or 2x2) blocks, one block per pair of coupled nodes, instead of a scalar sparse matrix.
+ * The matrix-vector products of the CG iterations are then done block by block.
+ *
+ * The NodeBlockJacobi preconditioner keeps the CG matrix-free: the 3x3 diagonal node blocks of A are gathered
+ * directly from the forcefields (see forcefield::BlockDiagonalStiffness) and the masses, without assembling A.
+ *
+ * The Diagonal, IncompleteCholesky and IncompleteLU preconditioners can be stored and applied in single precision
+ * (see single_precision_preconditioner) while the CG iterations stay in double precision. The solve can also be
+ * wrapped in an iterative refinement loop (see refinement_steps), where the residual is recomputed from the
+ * current solution at every outer step and the correction is solved with a looser tolerance.
  */
-class ConjugateGradientSolver : public LinearSolver {
+class ConjugateGradientSolver : public LinearSolver, public IterativeLinearSolver {
 
 public:
     SOFA_CLASS(ConjugateGradientSolver, LinearSolver);
@@ -68,7 +89,23 @@ public:
 #endif
 
         /// Preconditioning based on the incomplete LU factorization.
-        IncompleteLU = 5
+        IncompleteLU = 5,
+
+        /// Preconditioning using the inverse of the diagonal node blocks of A (stored as a block sparse matrix).
+        BlockDiagonal = 6,
+
+        /// Preconditioning based on the block incomplete Cholesky factorization of A (stored as a block sparse matrix).
+        BlockIncompleteCholesky = 7,
+
+        /// Preconditioning using a multigrid V-cycle on the hierarchy of the regular grid holding the nodes.
+        GeometricMultigrid = 8,
+
+        /// Preconditioning using a smoothed aggregation algebraic multigrid V-cycle (rigid body modes as near-nullspace).
+        SmoothedAggregation = 9,
+
+        /// Preconditioning using the inverse of the 3x3 diagonal node blocks of A, gathered from the forcefields
+        /// without assembling A (the CG stays matrix-free).
+        NodeBlockJacobi = 10
     };
 
     /**
@@ -87,7 +124,10 @@ public:
      * required by the Conjugate Gradient algorithm. Only the coefficients m, b and k are stored.
      *
      * When using a preconditioner, the complete system A is accumulated into a sparse matrix, and the
-     * preconditioner factorize this resulting matrix for later use during the solve step.
+     * preconditioner factorize this resulting matrix for later use during the solve step. The last factorization
+     * of the preconditioner can be reused for a few assemblies (see preconditioner_reuse and
+     * preconditioner_reuse_ratio), in which case only the matrix A is updated. With asynchronous_factorization,
+     * the new factorization is computed on a background thread and the current one is used until it is ready.
      *
      * @param mparams Contains the coefficients m, b and k of the matrices M, B and K
      */
@@ -113,6 +153,49 @@ public:
      */
     void solveSystem() final;
 
+    /**
+     * Set the relative residual threshold |r|/|b| of the next solves, in place of residual_tolerance_threshold. A
+     * negative or null threshold restores residual_tolerance_threshold.
+     */
+    void set_residual_tolerance_threshold(const FLOATING_POINT_TYPE & threshold) final {
+        p_residual_tolerance_threshold = threshold;
+    }
+
+    /** Relative residual threshold |r|/|b| used by the next solves */
+    auto residual_tolerance_threshold() const -> FLOATING_POINT_TYPE final {
+        return (p_residual_tolerance_threshold > 0) ? p_residual_tolerance_threshold : d_residual_tolerance_threshold.getValue();
+    }
+
+    /** Number of CG iterations of the last solve */
+    auto number_of_iterations() const -> unsigned int final {
+        return static_cast<unsigned int>(p_number_of_iterations);
+    }
+
+    /**
+     * Squared norms |r|^2 of the residual at every CG iteration of the last solve. With the iterative refinement,
+     * the residuals of the inner solves (r - A dx, an estimate of the residual of the complete system) are appended
+     * one after the other.
+     */
+    auto squared_residuals() const -> const std::vector<FLOATING_POINT_TYPE> & {
+        return p_squared_residuals;
+    }
+
+    /**
+     * Solve the linear system Ax = b using a preconditioner, within an iterative refinement loop when
+     * refinement_steps is greater than zero. Outside of the solver, it is only instantiated for the sparse matrix
+     * type and the (double or single precision) diagonal preconditioners.
+     *
+     * @tparam Matrix The type of the matrix A, can be a dense or a sparse matrix.
+     * @tparam Preconditioner The type of the preconditioner.
+     *
+     * @param precond The preconditioner
+     * @param A The system matrix as an Eigen matrix
+     * @param b The right-hand side vector of the system
+     * @param x The solution vector of the system. It should be filled with an initial guess or the previous solution.
+     */
+    template <typename Matrix, typename Preconditioner>
+    void solve(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x);
+
 protected:
     /// Constructor
     ConjugateGradientSolver();
@@ -132,23 +215,73 @@ protected:
     void solve(MultiVecDeriv & b, MultiVecDeriv & x);
 
     /**
-     * Solve the linear system Ax = b using a preconditioner.
+     * Solve the linear system Ax = b using Sofa's graph scene only for the matrix-vector products.
      *
-     * @tparam Derived The type of the matrix A, can be a dense or a sparse matrix.
-     * @tparam Preconditioner The type of the preconditioner.
+     * As with solve(b, x), the matrix A is never built. However, the vectors b and x are gathered once from the
+     * mechanical objects into contiguous Eigen vectors, and every vector operations of the CG iterations (dot products
+     * and vector updates) are done directly on these Eigen vectors. The scene graph is only traversed to compute the
+     * product Ap, p being scattered into the mechanical objects and Ap gathered back at every iterations.
      *
-     * @param precond The preconditioner (must be a
+     * @param b The right-hand side vector of the system
+     * @param x The solution vector of the system. It should be filled with an initial guess or the previous solution.
+     */
+    void solve_with_flat_vectors(MultiVecDeriv & b, MultiVecDeriv & x);
+
+    /**
+     * Solve the linear system Ax = b using the preconditioned conjugate gradient until |r|/|b| < threshold.
+     *
+     * @param precond The preconditioner
      * @param A The system matrix as an Eigen matrix
      * @param b The right-hand side vector of the system
      * @param x The solution vector of the system. It should be filled with an initial guess or the previous solution.
+     * @param residual_tolerance_threshold The convergence threshold on the relative residual |r|/|b|
      */
     template <typename Matrix, typename Preconditioner>
-    void solve(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x);
+    void solve_preconditioned(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x, const FLOATING_POINT_TYPE & residual_tolerance_threshold);
+
+    /**
+     * Solve the linear system Ax = b using the pipelined preconditioned conjugate gradient of Ghysels and Vanroose.
+     *
+     * The recurrences of the classic CG are rewritten such that the three dot products of an iteration (r.u, w.u and
+     * r.r) only depend on vectors available at the end of the previous iteration. They are hence computed in the same
+     * pass over the vectors as the vector updates of the previous iteration, instead of three separate reductions.
+     * On shared memory, there is no non-blocking reduction to overlap with the matrix-vector product: the gain only
+     * comes from the fewer passes over the vectors. The price is one more preconditioner application and
+     * matrix-vector product at the start, 8 vector updates per iteration instead of 3, and more vectors to store.
+     *
+     * Since the residual is only updated by recurrence, it slowly drifts from the true residual b - Ax. The residual
+     * (and the auxiliary vectors) are hence periodically replaced by their true value, and the convergence is always
+     * confirmed with the true residual.
+     *
+     * @tparam Operator Callable computing q = A*v with the signature (Vector & v, Vector & q).
+     * @tparam Preconditioner The type of the preconditioner.
+     *
+     * @param A The operator computing the matrix-vector product
+     * @param precond The preconditioner
+     * @param b The right-hand side vector of the system
+     * @param x The solution vector of the system. It should be filled with an initial guess or the previous solution.
+     * @param residual_tolerance_threshold The convergence threshold on the relative residual |r|/|b|
+     */
+    template <typename Operator, typename Preconditioner>
+    void solve_pipelined(const Operator & A, const Preconditioner & precond, const Vector & b, Vector & x, const FLOATING_POINT_TYPE & residual_tolerance_threshold);
 
     /// INPUTS
     Data<unsigned int> d_maximum_number_of_iterations;
     Data<FLOATING_POINT_TYPE> d_residual_tolerance_threshold;
     Data< sofa::helper::OptionsGroup > d_preconditioning_method;
+    Data<bool> d_flat_vectors;
+    Data<bool> d_pipelined;
+    Data<unsigned int> d_preconditioner_reuse;
+    Data<FLOATING_POINT_TYPE> d_preconditioner_reuse_ratio;
+    Data<bool> d_asynchronous_factorization;
+    Data<unsigned int> d_multigrid_smoothing_steps;
+    Data<bool> d_single_precision_preconditioner;
+    Data<unsigned int> d_refinement_steps;
+    Data<FLOATING_POINT_TYPE> d_refinement_tolerance;
+
+    /// OUTPUTS
+    Data<unsigned int> d_number_of_factorizations;
+    Data<sofa::helper::vector<unsigned int>> d_iterations_per_solve;
 
 private:
     /// Private methods
@@ -157,6 +290,66 @@ private:
      */
     PreconditioningMethod get_preconditioning_method_from_string(const std::string & preconditioner_name) const;
 
+    /**
+     * @brief Get the block size (3 or 2) of the system matrix for the block preconditioning methods, or 0 if the
+     *        mechanical state of the current context doesn't have 2 or 3 degrees of freedom per node.
+     */
+    unsigned int get_block_size(const PreconditioningMethod & preconditioning_method, const Eigen::Index & n) const;
+
+    /**
+     * @brief Get the scalar preconditioning method used in place of a block preconditioning method when the
+     *        system matrix cannot be stored by blocks.
+     */
+    static PreconditioningMethod get_scalar_preconditioning_method(const PreconditioningMethod & preconditioning_method);
+
+    /**
+     * @brief Initialize the multigrid preconditioner from the rest positions of the mechanical state: the grid
+     *        hierarchy of the geometric multigrid, or the near-nullspace (rigid body modes) of the smoothed
+     *        aggregation multigrid.
+     *
+     * @return False if the system doesn't come from a single mechanical state of 3D nodes (lying on a regular grid
+     *         for the geometric multigrid).
+     */
+    bool initialize_multigrid(const PreconditioningMethod & preconditioning_method, const Eigen::Index & n);
+
+    /// 3x3 diagonal node block of the system matrix
+    using NodeBlock = Algebra::BlockDiagonalPreconditioner<FLOATING_POINT_TYPE, 3>::Block;
+
+    /**
+     * @brief Gather the 3x3 diagonal node blocks of the system matrix A = (mM + bB + kK) from the masses and the
+     *        forcefields of the current context sub-graph, without assembling A.
+     *
+     * The stiffness blocks are given by the forcefields implementing forcefield::BlockDiagonalStiffness, and the mass
+     * blocks by the element mass of the nodes. The other forcefields, the damping and the mapped mechanical states
+     * are ignored.
+     *
+     * @param n The size of the system (three times the number of nodes)
+     * @param verbose Whether or not a warning is printed for each ignored component
+     */
+    auto gather_diagonal_node_blocks(const Eigen::Index & n, bool verbose) const -> std::vector<NodeBlock, Eigen::aligned_allocator<NodeBlock>>;
+
+    /**
+     * @brief Whether or not the preconditioner must be factorized with the newly assembled system matrix, or if its
+     *        last factorization can be reused (see preconditioner_reuse and preconditioner_reuse_ratio).
+     *
+     * @param pattern_has_changed Whether or not the sparsity pattern of the system matrix has changed, in which case
+     *                            the preconditioner is always factorized.
+     */
+    bool preconditioner_must_be_factorized(bool pattern_has_changed) const;
+
+    /**
+     * @brief Reset the reuse counters after a factorization of the preconditioner.
+     */
+    void preconditioner_has_been_factorized();
+
+    /// Global system matrix of BlockSize x BlockSize blocks, with its block preconditioners
+    template <int BlockSize>
+    struct BlockSystem {
+        Algebra::BlockSparseMatrix<FLOATING_POINT_TYPE, BlockSize> A;
+        Algebra::BlockDiagonalPreconditioner<FLOATING_POINT_TYPE, BlockSize> diagonal;
+        Algebra::AsynchronousPreconditioner<Algebra::BlockIncompleteCholesky<FLOATING_POINT_TYPE, BlockSize>> incomplete_cholesky;
+    };
+
     /// Private members
     ///< The mechanical parameters containing the m, b and k coefficients.
     const sofa::core::MechanicalParams * p_mechanical_params;
@@ -189,12 +382,56 @@ private:
     ///< Least-Square Diagonal preconditioner
     Eigen::LeastSquareDiagonalPreconditioner<FLOATING_POINT_TYPE> p_ls_diag;
 
-    ///< Incomplete Cholesky preconditioner
-    Eigen::IncompleteCholesky<FLOATING_POINT_TYPE> p_ichol;
+    ///< Incomplete Cholesky preconditioner (can be factorized in the background)
+    Algebra::AsynchronousPreconditioner<Eigen::IncompleteCholesky<FLOATING_POINT_TYPE>> p_ichol;
 #endif
 
-    ///< Incomplete LU preconditioner
-    Eigen::IncompleteLUT<FLOATING_POINT_TYPE> p_iLU;
+    ///< Incomplete LU preconditioner (can be factorized in the background)
+    Algebra::AsynchronousPreconditioner<Eigen::IncompleteLUT<FLOATING_POINT_TYPE>> p_iLU;
+
+    ///< Diagonal preconditioner stored in single precision
+    Algebra::SinglePrecisionPreconditioner<Eigen::DiagonalPreconditioner<float>> p_diag_single;
+
+#if EIGEN_VERSION_AT_LEAST(3,3,0)
+    ///< Incomplete Cholesky preconditioner stored in single precision (can be factorized in the background)
+    Algebra::AsynchronousPreconditioner<Algebra::SinglePrecisionPreconditioner<Eigen::IncompleteCholesky<float>>> p_ichol_single;
+#endif
+
+    ///< Incomplete LU preconditioner stored in single precision (can be factorized in the background)
+    Algebra::AsynchronousPreconditioner<Algebra::SinglePrecisionPreconditioner<Eigen::IncompleteLUT<float>>> p_iLU_single;
+
+    ///< Geometric multigrid preconditioner
+    Algebra::GeometricMultigridPreconditioner<FLOATING_POINT_TYPE> p_multigrid;
+
+    ///< Smoothed aggregation algebraic multigrid preconditioner
+    Algebra::SmoothedAggregationPreconditioner<FLOATING_POINT_TYPE> p_smoothed_aggregation;
+
+    ///< Node block Jacobi preconditioner of the matrix-free CG (factorized from the blocks given by the forcefields)
+    Algebra::BlockDiagonalPreconditioner<FLOATING_POINT_TYPE, 3> p_node_block_jacobi;
+
+    ///< Whether or not the selected multigrid preconditioner could be initialized from the mechanical state
+    bool p_multigrid_is_ready = false;
+
+    ///< Global system matrix of 3x3 blocks (only built by the block preconditioning methods)
+    BlockSystem<3> p_block_system_3;
+
+    ///< Global system matrix of 2x2 blocks (only built by the block preconditioning methods)
+    BlockSystem<2> p_block_system_2;
+
+    ///< Block size of the assembled global system matrix (0 if it is assembled in the scalar sparse matrix p_A)
+    unsigned int p_block_size = 0;
+
+    ///< Number of assemblies of the system matrix that reused the last factorization of the preconditioner
+    unsigned int p_number_of_reuses = 0;
+
+    ///< Number of CG iterations of the last solve
+    UNSIGNED_INTEGER_TYPE p_number_of_iterations = 0;
+
+    ///< Squared residual norms of the CG iterations of the last solve
+    std::vector<FLOATING_POINT_TYPE> p_squared_residuals;
+
+    ///< Relative residual threshold set by another component (see set_residual_tolerance_threshold), 0 if unset
+    FLOATING_POINT_TYPE p_residual_tolerance_threshold = 0;
 
     ///< Contains the list of available preconditioners with their respective identifier
     std::vector<std::pair<std::string, PreconditioningMethod>> p_preconditioners;
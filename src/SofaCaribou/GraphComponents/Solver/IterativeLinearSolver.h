@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Caribou/config.h>
+
+namespace SofaCaribou::GraphComponents::solver {
+
+/**
+ * Interface of the iterative linear solvers whose convergence threshold can be driven by another component.
+ *
+ * This is used by the inexact newton method of the StaticODESolver (see its inexact_newton option), which sets the
+ * relative residual threshold of the linear solver at every newton iteration (the forcing term) from the decrease
+ * of the newton residual.
+ */
+class IterativeLinearSolver {
+public:
+    virtual ~IterativeLinearSolver() = default;
+
+    /**
+     * Set the relative residual threshold |r|/|b| of the next solves, in place of the one given by the user. A
+     * negative or null threshold restores the one given by the user.
+     */
+    virtual void set_residual_tolerance_threshold(const FLOATING_POINT_TYPE & threshold) = 0;
+
+    /** Relative residual threshold |r|/|b| used by the next solves */
+    virtual auto residual_tolerance_threshold() const -> FLOATING_POINT_TYPE = 0;
+
+    /** Number of iterations of the last solve */
+    virtual auto number_of_iterations() const -> unsigned int = 0;
+};
+
+} // namespace SofaCaribou::GraphComponents::solver
@@ -0,0 +1,219 @@
+#include "LDLTSolver.h"
+#include <SofaCaribou/Algebra/EigenMatrixWrapper.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <SofaEigen2Solver/EigenVectorWrapper.h>
+
+namespace SofaCaribou::GraphComponents::solver {
+
+using Timer = sofa::helper::AdvancedTimer;
+using Algebra::EigenMatrixWrapper;
+
+LDLTSolver::LDLTSolver()
+: d_backend(initData(&d_backend,
+    "backend",
+    R"(
+        Backends of the factorization are:
+            Eigen:   Eigen's simplicial LDL^T factorization. (default)
+            Pardiso: Supernodal LDL^T factorization of Intel MKL's Pardiso (only available when SofaCaribou is
+                     compiled with MKL).
+            Cholmod: Supernodal LL^T factorization of SuiteSparse's CHOLMOD (only available when SofaCaribou is
+                     compiled with CHOLMOD). The system matrix must be positive definite.
+    )",
+    true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_number_of_symbolic_analyses(initData(&d_number_of_symbolic_analyses,
+    (unsigned int) 0,
+    "number_of_symbolic_analyses",
+    "Number of symbolic analyses (fill-reducing ordering and sparsity pattern of the factor) of the system matrix "
+    "since the start of the simulation. The analysis is only redone when the sparsity pattern of the system matrix "
+    "changes.",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+, d_number_of_factorizations(initData(&d_number_of_factorizations,
+    (unsigned int) 0,
+    "number_of_factorizations",
+    "Number of numeric factorizations of the system matrix since the start of the simulation.",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+{
+    std::vector<std::string> backend_names = {"Eigen"};
+#ifdef CARIBOU_WITH_MKL
+    backend_names.emplace_back("Pardiso");
+#endif
+#ifdef CARIBOU_WITH_CHOLMOD
+    backend_names.emplace_back("Cholmod");
+#endif
+    d_backend.setValue(sofa::helper::OptionsGroup(backend_names));
+    sofa::helper::WriteAccessor<Data< sofa::helper::OptionsGroup >> backend = d_backend;
+    backend->setSelectedItem((unsigned int) 0);
+}
+
+auto LDLTSolver::get_backend() const -> Backend {
+#ifdef CARIBOU_WITH_MKL
+    if (d_backend.getValue().getSelectedItem() == "Pardiso") {
+        return Backend::Pardiso;
+    }
+#endif
+#ifdef CARIBOU_WITH_CHOLMOD
+    if (d_backend.getValue().getSelectedItem() == "Cholmod") {
+        return Backend::Cholmod;
+    }
+#endif
+    return Backend::Eigen;
+}
+
+void LDLTSolver::init() {
+    if (get_backend() != Backend::Eigen) {
+        return;
+    }
+
+#if defined(CARIBOU_WITH_MKL) or defined(CARIBOU_WITH_CHOLMOD)
+    msg_info() << "The LDL^T factorization uses Eigen's simplicial backend, which is slow on large 3D meshes. "
+               << "A supernodal backend is available, see the 'backend' parameter.";
+#else
+    msg_info() << "The LDL^T factorization uses Eigen's simplicial backend, which is slow on large 3D meshes. "
+               << "Compile SofaCaribou with MKL (CARIBOU_WITH_EIGEN_MKL) or CHOLMOD (CARIBOU_WITH_CHOLMOD) to "
+               << "use a supernodal backend.";
+#endif
+}
+
+void LDLTSolver::setSystemMBKMatrix(const sofa::core::MechanicalParams* mparams) {
+    Timer::stepBegin("LDLTSolver::ComputeGlobalMatrix");
+    // Save the current mechanical parameters (m, b and k factors of the mass (M), damping (B) and
+    // stiffness (K) matrices)
+    p_mechanical_params = mparams;
+
+    // Step 1. Preparation stage
+    //         Gather the top-level mechanical objects and get the size of global system matrix.
+    Timer::stepBegin("PrepareMatrix");
+    sofa::simulation::common::MechanicalOperations mops(p_mechanical_params, this->getContext());
+    p_accessor.clear();
+    mops.getMatrixDimension(nullptr, nullptr, &p_accessor);
+    const auto n = static_cast<Eigen::Index>(p_accessor.getGlobalDimension());
+    const bool matrix_shape_has_changed = (n != p_A.rows());
+    p_accessor.setupMatrices();
+
+    // The sparsity pattern of the previous assembly is kept, the entries are accumulated directly into it
+    // (the pattern is only rebuilt if a new nonzero entry appears).
+    EigenMatrixWrapper<SparseMatrix &> wrapper (p_A);
+    wrapper.set_pattern_locked(true);
+    wrapper.resize(n, n);
+    p_accessor.setGlobalMatrix(&wrapper);
+    Timer::stepEnd("PrepareMatrix");
+
+    // Step 2. Building stage
+    //         Accumulate the matrices of the top-level mechanical objects, and then the ones of the mapped
+    //         mechanical objects.
+    Timer::stepBegin("BuildMatrix");
+    mops.addMBK_ToMatrix(&p_accessor, p_mechanical_params->mFactor(), p_mechanical_params->bFactor(), p_mechanical_params->kFactor());
+    p_accessor.computeGlobalMatrix();
+    wrapper.compress();
+    Timer::stepEnd("BuildMatrix");
+
+    // Step 3. Symbolic analysis, only when the sparsity pattern of the matrix has changed
+    const auto backend = get_backend();
+    const bool pattern_has_changed = matrix_shape_has_changed or wrapper.pattern_has_changed() or
+                                     backend != p_analyzed_backend or d_number_of_symbolic_analyses.getValue() == 0;
+    if (pattern_has_changed) {
+        Timer::stepBegin("SymbolicAnalysis");
+        if (backend == Backend::Eigen) {
+            p_eigen_ldlt.analyzePattern(p_A);
+        }
+#ifdef CARIBOU_WITH_MKL
+        if (backend == Backend::Pardiso) {
+            p_pardiso_ldlt.analyzePattern(p_A);
+        }
+#endif
+#ifdef CARIBOU_WITH_CHOLMOD
+        if (backend == Backend::Cholmod) {
+            p_cholmod_llt.analyzePattern(p_A);
+        }
+#endif
+        p_analyzed_backend = backend;
+        sofa::helper::WriteAccessor<Data<unsigned int>> number_of_symbolic_analyses = d_number_of_symbolic_analyses;
+        number_of_symbolic_analyses.wref() += 1;
+        Timer::stepEnd("SymbolicAnalysis");
+    }
+
+    // Step 4. Numeric factorization
+    Timer::stepBegin("NumericFactorization");
+    Eigen::ComputationInfo info = Eigen::Success;
+    if (backend == Backend::Eigen) {
+        p_eigen_ldlt.factorize(p_A);
+        info = p_eigen_ldlt.info();
+    }
+#ifdef CARIBOU_WITH_MKL
+    if (backend == Backend::Pardiso) {
+        p_pardiso_ldlt.factorize(p_A);
+        info = p_pardiso_ldlt.info();
+    }
+#endif
+#ifdef CARIBOU_WITH_CHOLMOD
+    if (backend == Backend::Cholmod) {
+        p_cholmod_llt.factorize(p_A);
+        info = p_cholmod_llt.info();
+    }
+#endif
+    sofa::helper::WriteAccessor<Data<unsigned int>> number_of_factorizations = d_number_of_factorizations;
+    number_of_factorizations.wref() += 1;
+    Timer::stepEnd("NumericFactorization");
+
+    p_factorization_is_valid = (info == Eigen::Success);
+    if (not p_factorization_is_valid) {
+        msg_error() << "The LDL^T factorization of the system matrix failed (the matrix may be singular).";
+    }
+
+    // Remove the global matrix from the accessor since the wrapper was temporary
+    p_accessor.setGlobalMatrix(nullptr);
+
+    Timer::stepEnd("LDLTSolver::ComputeGlobalMatrix");
+}
+
+void LDLTSolver::setSystemRHVector(sofa::core::MultiVecDerivId b_id) {
+    sofa::simulation::common::MechanicalOperations mop(p_mechanical_params, this->getContext());
+    p_b_id = b_id;
+
+    // Copy the vector b of the mechanical objects into a global eigen vector.
+    p_b.resize(static_cast<Eigen::Index>(p_accessor.getGlobalDimension()));
+    EigenVectorWrapper<FLOATING_POINT_TYPE> b(p_b);
+    mop.multiVector2BaseVector(p_b_id, &b, &p_accessor);
+}
+
+void LDLTSolver::setSystemLHVector(sofa::core::MultiVecDerivId x_id) {
+    p_x_id = x_id;
+}
+
+void LDLTSolver::solveSystem() {
+    Timer::stepBegin("LDLTSolver::solve");
+
+    if (not p_factorization_is_valid) {
+        msg_error() << "The system cannot be solved since the factorization of its matrix failed.";
+        Timer::stepEnd("LDLTSolver::solve");
+        return;
+    }
+
+    if (p_analyzed_backend == Backend::Eigen) {
+        p_x = p_eigen_ldlt.solve(p_b);
+    }
+#ifdef CARIBOU_WITH_MKL
+    if (p_analyzed_backend == Backend::Pardiso) {
+        p_x = p_pardiso_ldlt.solve(p_b);
+    }
+#endif
+#ifdef CARIBOU_WITH_CHOLMOD
+    if (p_analyzed_backend == Backend::Cholmod) {
+        p_x = p_cholmod_llt.solve(p_b);
+    }
+#endif
+
+    // Copy the solution into the mechanical objects of the current context sub-graph.
+    sofa::simulation::common::MechanicalOperations mop(p_mechanical_params, this->getContext());
+    EigenVectorWrapper<FLOATING_POINT_TYPE> x_wrapper(p_x);
+    mop.baseVector2MultiVector(&x_wrapper, p_x_id, &p_accessor);
+
+    Timer::stepEnd("LDLTSolver::solve");
+}
+
+int LDLTSolverClass = sofa::core::RegisterObject("Sparse direct solver of the linear system using the LDL^T factorization")
+                              .add< LDLTSolver>();
+
+} // namespace SofaCaribou::GraphComponents::solver
@@ -0,0 +1,170 @@
+#ifndef SOFACARIBOU_GRAPHCOMPONENTS_SOLVER_LDLTSOLVER_H
+#define SOFACARIBOU_GRAPHCOMPONENTS_SOLVER_LDLTSOLVER_H
+
+#include <Caribou/config.h>
+#include <sofa/core/behavior/LinearSolver.h>
+#include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
+#include <sofa/helper/OptionsGroup.h>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#ifdef CARIBOU_WITH_MKL
+#include <Eigen/PardisoSupport>
+#endif
+
+#ifdef CARIBOU_WITH_CHOLMOD
+#include <Eigen/CholmodSupport>
+#endif
+
+namespace SofaCaribou::GraphComponents::solver {
+
+using sofa::core::objectmodel::Data;
+using namespace sofa::component::linearsolver;
+using namespace sofa::core::behavior;
+
+/**
+ * Implements a sparse direct solver of the linear system Ax = b using the LDL^T factorization of the symmetric
+ * matrix A.
+ *
+ * The complete system matrix A is assembled into a sparse matrix from the mechanical objects of the current scene
+ * context graph (as done by the ConjugateGradientSolver when using a preconditioner). Its factorization is done in
+ * two steps:
+ *   1. The symbolic analysis computes the fill-reducing ordering (approximate minimum degree) and the sparsity
+ *      pattern of the factor L. It only depends on the sparsity pattern of A.
+ *   2. The numeric factorization computes the values of L and D.
+ *
+ * The sparsity pattern of the assembled matrix is kept between two assemblies (usually between two Newton
+ * iterations). The symbolic analysis is hence only redone when this pattern changes, and the following Newton
+ * iterations only pay for the numeric factorization.
+ *
+ * Three backends are available: Eigen's simplicial LDL^T (default), the supernodal LDL^T of Intel MKL's Pardiso
+ * when SofaCaribou is compiled with MKL, and the supernodal LL^T of SuiteSparse's CHOLMOD when SofaCaribou is
+ * compiled with CHOLMOD (the system matrix must then be positive definite). On large 3D meshes, the supernodal
+ * factorizations are usually much faster than the simplicial one.
+ */
+class LDLTSolver : public LinearSolver {
+
+public:
+    SOFA_CLASS(LDLTSolver, LinearSolver);
+    using SparseMatrix = Eigen::SparseMatrix<FLOATING_POINT_TYPE, Eigen::ColMajor>;
+    using Vector = Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 1>;
+
+    /// Backends of the factorization
+    enum class Backend : unsigned int {
+        /// Eigen's simplicial LDL^T factorization (default)
+        Eigen = 0,
+
+#ifdef CARIBOU_WITH_MKL
+        /// Supernodal LDL^T factorization of Intel MKL's Pardiso
+        Pardiso = 1,
+#endif
+
+#ifdef CARIBOU_WITH_CHOLMOD
+        /// Supernodal LL^T factorization of SuiteSparse's CHOLMOD
+        Cholmod = 2,
+#endif
+    };
+
+    /**
+     * Informs the user when the default simplicial backend is used, the supernodal backends being usually much faster
+     * on large 3D meshes.
+     */
+    void init() override;
+
+    /**
+     * Reset the complete system (A, x and b are cleared). This does nothing here since the system is rebuilt at
+     * every call to setSystemMBKMatrix.
+     *
+     * This method is called by the MultiMatrix::clear() and MultiMatrix::reset() methods.
+     */
+    void resetSystem() final {}
+
+    /**
+     * Assemble the linear system matrix A = (mM + bB + kK) and factorize it. The symbolic analysis of the matrix is
+     * only done when its sparsity pattern has changed since the last assembly.
+     *
+     * @param mparams Contains the coefficients m, b and k of the matrices M, B and K
+     */
+    void setSystemMBKMatrix(const sofa::core::MechanicalParams* mparams) final;
+
+    /**
+     * Gives the identifier of the right-hand side vector b. The complete dense vector is accumulated from the
+     * mechanical objects found in the graph subtree of the current context.
+     */
+    void setSystemRHVector(sofa::core::MultiVecDerivId b_id) final;
+
+    /**
+     * Gives the identifier of the left-hand side vector x. The solution will be copied into the mechanical objects
+     * found in the graph subtree of the current context.
+     */
+    void setSystemLHVector(sofa::core::MultiVecDerivId x_id) final;
+
+    /**
+     * Solves the system using the last factorization of the matrix A.
+     */
+    void solveSystem() final;
+
+protected:
+    /// Constructor
+    LDLTSolver();
+
+    /// INPUTS
+    Data< sofa::helper::OptionsGroup > d_backend;
+
+    /// OUTPUTS
+    Data<unsigned int> d_number_of_symbolic_analyses;
+    Data<unsigned int> d_number_of_factorizations;
+
+private:
+    /// Private methods
+    /**
+     * @brief Get the backend selected by the user
+     */
+    Backend get_backend() const;
+
+    /// Private members
+    ///< The mechanical parameters containing the m, b and k coefficients.
+    const sofa::core::MechanicalParams * p_mechanical_params = nullptr;
+
+    ///< Accessor used to determine the index of each mechanical object matrix and vector in the global system.
+    DefaultMultiMatrixAccessor p_accessor;
+
+    ///< The identifier of the b vector
+    sofa::core::MultiVecDerivId p_b_id;
+
+    ///< The identifier of the x vector
+    sofa::core::MultiVecDerivId p_x_id;
+
+    ///< Global system matrix
+    SparseMatrix p_A;
+
+    ///< Global system solution vector
+    Vector p_x;
+
+    ///< Global system right-hand side vector
+    Vector p_b;
+
+    ///< Eigen's simplicial LDL^T factorization
+    Eigen::SimplicialLDLT<SparseMatrix> p_eigen_ldlt;
+
+#ifdef CARIBOU_WITH_MKL
+    ///< Pardiso's supernodal LDL^T factorization
+    Eigen::PardisoLDLT<SparseMatrix> p_pardiso_ldlt;
+#endif
+
+#ifdef CARIBOU_WITH_CHOLMOD
+    ///< CHOLMOD's supernodal LL^T factorization
+    Eigen::CholmodSupernodalLLT<SparseMatrix> p_cholmod_llt;
+#endif
+
+    ///< Backend used by the last symbolic analysis
+    Backend p_analyzed_backend = Backend::Eigen;
+
+    ///< Whether or not the last factorization succeeded
+    bool p_factorization_is_valid = false;
+};
+
+} // namespace SofaCaribou::GraphComponents::solver
+
+#endif //SOFACARIBOU_GRAPHCOMPONENTS_SOLVER_LDLTSOLVER_H
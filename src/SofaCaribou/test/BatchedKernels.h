@@ -0,0 +1,84 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <SofaCaribou/GraphComponents/Forcefield/HyperelasticKernels.h>
+#include "Beam.h"
+
+TEST(BatchedKernels, ElementKernels) {
+    using namespace SofaCaribou::GraphComponents::forcefield::kernels;
+    using Mat33 = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
+    constexpr std::size_t nb_nodes = 8;
+
+    alignas(64) double dN_dx[nb_nodes*3][BatchSize], U[nb_nodes*3][BatchSize];
+    alignas(64) double F[9][BatchSize], J[BatchSize], E[9][BatchSize], S[9][BatchSize], w[BatchSize];
+    alignas(64) double forces[nb_nodes*3][BatchSize] = {};
+
+    std::srand(1);
+    const auto random = [] { return 2. * std::rand() / RAND_MAX - 1.; };
+    for (std::size_t l = 0; l < BatchSize; ++l) {
+        for (std::size_t i = 0; i < nb_nodes*3; ++i) {
+            dN_dx[i][l] = random();
+            U[i][l] = 0.1 * random();
+        }
+        for (std::size_t i = 0; i < 9; ++i) {
+            S[i][l] = random();
+        }
+        w[l] = 1 + random();
+    }
+
+    deformation_gradients(nb_nodes, &dN_dx[0][0], &U[0][0], &F[0][0]);
+    green_lagrange_strains(&F[0][0], J, &E[0][0]);
+    nodal_forces(nb_nodes, &dN_dx[0][0], &F[0][0], &S[0][0], w, &forces[0][0]);
+
+    for (std::size_t l = 0; l < BatchSize; ++l) {
+        Eigen::Matrix<double, nb_nodes, 3, Eigen::RowMajor> dN, u;
+        Mat33 s;
+        for (std::size_t n = 0; n < nb_nodes; ++n) for (std::size_t i = 0; i < 3; ++i) {
+            dN(n, i) = dN_dx[n*3+i][l];
+            u(n, i) = U[n*3+i][l];
+        }
+        for (std::size_t i = 0; i < 9; ++i) s(i/3, i%3) = S[i][l];
+
+        const Mat33 F_ref = Mat33::Identity() + u.transpose() * dN;
+        const Mat33 E_ref = 0.5 * (F_ref.transpose() * F_ref - Mat33::Identity());
+        const Eigen::Matrix<double, nb_nodes, 3, Eigen::RowMajor> f_ref = w[l] * (F_ref * s * dN.transpose()).transpose();
+
+        EXPECT_NEAR(J[l], F_ref.determinant(), 1e-12);
+        for (std::size_t i = 0; i < 9; ++i) {
+            EXPECT_NEAR(F[i][l], F_ref(i/3, i%3), 1e-12);
+            EXPECT_NEAR(E[i][l], E_ref(i/3, i%3), 1e-12);
+        }
+        for (std::size_t n = 0; n < nb_nodes; ++n) for (std::size_t i = 0; i < 3; ++i) {
+            EXPECT_NEAR(forces[n*3+i][l], f_ref(n, i), 1e-12);
+        }
+    }
+}
+
+TEST(BatchedKernels, HyperelasticForcefield) {
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        SCOPED_TRACE(material);
+        const auto reference = beam_test::solve({"HyperelasticForcefield", {}, material});
+        const auto batched = beam_test::solve({"HyperelasticForcefield", {{"batched_kernels", "true"}}, material});
+
+        ASSERT_TRUE(reference.converged);
+        EXPECT_TRUE(batched.converged);
+        EXPECT_EQ(batched.residuals.size(), reference.residuals.size());
+        ASSERT_EQ(batched.positions.size(), reference.positions.size());
+        for (std::size_t i = 0; i < reference.positions.size(); ++i) {
+            EXPECT_LT((batched.positions[i] - reference.positions[i]).norm(), 1e-8);
+        }
+    }
+}
+
+TEST(BatchedKernels, HyperelasticTangent) {
+    // With the batched kernels, the tangent is computed from the gauss nodes stored in the batches
+    for (const std::string storage : {"Dense", "PackedSymmetric", "MatrixFree"}) {
+        SCOPED_TRACE(storage);
+        const beam_test::BeamOptions reference_options {"HyperelasticForcefield", {{"tangent_storage", storage}}, "NeoHookeanMaterial"};
+        const auto reference = beam_test::evaluate_forcefield(reference_options);
+        const beam_test::BeamOptions batched_options {"HyperelasticForcefield", {{"tangent_storage", storage}, {"batched_kernels", "true"}}, "NeoHookeanMaterial"};
+        const auto batched = beam_test::evaluate_forcefield(batched_options);
+        beam_test::expect_same_tangent(reference, batched, 1e-10);
+    }
+}
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+
+#include <Eigen/Dense>
+#include <SofaCaribou/Algebra/EigenMatrixWrapper.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <sofa/core/MechanicalParams.h>
+#include <sofa/core/behavior/ForceField.h>
+#include <sofa/core/behavior/MechanicalState.h>
+
+namespace beam_test {
+
+using sofa::core::objectmodel::BaseObject;
+using sofa::core::objectmodel::Data;
+using sofa::defaulttype::Vec3Types;
+using Arguments = std::map<std::string, std::string>;
+
+/**
+ * Components of the beam scene. The given solver arguments override the default ones (tight tolerances, see Beam),
+ * the forcefield arguments are used as is.
+ */
+struct BeamOptions {
+    std::string forcefield = "HyperelasticForcefield";
+    Arguments forcefield_arguments = {};
+    std::string material = ""; ///< Material of the HyperelasticForcefield, none if empty
+    std::string ode_solver = "StaticODESolver";
+    Arguments ode_solver_arguments = {};
+    std::string linear_solver = "ConjugateGradientSolver";
+    Arguments linear_solver_arguments = {};
+    std::string traction_slope = "1"; ///< Fraction of the traction added at every time steps
+    std::string element = "Hexahedron"; ///< Hexahedron, or Tetrahedron to split each hexahedron of the grid in 6
+};
+
+/**
+ * A clamped beam (2x2x10 hexahedrons, or 6 times more tetrahedrons) pulled down on its free end by a traction force.
+ * The scene is initialized on construction and unloaded on destruction.
+ */
+class Beam {
+public:
+    explicit Beam(const BeamOptions & options) {
+        using namespace sofa::simpleapi;
+        p_simulation = createSimulation("DAG");
+        sofa::simulation::setSimulation(p_simulation.get());
+        p_root = createRootNode(p_simulation, "root");
+
+        createObject(p_root, "RegularGridTopology", {{"name", "grid"}, {"min", "-1 -1 0"}, {"max", "1 1 10"}, {"n", "3 3 11"}});
+
+        auto meca = createChild(p_root, "meca");
+        Arguments ode_solver_arguments = {{"residual_tolerance_threshold", "1e-10"}};
+        if (options.ode_solver == "StaticODESolver") {
+            ode_solver_arguments = {{"newton_iterations", "25"}, {"correction_tolerance_threshold", "-1"}, {"residual_tolerance_threshold", "1e-10"}};
+        }
+        p_ode_solver = createObject(meca, options.ode_solver, merged(ode_solver_arguments, options.ode_solver_arguments));
+
+        Arguments linear_solver_arguments;
+        if (options.linear_solver == "ConjugateGradientSolver") {
+            linear_solver_arguments = {{"preconditioning_method", "None"}, {"maximum_number_of_iterations", "1000"}, {"residual_tolerance_threshold", "1e-12"}};
+        }
+        p_linear_solver = createObject(meca, options.linear_solver, merged(linear_solver_arguments, options.linear_solver_arguments));
+
+        p_state = createObject(meca, "MechanicalObject", {{"name", "mo"}, {"position", "@../grid.position"}});
+        const bool tetrahedral = (options.element == "Tetrahedron");
+        if (tetrahedral) {
+            createObject(meca, "TetrahedronSetTopologyContainer", {{"name", "topology"}});
+            createObject(meca, "TetrahedronSetTopologyModifier");
+            createObject(meca, "Hexa2TetraTopologicalMapping", {{"input", "@../grid"}, {"output", "@topology"}, {"swapping", "true"}});
+        } else {
+            createObject(meca, "HexahedronSetTopologyContainer", {{"name", "topology"}, {"src", "@../grid"}});
+        }
+        if (not options.material.empty()) {
+            createObject(meca, options.material, {{"young_modulus", "3000"}, {"poisson_ratio", "0.3"}});
+        }
+        p_forcefield = createObject(meca, options.forcefield, options.forcefield_arguments);
+        createObject(meca, "BoxROI", {{"name", "base_roi"}, {"box", "-1.1 -1.1 -0.1 1.1 1.1 0.1"}});
+        createObject(meca, "FixedConstraint", {{"indices", "@base_roi.indices"}});
+        if (tetrahedral) {
+            createObject(meca, "BoxROI", {{"name", "top_roi"}, {"box", "-1.1 -1.1 9.9 1.1 1.1 10.1"}});
+            p_traction = createObject(meca, "TractionForce", {{"traction", "0 -30 0"}, {"slope", options.traction_slope}, {"triangles", "@top_roi.trianglesInROI"}});
+        } else {
+            createObject(meca, "BoxROI", {{"name", "top_roi"}, {"box", "-1.1 -1.1 9.9 1.1 1.1 10.1"}, {"quad", "@topology.quads"}});
+            p_traction = createObject(meca, "TractionForce", {{"traction", "0 -30 0"}, {"slope", options.traction_slope}, {"quads", "@top_roi.quadInROI"}});
+        }
+
+        p_simulation->init(p_root.get());
+    }
+
+    Beam(const Beam &) = delete;
+    Beam & operator=(const Beam &) = delete;
+
+    ~Beam() {
+        p_simulation->unload(p_root);
+    }
+
+    /** Solve the given number of time steps */
+    void animate(const unsigned int & number_of_steps = 1) {
+        for (unsigned int step = 0; step < number_of_steps; ++step) {
+            p_simulation->animate(p_root.get(), 1);
+        }
+    }
+
+    /** Value of the data field of one of the beam's components */
+    template <typename T>
+    static T data(const BaseObject::SPtr & object, const std::string & name) {
+        const auto * field = dynamic_cast<Data<T> *>(object->findData(name));
+        EXPECT_NE(field, nullptr) << "No data field '" << name << "' of this type.";
+        return field ? field->getValue() : T {};
+    }
+
+    /** Value of the data field of one of the beam's components, or T {} if the component has no such field */
+    template <typename T>
+    static T data_if_any(const BaseObject::SPtr & object, const std::string & name) {
+        const auto * field = dynamic_cast<Data<T> *>(object->findData(name));
+        return field ? field->getValue() : T {};
+    }
+
+    auto ode_solver() const -> const BaseObject::SPtr & { return p_ode_solver; }
+    auto linear_solver() const -> const BaseObject::SPtr & { return p_linear_solver; }
+    auto forcefield() const -> const BaseObject::SPtr & { return p_forcefield; }
+    auto traction() const -> const BaseObject::SPtr & { return p_traction; }
+
+    auto state() const -> sofa::core::behavior::MechanicalState<Vec3Types> * {
+        return dynamic_cast<sofa::core::behavior::MechanicalState<Vec3Types> *>(p_state.get());
+    }
+
+    auto rest_positions() const -> Vec3Types::VecCoord { return state()->readRestPositions().ref(); }
+    auto positions() const -> Vec3Types::VecCoord { return state()->readPositions().ref(); }
+
+private:
+    static Arguments merged(Arguments defaults, const Arguments & overrides) {
+        for (const auto & argument : overrides) {
+            defaults[argument.first] = argument.second;
+        }
+        return defaults;
+    }
+
+    sofa::simulation::Simulation::SPtr p_simulation;
+    sofa::simulation::Node::SPtr p_root;
+    BaseObject::SPtr p_ode_solver;
+    BaseObject::SPtr p_linear_solver;
+    BaseObject::SPtr p_state;
+    BaseObject::SPtr p_forcefield;
+    BaseObject::SPtr p_traction;
+};
+
+/** State of the beam at the end of a time step */
+struct Equilibrium {
+    bool converged;
+    sofa::helper::vector<double> residuals;
+    Vec3Types::VecCoord rest_positions;
+    Vec3Types::VecCoord positions;
+};
+
+/**
+ * Equilibrium of the beam, and the work done by its solvers to reach it. The outputs that the beam's solvers don't
+ * have are left empty.
+ */
+struct Solution : Equilibrium {
+    // ODE solver
+    sofa::helper::vector<unsigned int> linear_solver_iterations;
+    sofa::helper::vector<double> step_lengths;
+    unsigned int number_of_tangent_updates;
+    unsigned int number_of_tangent_reuses;
+    unsigned int number_of_load_cutbacks;
+
+    // Linear solver
+    unsigned int number_of_factorizations;
+    unsigned int number_of_symbolic_analyses;
+    sofa::helper::vector<unsigned int> iterations_per_solve;
+};
+
+/** Read the state of the beam and the outputs of its solvers at the end of the last time step */
+inline Solution read_solution(const Beam & beam) {
+    const auto & ode_solver = beam.ode_solver();
+    const auto & linear_solver = beam.linear_solver();
+
+    Solution s {};
+    s.converged = Beam::data<bool>(ode_solver, "converged");
+    s.residuals = Beam::data<sofa::helper::vector<double>>(ode_solver, "residuals");
+    s.rest_positions = beam.rest_positions();
+    s.positions = beam.positions();
+
+    s.linear_solver_iterations = Beam::data_if_any<sofa::helper::vector<unsigned int>>(ode_solver, "linear_solver_iterations");
+    s.step_lengths = Beam::data_if_any<sofa::helper::vector<double>>(ode_solver, "step_lengths");
+    s.number_of_tangent_updates = Beam::data_if_any<unsigned int>(ode_solver, "number_of_tangent_updates");
+    s.number_of_tangent_reuses = Beam::data_if_any<unsigned int>(ode_solver, "number_of_tangent_reuses");
+    s.number_of_load_cutbacks = Beam::data_if_any<unsigned int>(ode_solver, "number_of_load_cutbacks");
+
+    s.number_of_factorizations = Beam::data_if_any<unsigned int>(linear_solver, "number_of_factorizations");
+    s.number_of_symbolic_analyses = Beam::data_if_any<unsigned int>(linear_solver, "number_of_symbolic_analyses");
+    s.iterations_per_solve = Beam::data_if_any<sofa::helper::vector<unsigned int>>(linear_solver, "iterations_per_solve");
+    return s;
+}
+
+/** Solve the first time step of the beam */
+inline Solution solve(const BeamOptions & options) {
+    Beam beam(options);
+    beam.animate();
+    return read_solution(beam);
+}
+
+/**
+ * Two variants of a solver converging to the same equilibrium (up to the newton tolerance), but following
+ * different iterations.
+ */
+inline void expect_same_equilibrium(const Equilibrium & reference, const Equilibrium & solution) {
+    ASSERT_EQ(solution.positions.size(), reference.positions.size());
+    double max_difference = 0, max_displacement = 0;
+    for (std::size_t i = 0; i < reference.positions.size(); ++i) {
+        max_difference = std::max(max_difference, static_cast<double>((solution.positions[i] - reference.positions[i]).norm()));
+        max_displacement = std::max(max_displacement, static_cast<double>((reference.positions[i] - reference.rest_positions[i]).norm()));
+    }
+    EXPECT_LT(max_difference, 1e-6 * max_displacement);
+}
+
+/**
+ * Two variants of a solver must follow the same newton iterations: same number of iterations, same residuals (up to
+ * the tolerance of the linear solver) and same solution.
+ */
+inline void expect_same_newton_iterations(const Equilibrium & reference, const Equilibrium & solution) {
+    ASSERT_TRUE(reference.converged);
+    EXPECT_TRUE(solution.converged);
+    ASSERT_EQ(solution.residuals.size(), reference.residuals.size());
+    for (std::size_t i = 0; i < reference.residuals.size(); ++i) {
+        EXPECT_NEAR(solution.residuals[i], reference.residuals[i], 1e-6*reference.residuals[0] + 1e-8*reference.residuals[i]);
+    }
+
+    ASSERT_EQ(solution.positions.size(), reference.positions.size());
+    for (std::size_t i = 0; i < reference.positions.size(); ++i) {
+        EXPECT_LT((solution.positions[i] - reference.positions[i]).norm(), 1e-8);
+    }
+}
+
+/** Forces and tangent stiffness of the beam's forcefield at a given state */
+struct Tangent {
+    Vec3Types::VecDeriv forces; ///< Forces at the positions (addForce)
+    Vec3Types::VecDeriv force_increments; ///< Product of the tangent stiffness with a displacement increment (addDForce)
+    Eigen::MatrixXd stiffness; ///< Assembled tangent stiffness (addKToMatrix)
+};
+
+/**
+ * Bend and twist the beam without solving anything, and evaluate its forcefield there. The displacement increment
+ * is random, but the same one at every calls.
+ */
+inline Tangent evaluate_forcefield(const Beam & beam) {
+    auto * forcefield = dynamic_cast<sofa::core::behavior::ForceField<Vec3Types> *>(beam.forcefield().get());
+    auto * state = beam.state();
+
+    const auto rest_positions = beam.rest_positions();
+    const auto nb_nodes = rest_positions.size();
+    {
+        auto x = state->writePositions();
+        for (std::size_t i = 0; i < nb_nodes; ++i) {
+            const auto & p = rest_positions[i];
+            x[i][0] = p[0] - 0.02*p[2]*p[1] + 0.005*p[2]*p[2];
+            x[i][1] = p[1] + 0.02*p[2]*p[0] - 0.01*p[2]*p[2];
+            x[i][2] = p[2] + 0.01*p[2] + 0.002*p[0]*p[2];
+        }
+    }
+
+    std::mt19937 generator (0);
+    std::uniform_real_distribution<double> distribution (-0.01, 0.01);
+    Data<Vec3Types::VecDeriv> dx;
+    dx.setValue(Vec3Types::VecDeriv(nb_nodes));
+    {
+        auto increments = sofa::helper::WriteAccessor<Data<Vec3Types::VecDeriv>>(dx);
+        for (std::size_t i = 0; i < nb_nodes; ++i) {
+            for (std::size_t j = 0; j < 3; ++j) {
+                increments[i][j] = distribution(generator);
+            }
+        }
+    }
+
+    sofa::core::MechanicalParams mparams;
+    mparams.setKFactor(1.);
+    mparams.setImplicit(true);
+
+    Data<Vec3Types::VecDeriv> f, df, v;
+    f.setValue(Vec3Types::VecDeriv(nb_nodes));
+    df.setValue(Vec3Types::VecDeriv(nb_nodes));
+    v.setValue(Vec3Types::VecDeriv(nb_nodes));
+    forcefield->addForce(&mparams, f, *state->read(sofa::core::ConstVecCoordId::position()), v);
+    forcefield->addDForce(&mparams, df, dx);
+
+    Tangent tangent;
+    tangent.forces = f.getValue();
+    tangent.force_increments = df.getValue();
+    tangent.stiffness = Eigen::MatrixXd::Zero(3*nb_nodes, 3*nb_nodes);
+    SofaCaribou::Algebra::EigenMatrixWrapper<Eigen::MatrixXd &> matrix (tangent.stiffness);
+    unsigned int offset = 0;
+    forcefield->addKToMatrix(&matrix, 1., offset);
+
+    return tangent;
+}
+
+/** Build the beam, bend and twist it, and evaluate its forcefield there (see evaluate_forcefield(const Beam &)) */
+inline Tangent evaluate_forcefield(const BeamOptions & options) {
+    const Beam beam (options);
+    return evaluate_forcefield(beam);
+}
+
+/** Two evaluations of the forcefield's tangent at the same state, up to the given tolerance (relative to the largest values) */
+inline void expect_same_tangent(const Tangent & reference, const Tangent & tangent, const double & tolerance) {
+    ASSERT_EQ(tangent.forces.size(), reference.forces.size());
+    ASSERT_EQ(tangent.force_increments.size(), reference.force_increments.size());
+    double max_force = 0, max_increment = 0;
+    for (std::size_t i = 0; i < reference.forces.size(); ++i) {
+        max_force = std::max(max_force, static_cast<double>(reference.forces[i].norm()));
+        max_increment = std::max(max_increment, static_cast<double>(reference.force_increments[i].norm()));
+    }
+    for (std::size_t i = 0; i < reference.forces.size(); ++i) {
+        EXPECT_LT((tangent.forces[i] - reference.forces[i]).norm(), tolerance * max_force);
+        EXPECT_LT((tangent.force_increments[i] - reference.force_increments[i]).norm(), tolerance * max_increment);
+    }
+
+    ASSERT_EQ(tangent.stiffness.rows(), reference.stiffness.rows());
+    ASSERT_EQ(tangent.stiffness.cols(), reference.stiffness.cols());
+    EXPECT_LT((tangent.stiffness - reference.stiffness).cwiseAbs().maxCoeff(), tolerance * reference.stiffness.cwiseAbs().maxCoeff());
+}
+
+} // namespace beam_test
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <SofaCaribou/Algebra/BlockSparseMatrix.h>
+#include <SofaCaribou/Algebra/BlockSparseMatrixWrapper.h>
+#include <SofaCaribou/Algebra/BlockDiagonalPreconditioner.h>
+#include <SofaCaribou/Algebra/BlockIncompleteCholesky.h>
+
+namespace block_sparse_matrix_test {
+
+/**
+ * Assemble the stiffness-like matrix of a chain of nodes (each node being connected to the next one) with random
+ * symmetric positive definite couplings, using the block wrapper.
+ */
+template <typename Wrapper>
+void assemble_chain(Wrapper & wrapper, std::size_t nb_nodes, unsigned int seed) {
+    using Mat3x3 = sofa::defaulttype::Mat3x3d;
+    std::srand(seed);
+    const auto random = [] { return 2. * std::rand() / RAND_MAX - 1.; };
+
+    for (std::size_t n = 0; n+1 < nb_nodes; ++n) {
+        // Random symmetric 3x3 block K of a spring between the nodes n and n+1
+        Eigen::Matrix3d k = Eigen::Matrix3d::NullaryExpr(random);
+        k = k*k.transpose() + Eigen::Matrix3d::Identity();
+        Mat3x3 K, minus_K;
+        for (int i = 0; i < 3; ++i) for (int j = 0; j < 3; ++j) {
+            K[i][j] = k(i, j);
+            minus_K[i][j] = -k(i, j);
+        }
+
+        wrapper.add(3*n, 3*n, K);
+        wrapper.add(3*(n+1), 3*(n+1), K);
+        wrapper.add(3*n, 3*(n+1), minus_K);
+        wrapper.add(3*(n+1), 3*n, minus_K);
+    }
+
+    // Make the matrix positive definite
+    for (std::size_t i = 0; i < 3*nb_nodes; ++i) {
+        wrapper.add(i, i, 1.);
+    }
+}
+
+} // namespace block_sparse_matrix_test
+
+TEST(BlockSparseMatrix, Assembly) {
+    using namespace block_sparse_matrix_test;
+    using BlockMatrix = SofaCaribou::Algebra::BlockSparseMatrix<double, 3>;
+    using BlockWrapper = SofaCaribou::Algebra::BlockSparseMatrixWrapper<BlockMatrix &>;
+    using EigenSparse = Eigen::SparseMatrix<double>;
+    using EigenWrapper = SofaCaribou::Algebra::EigenMatrixWrapper<EigenSparse &>;
+
+    const std::size_t nb_nodes = 20;
+    BlockMatrix A;
+    EigenSparse S;
+
+    for (unsigned int step = 0; step < 3; ++step) {
+        BlockWrapper block_wrapper(A);
+        block_wrapper.set_pattern_locked(true);
+        block_wrapper.resize(3*nb_nodes, 3*nb_nodes);
+        assemble_chain(block_wrapper, nb_nodes, step);
+
+        EigenWrapper eigen_wrapper(S);
+        eigen_wrapper.resize(3*nb_nodes, 3*nb_nodes);
+        assemble_chain(eigen_wrapper, nb_nodes, step);
+
+        // Entries that are not aligned with the blocks, and that are not part of the pattern yet
+        block_wrapper.add(1, 2, 5.);
+        eigen_wrapper.add(1, 2, 5.);
+        block_wrapper.add(4, 58, 5.);
+        eigen_wrapper.add(4, 58, 5.);
+
+        block_wrapper.compress();
+        eigen_wrapper.compress();
+
+        // The pattern is only rebuilt on the first assembly
+        EXPECT_EQ(block_wrapper.pattern_has_changed(), step == 0);
+        EXPECT_EQ(A.non_zero_blocks(), 3*nb_nodes - 2 + 1);
+
+        // Clear the rows and columns of a fixed node
+        block_wrapper.clearRows(9, 11);
+        block_wrapper.clearCols(9, 11);
+        block_wrapper.set(10, 10, 1);
+        eigen_wrapper.clearRows(9, 11);
+        eigen_wrapper.clearCols(9, 11);
+        eigen_wrapper.set(10, 10, 1);
+
+        EXPECT_NEAR((Eigen::MatrixXd(A.to_sparse()) - Eigen::MatrixXd(S)).norm(), 0, 1e-12);
+        EXPECT_EQ(block_wrapper(1, 2), S.coeff(1, 2));
+
+        // Block matrix-vector product
+        const Eigen::VectorXd x = Eigen::VectorXd::Random(3*nb_nodes);
+        EXPECT_NEAR((A*x - S*x).norm(), 0, 1e-12);
+    }
+}
+
+TEST(BlockSparseMatrix, Preconditioners) {
+    using namespace block_sparse_matrix_test;
+    using BlockMatrix = SofaCaribou::Algebra::BlockSparseMatrix<double, 3>;
+    using BlockWrapper = SofaCaribou::Algebra::BlockSparseMatrixWrapper<BlockMatrix &>;
+
+    const std::size_t nb_nodes = 20;
+    BlockMatrix A;
+    BlockWrapper wrapper(A);
+    wrapper.resize(3*nb_nodes, 3*nb_nodes);
+    assemble_chain(wrapper, nb_nodes, 1);
+    wrapper.compress();
+
+    const Eigen::MatrixXd dense = A.to_sparse();
+    const Eigen::VectorXd b = Eigen::VectorXd::Random(3*nb_nodes);
+
+    // Block diagonal: exact inverse of the diagonal blocks
+    SofaCaribou::Algebra::BlockDiagonalPreconditioner<double, 3> diagonal;
+    diagonal.compute(A);
+    const Eigen::VectorXd x_diagonal = diagonal.solve(b);
+    for (std::size_t n = 0; n < nb_nodes; ++n) {
+        const Eigen::Matrix3d D = dense.block<3, 3>(3*n, 3*n);
+        EXPECT_NEAR((D*x_diagonal.segment<3>(3*n) - b.segment<3>(3*n)).norm(), 0, 1e-10);
+    }
+
+    // Block diagonal factorized from the diagonal blocks only (as gathered from the forcefields without assembly)
+    std::vector<BlockMatrix::Block, Eigen::aligned_allocator<BlockMatrix::Block>> blocks (nb_nodes);
+    for (std::size_t n = 0; n < nb_nodes; ++n) {
+        blocks[n] = dense.block<3, 3>(3*n, 3*n);
+    }
+    SofaCaribou::Algebra::BlockDiagonalPreconditioner<double, 3> diagonal_from_blocks;
+    diagonal_from_blocks.factorize(blocks);
+    EXPECT_EQ(diagonal_from_blocks.rows(), diagonal.rows());
+    EXPECT_NEAR((diagonal_from_blocks.solve(b) - x_diagonal).norm(), 0, 1e-12);
+
+    // Block incomplete Cholesky: the chain's matrix has no fill-in, hence IC(0) is the exact Cholesky factorization
+    SofaCaribou::Algebra::BlockIncompleteCholesky<double, 3> ichol;
+    ichol.compute(A);
+    ASSERT_EQ(ichol.info(), Eigen::Success);
+    EXPECT_EQ(ichol.shift(), 0);
+    const Eigen::VectorXd x_ichol = ichol.solve(b);
+    EXPECT_NEAR((dense*x_ichol - b).norm() / b.norm(), 0, 1e-10);
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <Eigen/IterativeLinearSolvers>
+#include <SofaCaribou/Algebra/SinglePrecisionPreconditioner.h>
+#include <SofaCaribou/GraphComponents/Solver/ConjugateGradientSolver.h>
+#include "Beam.h"
+#include "Elasticity.h"
+
+namespace conjugate_gradient_solver_test {
+
+using beam_test::Arguments;
+
+/** The Saint-Venant-Kirchhoff beam solved by a CG with the given arguments */
+inline beam_test::BeamOptions cg_beam(const Arguments & cg_arguments) {
+    beam_test::BeamOptions options;
+    options.material = "SaintVenantKirchhoffMaterial";
+    options.linear_solver_arguments = cg_arguments;
+    return options;
+}
+
+/**
+ * Solve the linear elasticity system A x = b directly with the preconditioned solve of a CG created with the given
+ * arguments, and return the squared residuals of its iterations.
+ */
+template <typename Preconditioner>
+std::vector<double> solve_elasticity(const Arguments & cg_arguments, const Preconditioner & precond, const elasticity_test::SparseMatrix & A, const Eigen::VectorXd & b, Eigen::VectorXd & x) {
+    using namespace sofa::simpleapi;
+    auto simulation = createSimulation("DAG");
+    sofa::simulation::setSimulation(simulation.get());
+    auto root = createRootNode(simulation, "root");
+    const auto object = createObject(root, "ConjugateGradientSolver", cg_arguments);
+    simulation->init(root.get());
+
+    std::vector<double> squared_residuals;
+    auto * cg = dynamic_cast<SofaCaribou::GraphComponents::solver::ConjugateGradientSolver *>(object.get());
+    EXPECT_NE(cg, nullptr);
+    if (cg) {
+        cg->solve(precond, A, b, x);
+        squared_residuals = cg->squared_residuals();
+    }
+
+    simulation->unload(root);
+    return squared_residuals;
+}
+
+} // namespace conjugate_gradient_solver_test
+
+TEST(ConjugateGradientSolver, FlatVectors) {
+    using namespace conjugate_gradient_solver_test;
+    const auto reference = beam_test::solve(cg_beam({}));
+    const auto flat = beam_test::solve(cg_beam({{"flat_vectors", "true"}}));
+    beam_test::expect_same_newton_iterations(reference, flat);
+}
+
+TEST(ConjugateGradientSolver, Pipelined) {
+    using namespace conjugate_gradient_solver_test;
+    for (const std::string method : {"None", "Diagonal", "BlockIncompleteCholesky"}) {
+        SCOPED_TRACE(method);
+        const auto reference = beam_test::solve(cg_beam({{"preconditioning_method", method}}));
+        const auto pipelined = beam_test::solve(cg_beam({{"preconditioning_method", method}, {"pipelined", "true"}}));
+        beam_test::expect_same_newton_iterations(reference, pipelined);
+    }
+}
+
+TEST(ConjugateGradientSolver, PreconditionerReuse) {
+    using namespace conjugate_gradient_solver_test;
+    for (const std::string method : {"IncompleteCholesky", "BlockIncompleteCholesky"}) {
+        SCOPED_TRACE(method);
+        const auto reference = beam_test::solve(cg_beam({{"preconditioning_method", method}}));
+        const auto reused = beam_test::solve(cg_beam({{"preconditioning_method", method}, {"preconditioner_reuse", "3"}, {"preconditioner_reuse_ratio", "10"}}));
+
+        // Every newton iterations factorize the preconditioner by default
+        EXPECT_EQ(reference.number_of_factorizations, reference.residuals.size() - 1);
+
+        // The lagged preconditioner only changes the CG iterations, not the newton iterations
+        EXPECT_LT(reused.number_of_factorizations, reference.number_of_factorizations);
+        beam_test::expect_same_newton_iterations(reference, reused);
+    }
+}
+
+TEST(ConjugateGradientSolver, AsynchronousFactorization) {
+    using namespace conjugate_gradient_solver_test;
+    for (const std::string method : {"IncompleteCholesky", "IncompleteLU", "BlockIncompleteCholesky"}) {
+        SCOPED_TRACE(method);
+        const auto reference = beam_test::solve(cg_beam({{"preconditioning_method", method}}));
+        const auto asynchronous = beam_test::solve(cg_beam({{"preconditioning_method", method}, {"asynchronous_factorization", "true"}}));
+
+        // The first assembly is always factorized immediately, the next ones whenever the background thread is done
+        EXPECT_GE(asynchronous.number_of_factorizations, 1u);
+        EXPECT_LE(asynchronous.number_of_factorizations, reference.number_of_factorizations);
+        beam_test::expect_same_newton_iterations(reference, asynchronous);
+    }
+}
+
+TEST(ConjugateGradientSolver, GeometricMultigrid) {
+    using namespace conjugate_gradient_solver_test;
+    const auto reference = beam_test::solve(cg_beam({{"preconditioning_method", "Diagonal"}}));
+    const auto multigrid = beam_test::solve(cg_beam({{"preconditioning_method", "GeometricMultigrid"}}));
+    beam_test::expect_same_newton_iterations(reference, multigrid);
+}
+
+TEST(ConjugateGradientSolver, SmoothedAggregation) {
+    using namespace conjugate_gradient_solver_test;
+    const auto reference = beam_test::solve(cg_beam({{"preconditioning_method", "Diagonal"}}));
+    const auto multigrid = beam_test::solve(cg_beam({{"preconditioning_method", "SmoothedAggregation"}}));
+    beam_test::expect_same_newton_iterations(reference, multigrid);
+}
+
+TEST(ConjugateGradientSolver, NodeBlockJacobi) {
+    using namespace conjugate_gradient_solver_test;
+    const std::map<std::string, std::map<std::string, std::string>> forcefields = {
+        {"HyperelasticForcefield", {}},
+        {"HexahedronElasticForce", {{"youngModulus", "3000"}, {"poissonRatio", "0.3"}, {"linearStrain", "false"}, {"corotated", "true"}}}
+    };
+    for (const auto & forcefield : forcefields) {
+        SCOPED_TRACE(forcefield.first);
+        const std::string material = (forcefield.first == "HyperelasticForcefield") ? "SaintVenantKirchhoffMaterial" : "";
+
+        // The diagonal blocks given by the forcefields are the ones of the assembled matrix, hence the matrix-free
+        // node block Jacobi must follow the CG iterations of the assembled block diagonal preconditioner
+        beam_test::BeamOptions options {forcefield.first, forcefield.second, material};
+        options.linear_solver_arguments = {{"preconditioning_method", "BlockDiagonal"}};
+        const auto assembled = beam_test::solve(options);
+        options.linear_solver_arguments = {{"preconditioning_method", "NodeBlockJacobi"}};
+        const auto matrix_free = beam_test::solve(options);
+        beam_test::expect_same_newton_iterations(assembled, matrix_free);
+
+        EXPECT_EQ(matrix_free.number_of_factorizations, assembled.number_of_factorizations);
+        ASSERT_FALSE(matrix_free.iterations_per_solve.empty());
+        ASSERT_FALSE(assembled.iterations_per_solve.empty());
+        EXPECT_NEAR(matrix_free.iterations_per_solve.back(), assembled.iterations_per_solve.back(), 1);
+    }
+}
+
+TEST(ConjugateGradientSolver, MixedPrecision) {
+    using namespace conjugate_gradient_solver_test;
+    for (const std::string method : {"Diagonal", "IncompleteCholesky", "IncompleteLU"}) {
+        SCOPED_TRACE(method);
+        const auto reference = beam_test::solve(cg_beam({{"preconditioning_method", method}}));
+
+        // The single precision preconditioner only changes the CG iterations, the newton residuals must follow the
+        // ones of the double precision preconditioner, with or without iterative refinement
+        const auto mixed = beam_test::solve(cg_beam({{"preconditioning_method", method}, {"single_precision_preconditioner", "true"}}));
+        beam_test::expect_same_newton_iterations(reference, mixed);
+
+        const auto refined = beam_test::solve(cg_beam({{"preconditioning_method", method}, {"single_precision_preconditioner", "true"}, {"refinement_steps", "10"}}));
+        beam_test::expect_same_newton_iterations(reference, refined);
+    }
+}
+
+TEST(ConjugateGradientSolver, IterativeRefinement) {
+    using namespace conjugate_gradient_solver_test;
+    elasticity_test::Positions positions;
+    const elasticity_test::SparseMatrix A = elasticity_test::elasticity(8, positions);
+    const Eigen::VectorXd b = elasticity_test::load(positions);
+    const Arguments arguments = {{"maximum_number_of_iterations", "1000"}, {"residual_tolerance_threshold", "1e-10"}};
+
+    Eigen::DiagonalPreconditioner<double> diagonal;
+    diagonal.compute(A);
+    Eigen::VectorXd x_reference = Eigen::VectorXd::Zero(b.size());
+    const auto reference = solve_elasticity(arguments, diagonal, A, b, x_reference);
+
+    SofaCaribou::Algebra::SinglePrecisionPreconditioner<Eigen::DiagonalPreconditioner<float>> single_diagonal;
+    single_diagonal.compute(A);
+    auto refinement_arguments = arguments;
+    refinement_arguments["refinement_steps"] = "10";
+    refinement_arguments["refinement_tolerance"] = "1e-6";
+    Eigen::VectorXd x_refined = Eigen::VectorXd::Zero(b.size());
+    const auto refined = solve_elasticity(refinement_arguments, single_diagonal, A, b, x_refined);
+
+    // The first iterations follow the ones of the double precision solver, up to the rounding of the preconditioner
+    ASSERT_GT(reference.size(), 20u);
+    ASSERT_GT(refined.size(), 20u);
+    for (std::size_t i = 0; i < 20; ++i) {
+        EXPECT_NEAR(std::sqrt(refined[i] / reference[i]), 1., 1e-5) << "CG iteration #" << i+1;
+    }
+
+    // The refinement then reaches the threshold on the true residual, with a few more iterations in total
+    const double threshold = 1e-10*1e-10*b.squaredNorm();
+    EXPECT_LT(reference.back(), threshold);
+    EXPECT_LT(refined.back(), threshold);
+    EXPECT_LE(refined.size(), reference.size() + reference.size()/5);
+    EXPECT_LE((b - A*x_refined).squaredNorm(), threshold);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace elasticity_test {
+
+using SparseMatrix = Eigen::SparseMatrix<double>;
+using Positions = std::vector<Eigen::Vector3d>;
+
+/**
+ * Assemble the linear elastic stiffness matrix of a unit cube of n x n x n cells, each cell being split into 6
+ * tetrahedra. The interior nodes are randomly moved to get an unstructured mesh. The nodes of the face x = 0 are
+ * fixed (their rows and columns are replaced by the identity), as done by the projective constraints.
+ */
+inline SparseMatrix elasticity(int n, Positions & positions) {
+    const auto index = [n](int i, int j, int k) { return (k*(n+1) + j)*(n+1) + i; };
+    const int nb_nodes = (n+1)*(n+1)*(n+1);
+    const double h = 1. / n;
+    const double young_modulus = 1000, poisson_ratio = 0.3;
+    const double mu = young_modulus / (2*(1+poisson_ratio));
+    const double lambda = young_modulus*poisson_ratio / ((1+poisson_ratio)*(1-2*poisson_ratio));
+
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> distribution(-0.25*h, 0.25*h);
+    positions.resize(nb_nodes);
+    for (int k = 0; k <= n; ++k) for (int j = 0; j <= n; ++j) for (int i = 0; i <= n; ++i) {
+        Eigen::Vector3d p (i*h, j*h, k*h);
+        if (i > 0 and i < n and j > 0 and j < n and k > 0 and k < n) {
+            p += Eigen::Vector3d(distribution(generator), distribution(generator), distribution(generator));
+        }
+        positions[index(i, j, k)] = p;
+    }
+
+    // Each cube is split into 6 tetrahedra sharing its diagonal (0,0,0) - (1,1,1)
+    const int permutations[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+    std::vector<Eigen::Triplet<double>> triplets;
+    for (int k = 0; k < n; ++k) for (int j = 0; j < n; ++j) for (int i = 0; i < n; ++i) {
+        for (const auto & permutation : permutations) {
+            std::array<int, 4> nodes;
+            int c[3] = {i, j, k};
+            nodes[0] = index(c[0], c[1], c[2]);
+            for (int v = 0; v < 3; ++v) {
+                c[permutation[v]] += 1;
+                nodes[v+1] = index(c[0], c[1], c[2]);
+            }
+
+            Eigen::Matrix3d J;
+            for (int v = 0; v < 3; ++v) {
+                J.col(v) = positions[nodes[v+1]] - positions[nodes[0]];
+            }
+            const double volume = std::abs(J.determinant()) / 6.;
+            const Eigen::Matrix3d Jinv = J.inverse();
+            std::array<Eigen::Vector3d, 4> gradients;
+            gradients[1] = Jinv.row(0).transpose();
+            gradients[2] = Jinv.row(1).transpose();
+            gradients[3] = Jinv.row(2).transpose();
+            gradients[0] = -(gradients[1] + gradients[2] + gradients[3]);
+
+            for (int a = 0; a < 4; ++a) {
+                for (int b = 0; b < 4; ++b) {
+                    const Eigen::Matrix3d K = volume * (
+                        lambda * gradients[a] * gradients[b].transpose() +
+                        mu * gradients[b] * gradients[a].transpose() +
+                        mu * gradients[a].dot(gradients[b]) * Eigen::Matrix3d::Identity()
+                    );
+                    for (int r = 0; r < 3; ++r) {
+                        for (int s = 0; s < 3; ++s) {
+                            triplets.emplace_back(3*nodes[a] + r, 3*nodes[b] + s, K(r, s));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Fixed nodes
+    const auto is_fixed = [&positions](Eigen::Index dof) { return positions[dof / 3][0] == 0.; };
+    triplets.erase(std::remove_if(triplets.begin(), triplets.end(), [&](const Eigen::Triplet<double> & t) {
+        return is_fixed(t.row()) or is_fixed(t.col());
+    }), triplets.end());
+    for (Eigen::Index dof = 0; dof < 3*nb_nodes; ++dof) {
+        if (is_fixed(dof)) {
+            triplets.emplace_back(dof, dof, 1.);
+        }
+    }
+
+    SparseMatrix A(3*nb_nodes, 3*nb_nodes);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    return A;
+}
+
+/** Unit load along z on the free nodes */
+inline Eigen::VectorXd load(const Positions & positions) {
+    Eigen::VectorXd b = Eigen::VectorXd::Zero(3*positions.size());
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        if (positions[i][0] > 0.) {
+            b[3*i+2] = 1.;
+        }
+    }
+    return b;
+}
+
+/** Number of iterations of the preconditioned conjugate gradient to reach |r|/|b| < 1e-8 */
+template <typename Preconditioner>
+int pcg_iterations(const SparseMatrix & A, const Preconditioner & M, const Eigen::VectorXd & b) {
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(b.size());
+    Eigen::VectorXd r = b;
+    Eigen::VectorXd z = M.solve(r);
+    Eigen::VectorXd p = z;
+    double rho = r.dot(z);
+    for (int it = 1; it <= 2000; ++it) {
+        const Eigen::VectorXd q = A*p;
+        const double alpha = rho / p.dot(q);
+        x += alpha*p;
+        r -= alpha*q;
+        if (r.norm() < 1e-8*b.norm()) {
+            return it;
+        }
+        z = M.solve(r);
+        const double rho_next = r.dot(z);
+        p = z + (rho_next/rho)*p;
+        rho = rho_next;
+    }
+    return 2000;
+}
+
+} // namespace elasticity_test
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/IterativeLinearSolvers>
+#include <SofaCaribou/Algebra/GeometricMultigridPreconditioner.h>
+
+namespace geometric_multigrid_test {
+
+using SparseMatrix = Eigen::SparseMatrix<double>;
+using Positions = std::vector<Eigen::Vector3d>;
+
+/**
+ * Assemble the 7-points stencil Laplacian of a cube of n x n x n cells of size h. The nodes of the face x = 0 are
+ * fixed (their rows and columns are replaced by the identity), as done by the projective constraints.
+ */
+inline SparseMatrix laplacian(int n, double h, Positions & positions) {
+    const auto index = [n](int i, int j, int k) { return (k*(n+1) + j)*(n+1) + i; };
+    const int nb_nodes = (n+1)*(n+1)*(n+1);
+    std::vector<Eigen::Triplet<double>> triplets;
+    positions.resize(nb_nodes);
+
+    for (int k = 0; k <= n; ++k) for (int j = 0; j <= n; ++j) for (int i = 0; i <= n; ++i) {
+        const int p = index(i, j, k);
+        positions[p] = Eigen::Vector3d(i*h, j*h, k*h);
+        if (i == 0) {
+            triplets.emplace_back(p, p, 1.);
+            continue;
+        }
+        triplets.emplace_back(p, p, 6.);
+        const int neighbors[6][3] = {{i-1, j, k}, {i+1, j, k}, {i, j-1, k}, {i, j+1, k}, {i, j, k-1}, {i, j, k+1}};
+        for (const auto & q : neighbors) {
+            if (q[0] > 0 and q[0] <= n and q[1] >= 0 and q[1] <= n and q[2] >= 0 and q[2] <= n) {
+                triplets.emplace_back(p, index(q[0], q[1], q[2]), -1.);
+            }
+        }
+    }
+
+    SparseMatrix A(nb_nodes, nb_nodes);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    return A;
+}
+
+/** Number of iterations of the preconditioned conjugate gradient to reach |r|/|b| < 1e-8 */
+template <typename Preconditioner>
+int pcg_iterations(const SparseMatrix & A, const Preconditioner & M, const Eigen::VectorXd & b) {
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(b.size());
+    Eigen::VectorXd r = b;
+    Eigen::VectorXd z = M.solve(r);
+    Eigen::VectorXd p = z;
+    double rho = r.dot(z);
+    for (int it = 1; it <= 1000; ++it) {
+        const Eigen::VectorXd q = A*p;
+        const double alpha = rho / p.dot(q);
+        x += alpha*p;
+        r -= alpha*q;
+        if (r.norm() < 1e-8*b.norm()) {
+            return it;
+        }
+        z = M.solve(r);
+        const double rho_next = r.dot(z);
+        p = z + (rho_next/rho)*p;
+        rho = rho_next;
+    }
+    return 1000;
+}
+
+} // namespace geometric_multigrid_test
+
+TEST(GeometricMultigrid, GridHierarchy) {
+    using namespace geometric_multigrid_test;
+    Positions positions;
+    const SparseMatrix A = laplacian(8, 0.5, positions);
+
+    // Vector degrees of freedom (3 per node)
+    SofaCaribou::Algebra::GeometricMultigridPreconditioner<double> multigrid;
+    multigrid.set_coarsest_size(10);
+    ASSERT_TRUE(multigrid.set_nodes(positions, 3));
+
+    // 8^3 cells -> 4^3 -> 2^3 -> 1^3
+    ASSERT_EQ(multigrid.number_of_levels(), 4);
+    EXPECT_EQ(multigrid.size_of_level(0), 3*9*9*9);
+    EXPECT_EQ(multigrid.size_of_level(1), 3*5*5*5);
+    EXPECT_EQ(multigrid.size_of_level(2), 3*3*3*3);
+    EXPECT_EQ(multigrid.size_of_level(3), 3*2*2*2);
+
+    // Nodes that aren't on a regular grid are rejected
+    positions[1] += Eigen::Vector3d(0.1234, 0, 0);
+    EXPECT_FALSE(multigrid.set_nodes(positions, 3));
+}
+
+TEST(GeometricMultigrid, MeshIndependentIterations) {
+    using namespace geometric_multigrid_test;
+    std::vector<int> multigrid_iterations, diagonal_iterations;
+    for (const int n : {8, 16, 32}) {
+        Positions positions;
+        const SparseMatrix A = laplacian(n, 1./n, positions);
+        Eigen::VectorXd b = Eigen::VectorXd::Ones(A.rows());
+        for (Eigen::Index i = 0; i < A.rows(); i += n+1) {
+            b[i] = 0; // Fixed nodes (x = 0)
+        }
+
+        SofaCaribou::Algebra::GeometricMultigridPreconditioner<double> multigrid;
+        multigrid.set_coarsest_size(100);
+        ASSERT_TRUE(multigrid.set_nodes(positions, 1));
+        multigrid.compute(A);
+        ASSERT_EQ(multigrid.info(), Eigen::Success);
+        multigrid_iterations.emplace_back(pcg_iterations(A, multigrid, b));
+
+        Eigen::DiagonalPreconditioner<double> diagonal;
+        diagonal.compute(A);
+        diagonal_iterations.emplace_back(pcg_iterations(A, diagonal, b));
+    }
+
+    // The number of iterations of the diagonal preconditioner grows with the resolution, not the one of the multigrid
+    EXPECT_GT(diagonal_iterations.back(), 2*diagonal_iterations.front());
+    EXPECT_LE(multigrid_iterations.back(), multigrid_iterations.front() + 2);
+    EXPECT_LT(multigrid_iterations.back(), 15);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <SofaCaribou/GraphComponents/Material/NeoHookeanMaterial.h>
+#include <SofaCaribou/GraphComponents/Material/SaintVenantKirchhoffMaterial.h>
+#include <sofa/defaulttype/VecTypes.h>
+
+namespace hyperelastic_material_test {
+
+using Mat33 = Eigen::Matrix<double, 3, 3>;
+
+/**
+ * The fused evaluation of the stress, its jacobian and the strain energy density must give the values of the
+ * separate methods, at a few strain states (rest, uniaxial stretch, compression, simple shear and a general one).
+ */
+template <typename Material>
+void expect_same_fused_evaluation() {
+    using sofa::defaulttype::Vec3Types;
+    const auto material = sofa::core::objectmodel::New<Material>();
+    material->findData("young_modulus")->read("3000");
+    material->findData("poisson_ratio")->read("0.3");
+    material->before_update();
+
+    // Called through the base class, as done by the forcefields
+    const SofaCaribou::GraphComponents::material::HyperelasticMaterial<Vec3Types> & m = *material;
+
+    Mat33 stretch, compression, shear, general;
+    stretch     << 1.2,  0,     0,    0,    1,    0,   0,    0,    1;
+    compression << 0.8,  0,     0,    0,    0.95, 0,   0,    0,    0.95;
+    shear       << 1,    0.3,   0,    0,    1,    0,   0,    0,    1;
+    general     << 1.1,  0.2,  -0.05, 0.05, 0.9,  0.1, 0.02, -0.1, 1.05;
+
+    for (const Mat33 & F : std::vector<Mat33> {Mat33::Identity(), stretch, compression, shear, general}) {
+        SCOPED_TRACE(F);
+        const double J = F.determinant();
+        const Mat33 E = 0.5 * (F.transpose()*F - Mat33::Identity());
+
+        const auto S = m.PK2_stress(J, E);
+        const auto D = m.PK2_stress_jacobian(J, E);
+        const auto Psi = m.strain_energy_density(J, E);
+
+        const auto fused = m.PK2_stress_and_jacobian(J, E, true);
+        EXPECT_LE((fused.S - S).norm(), 1e-12 * std::max(1., S.norm()));
+        EXPECT_LE((fused.D - D).norm(), 1e-12 * std::max(1., D.norm()));
+        EXPECT_NEAR(fused.Psi, Psi, 1e-12 * std::max(1., std::abs(Psi)));
+
+        // Without the strain energy density, the stress and its jacobian are unchanged
+        const auto without_energy = m.PK2_stress_and_jacobian(J, E, false);
+        EXPECT_EQ(without_energy.S, fused.S);
+        EXPECT_EQ(without_energy.D, fused.D);
+        EXPECT_EQ(without_energy.Psi, 0.);
+    }
+}
+
+} // namespace hyperelastic_material_test
+
+TEST(HyperelasticMaterial, NeoHookeanFusedEvaluation) {
+    using sofa::defaulttype::Vec3Types;
+    hyperelastic_material_test::expect_same_fused_evaluation<SofaCaribou::GraphComponents::material::NeoHookeanMaterial<Vec3Types>>();
+}
+
+TEST(HyperelasticMaterial, SaintVenantKirchhoffFusedEvaluation) {
+    using sofa::defaulttype::Vec3Types;
+    hyperelastic_material_test::expect_same_fused_evaluation<SofaCaribou::GraphComponents::material::SaintVenantKirchhoffMaterial<Vec3Types>>();
+}
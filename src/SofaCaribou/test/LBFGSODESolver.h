@@ -0,0 +1,31 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "Beam.h"
+
+TEST(LBFGSODESolver, Equilibrium) {
+    using namespace beam_test;
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        SCOPED_TRACE(material);
+        const auto newton = solve({"HyperelasticForcefield", {}, material});
+        ASSERT_TRUE(newton.converged);
+
+        std::map<std::string, std::size_t> number_of_iterations;
+        for (const std::string preconditioner : {"None", "InitialStiffness", "NodeBlockJacobi"}) {
+            SCOPED_TRACE(preconditioner);
+            BeamOptions options {"HyperelasticForcefield", {}, material};
+            options.ode_solver = "LBFGSODESolver";
+            options.ode_solver_arguments = {{"preconditioner", preconditioner}, {"iterations", "5000"}};
+            const auto lbfgs = solve(options);
+            EXPECT_TRUE(lbfgs.converged);
+
+            // Both minimize the same potential energy
+            expect_same_equilibrium(newton, lbfgs);
+            number_of_iterations[preconditioner] = lbfgs.residuals.size() - 1;
+        }
+
+        // The stiffness at rest is a good approximation of the hessian
+        EXPECT_LT(number_of_iterations["InitialStiffness"], number_of_iterations["None"]);
+    }
+}
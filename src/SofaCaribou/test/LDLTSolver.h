@@ -0,0 +1,25 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "Beam.h"
+
+TEST(LDLTSolver, SymbolicAnalysisReuse) {
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        SCOPED_TRACE(material);
+        beam_test::BeamOptions options {"HyperelasticForcefield", {}, material};
+        options.linear_solver_arguments = {{"preconditioning_method", "Diagonal"}};
+        const auto reference = beam_test::solve(options);
+
+        options.linear_solver = "LDLTSolver";
+        options.linear_solver_arguments = {};
+        const auto direct = beam_test::solve(options);
+
+        // The direct solver follows the newton iterations of the CG (up to the CG tolerance)
+        beam_test::expect_same_newton_iterations(reference, direct);
+
+        // Every newton iterations factorize the matrix, but its sparsity pattern is only analyzed once
+        EXPECT_EQ(direct.number_of_factorizations, direct.residuals.size() - 1);
+        EXPECT_EQ(direct.number_of_symbolic_analyses, 1u);
+    }
+}
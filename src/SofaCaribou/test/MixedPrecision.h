@@ -0,0 +1,33 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Sparse>
+#include <Eigen/IterativeLinearSolvers>
+#include <SofaCaribou/Algebra/SinglePrecisionPreconditioner.h>
+#include "Elasticity.h"
+
+TEST(MixedPrecision, SinglePrecisionPreconditioner) {
+    using namespace elasticity_test;
+    Positions positions;
+    const SparseMatrix A = elasticity(8, positions);
+    const Eigen::VectorXd b = load(positions);
+
+    // The rounding of the factors to single precision barely changes the number of iterations of the (double
+    // precision) conjugate gradient
+    Eigen::IncompleteCholesky<double> ichol;
+    ichol.compute(A);
+    SofaCaribou::Algebra::SinglePrecisionPreconditioner<Eigen::IncompleteCholesky<float>> single_ichol;
+    single_ichol.compute(A);
+    ASSERT_EQ(single_ichol.info(), Eigen::Success);
+    const Eigen::VectorXd x = single_ichol.solve(b);
+    EXPECT_EQ(x.size(), b.size());
+    EXPECT_LE(pcg_iterations(A, single_ichol, b), pcg_iterations(A, ichol, b) + 5);
+
+    Eigen::DiagonalPreconditioner<double> diagonal;
+    diagonal.compute(A);
+    SofaCaribou::Algebra::SinglePrecisionPreconditioner<Eigen::DiagonalPreconditioner<float>> single_diagonal;
+    single_diagonal.compute(A);
+    EXPECT_NEAR((single_diagonal.solve(b) - diagonal.solve(b)).norm() / diagonal.solve(b).norm(), 0, 1e-6);
+    EXPECT_LE(pcg_iterations(A, single_diagonal, b), pcg_iterations(A, diagonal, b) + 5);
+}
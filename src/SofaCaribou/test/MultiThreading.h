@@ -0,0 +1,62 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "Beam.h"
+
+namespace multithreading_test {
+
+/**
+ * Tangent of the beam's forcefield computed with one and four threads. The parallel computations accumulate the values
+ * of each node in the same order as the sequential loops: the results must be identical, not only close. Without OpenMP, both are computed sequentially.
+ */
+inline void expect_identical_tangent(beam_test::BeamOptions options) {
+    options.forcefield_arguments["number_of_threads"] = "1";
+    const auto sequential = beam_test::evaluate_forcefield(options);
+    options.forcefield_arguments["number_of_threads"] = "4";
+    const auto parallel = beam_test::evaluate_forcefield(options);
+
+    ASSERT_EQ(parallel.forces.size(), sequential.forces.size());
+    ASSERT_EQ(parallel.force_increments.size(), sequential.force_increments.size());
+    for (std::size_t i = 0; i < sequential.forces.size(); ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(parallel.forces[i][j], sequential.forces[i][j]);
+            EXPECT_EQ(parallel.force_increments[i][j], sequential.force_increments[i][j]);
+        }
+    }
+    EXPECT_TRUE(parallel.stiffness == sequential.stiffness);
+}
+
+} // namespace multithreading_test
+
+TEST(MultiThreading, HyperelasticForcefield) {
+    using namespace multithreading_test;
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        for (const std::string storage : {"Dense", "MatrixFree"}) {
+            SCOPED_TRACE(material + " " + storage);
+            const beam_test::BeamOptions options {"HyperelasticForcefield", {{"tangent_storage", storage}}, material};
+            expect_identical_tangent(options);
+        }
+    }
+}
+
+TEST(MultiThreading, HexahedronElasticForce) {
+    using namespace multithreading_test;
+    // Corotated linear strain, and Green-Lagrange strain
+    for (const std::string linear : {"true", "false"}) {
+        SCOPED_TRACE("linearStrain " + linear);
+        const beam_test::BeamOptions options {"HexahedronElasticForce", {{"youngModulus", "3000"}, {"poissonRatio", "0.3"}, {"linearStrain", linear}, {"corotated", linear}}};
+        expect_identical_tangent(options);
+    }
+}
+
+TEST(MultiThreading, TetrahedronElasticForce) {
+    using namespace multithreading_test;
+    // Corotated linear strain, and Green-Lagrange strain
+    for (const std::string linear : {"true", "false"}) {
+        SCOPED_TRACE("linearStrain " + linear);
+        beam_test::BeamOptions options {"TetrahedronElasticForce", {{"youngModulus", "3000"}, {"poissonRatio", "0.3"}, {"linearStrain", linear}, {"corotated", linear}}};
+        options.element = "Tetrahedron";
+        expect_identical_tangent(options);
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "Beam.h"
+
+namespace single_precision_stiffness_test {
+
+using beam_test::Equilibrium;
+
+/**
+ * The single precision stiffness only changes the tangent: the internal forces (hence the residual) are still
+ * computed in double precision, and never read the stored matrices. Newton must converge to the same equilibrium,
+ * up to its tolerance, in about the same number of iterations.
+ */
+inline void compare(const Equilibrium & double_precision, const Equilibrium & single_precision, const double & tolerance = 1e-6) {
+    ASSERT_TRUE(double_precision.converged);
+    EXPECT_TRUE(single_precision.converged);
+    EXPECT_LE(single_precision.residuals.size(), double_precision.residuals.size() + 1);
+
+    ASSERT_EQ(double_precision.positions.size(), single_precision.positions.size());
+    double max_difference = 0, max_displacement = 0;
+    for (std::size_t i = 0; i < double_precision.positions.size(); ++i) {
+        max_difference = std::max(max_difference, static_cast<double>((double_precision.positions[i] - single_precision.positions[i]).norm()));
+        max_displacement = std::max(max_displacement, static_cast<double>((double_precision.positions[i] - double_precision.rest_positions[i]).norm()));
+    }
+    EXPECT_LT(max_difference, tolerance * max_displacement);
+}
+
+/**
+ * At the same state, the forces must be the same up to the rounding errors of double precision, while the tangent
+ * products only match up to single precision.
+ */
+inline void compare_forces(const beam_test::BeamOptions & double_precision, const beam_test::BeamOptions & single_precision) {
+    const auto d = beam_test::evaluate_forcefield(double_precision);
+    const auto s = beam_test::evaluate_forcefield(single_precision);
+
+    ASSERT_EQ(d.forces.size(), s.forces.size());
+    double max_force = 0, max_increment = 0;
+    for (std::size_t i = 0; i < d.forces.size(); ++i) {
+        max_force = std::max(max_force, static_cast<double>(d.forces[i].norm()));
+        max_increment = std::max(max_increment, static_cast<double>(d.force_increments[i].norm()));
+    }
+    for (std::size_t i = 0; i < d.forces.size(); ++i) {
+        EXPECT_LT((s.forces[i] - d.forces[i]).norm(), 1e-12 * max_force);
+        EXPECT_LT((s.force_increments[i] - d.force_increments[i]).norm(), 1e-5 * max_increment);
+    }
+}
+
+} // namespace single_precision_stiffness_test
+
+TEST(SinglePrecisionStiffness, HyperelasticForcefield) {
+    using namespace single_precision_stiffness_test;
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        for (const std::string storage : {"Dense", "PackedSymmetric"}) {
+            SCOPED_TRACE(material + " " + storage);
+            const auto d = beam_test::solve({"HyperelasticForcefield", {{"tangent_storage", storage}}, material});
+            const auto s = beam_test::solve({"HyperelasticForcefield", {{"tangent_storage", storage}, {"single_precision_stiffness", "true"}}, material});
+            compare(d, s);
+        }
+    }
+}
+
+TEST(SinglePrecisionStiffness, HexahedronElasticForce) {
+    using namespace single_precision_stiffness_test;
+    const std::map<std::string, std::string> arguments = {{"youngModulus", "3000"}, {"poissonRatio", "0.3"}, {"linearStrain", "false"}, {"corotated", "false"}};
+    auto single_precision_arguments = arguments;
+    single_precision_arguments["single_precision_stiffness"] = "true";
+
+    const auto d = beam_test::solve({"HexahedronElasticForce", arguments});
+    const auto s = beam_test::solve({"HexahedronElasticForce", single_precision_arguments});
+    compare(d, s);
+}
+
+TEST(SinglePrecisionStiffness, LinearHexahedronElasticForce) {
+    using namespace single_precision_stiffness_test;
+    const std::map<std::string, std::string> arguments = {{"youngModulus", "3000"}, {"poissonRatio", "0.3"}, {"linearStrain", "true"}, {"corotated", "true"}};
+    auto single_precision_arguments = arguments;
+    single_precision_arguments["single_precision_stiffness"] = "true";
+
+    // Newton is stopped far below the error of a single precision K*U (about 1e-7), so that an internal force
+    // read from the stored matrices would move the equilibrium beyond the tolerance
+    const beam_test::Arguments ode_solver_arguments = {{"residual_tolerance_threshold", "1e-12"}};
+    const auto d = beam_test::solve({"HexahedronElasticForce", arguments, "", "StaticODESolver", ode_solver_arguments});
+    const auto s = beam_test::solve({"HexahedronElasticForce", single_precision_arguments, "", "StaticODESolver", ode_solver_arguments});
+    compare(d, s, 1e-9);
+}
+
+TEST(SinglePrecisionStiffness, InternalForces) {
+    using namespace single_precision_stiffness_test;
+    for (const std::string linear : {"true", "false"}) {
+        SCOPED_TRACE("HexahedronElasticForce linearStrain=" + linear);
+        const std::map<std::string, std::string> arguments = {{"youngModulus", "3000"}, {"poissonRatio", "0.3"}, {"linearStrain", linear}, {"corotated", linear}};
+        auto single_precision_arguments = arguments;
+        single_precision_arguments["single_precision_stiffness"] = "true";
+        compare_forces({"HexahedronElasticForce", arguments}, {"HexahedronElasticForce", single_precision_arguments});
+    }
+
+    for (const std::string storage : {"Dense", "PackedSymmetric"}) {
+        SCOPED_TRACE("HyperelasticForcefield " + storage);
+        compare_forces({"HyperelasticForcefield", {{"tangent_storage", storage}}, "SaintVenantKirchhoffMaterial"},
+                       {"HyperelasticForcefield", {{"tangent_storage", storage}, {"single_precision_stiffness", "true"}}, "SaintVenantKirchhoffMaterial"});
+    }
+}
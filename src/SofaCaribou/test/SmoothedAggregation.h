@@ -0,0 +1,66 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Sparse>
+#include <Eigen/IterativeLinearSolvers>
+#include <SofaCaribou/Algebra/SmoothedAggregationPreconditioner.h>
+#include "Elasticity.h"
+
+TEST(SmoothedAggregation, SetupReuse) {
+    using namespace elasticity_test;
+    Positions positions;
+    const SparseMatrix A = elasticity(6, positions);
+    const Eigen::VectorXd b = load(positions);
+
+    SofaCaribou::Algebra::SmoothedAggregationPreconditioner<double> amg;
+    amg.set_coarsest_size(50);
+    amg.set_nodes(positions, 3);
+    amg.compute(A);
+    ASSERT_EQ(amg.info(), Eigen::Success);
+    ASSERT_GT(amg.number_of_levels(), 1);
+    for (Eigen::Index l = 1; l < amg.number_of_levels(); ++l) {
+        EXPECT_LT(amg.size_of_level(l), amg.size_of_level(l-1));
+    }
+    const auto number_of_levels = amg.number_of_levels();
+    const int iterations = pcg_iterations(A, amg, b);
+    EXPECT_LT(iterations, 30);
+
+    // The aggregates are reused by the next factorizations...
+    const SparseMatrix A2 = 2.*A;
+    amg.factorize(A2);
+    EXPECT_EQ(amg.number_of_aggregations(), 1u);
+    EXPECT_EQ(amg.number_of_levels(), number_of_levels);
+    EXPECT_EQ(pcg_iterations(A2, amg, b), iterations);
+
+    // ...until the pattern is analyzed again
+    amg.analyzePattern(A2);
+    amg.factorize(A2);
+    EXPECT_EQ(amg.number_of_aggregations(), 2u);
+}
+
+TEST(SmoothedAggregation, MeshIndependentIterations) {
+    using namespace elasticity_test;
+    std::vector<int> amg_iterations, ichol_iterations;
+    for (const int n : {4, 8, 16}) {
+        Positions positions;
+        const SparseMatrix A = elasticity(n, positions);
+        const Eigen::VectorXd b = load(positions);
+
+        SofaCaribou::Algebra::SmoothedAggregationPreconditioner<double> amg;
+        amg.set_coarsest_size(100);
+        amg.set_nodes(positions, 3);
+        amg.compute(A);
+        ASSERT_EQ(amg.info(), Eigen::Success);
+        amg_iterations.emplace_back(pcg_iterations(A, amg, b));
+
+        Eigen::IncompleteCholesky<double> ichol;
+        ichol.compute(A);
+        ichol_iterations.emplace_back(pcg_iterations(A, ichol, b));
+    }
+
+    // The number of iterations of the incomplete Cholesky grows with the resolution, much less the one of the multigrid
+    EXPECT_GT(ichol_iterations.back(), 2*ichol_iterations.front());
+    EXPECT_LT(amg_iterations.back(), 2*amg_iterations.front());
+    EXPECT_LT(amg_iterations.back(), ichol_iterations.back());
+}
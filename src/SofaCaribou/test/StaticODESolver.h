@@ -0,0 +1,218 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+#include "Beam.h"
+
+namespace static_ode_solver_test {
+
+using beam_test::Arguments;
+using beam_test::expect_same_equilibrium;
+
+/** The beam of the given material solved with the given arguments of the StaticODESolver and of the forcefield */
+inline beam_test::BeamOptions static_beam(const std::string & material, const Arguments & ode_arguments = {}, const std::string & linear_solver = "ConjugateGradientSolver", const Arguments & forcefield_arguments = {}) {
+    beam_test::BeamOptions options {"HyperelasticForcefield", forcefield_arguments, material};
+    options.ode_solver_arguments = ode_arguments;
+    options.linear_solver = linear_solver;
+    return options;
+}
+
+/** State of the beam at the end of each time step of a load applied by increments */
+struct LoadSteps {
+    std::vector<bool> converged;
+    std::vector<unsigned int> number_of_load_cutbacks;
+    std::vector<double> total_loads;
+    beam_test::Solution solution; ///< Solution of the last time step
+};
+
+/** Total traction load of the beams (30 N per unit area over the 2x2 free end) */
+constexpr double beam_total_load = 30. * 4.;
+
+/**
+ * Solve the Neo-Hookean beam with its traction applied by increments of the given slope, until the total load is
+ * reached or the maximum number of time steps is done.
+ */
+inline LoadSteps solve_beam_load_steps(const std::string & slope, const Arguments & ode_arguments, const unsigned int & maximum_number_of_steps) {
+    beam_test::BeamOptions options {"HyperelasticForcefield", {}, "NeoHookeanMaterial"};
+    options.ode_solver_arguments = ode_arguments;
+    options.traction_slope = slope;
+    beam_test::Beam beam(options);
+
+    LoadSteps steps;
+    for (unsigned int step = 0; step < maximum_number_of_steps; ++step) {
+        beam.animate();
+        steps.solution = beam_test::read_solution(beam);
+        steps.converged.push_back(steps.solution.converged);
+        steps.number_of_load_cutbacks.push_back(steps.solution.number_of_load_cutbacks);
+        steps.total_loads.push_back(beam_test::Beam::data<double>(beam.traction(), "total_load"));
+        if (steps.total_loads.back() > (1. - 1e-10) * beam_total_load) {
+            break;
+        }
+    }
+
+    return steps;
+}
+
+} // namespace static_ode_solver_test
+
+TEST(StaticODESolver, InexactNewton) {
+    using namespace static_ode_solver_test;
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        SCOPED_TRACE(material);
+        const auto exact = beam_test::solve(static_beam(material));
+        const auto inexact = beam_test::solve(static_beam(material, {{"inexact_newton", "true"}}));
+
+        ASSERT_TRUE(exact.converged);
+        EXPECT_TRUE(inexact.converged);
+
+        // One linear solve per newton iteration
+        ASSERT_EQ(exact.linear_solver_iterations.size(), exact.residuals.size() - 1);
+        ASSERT_EQ(inexact.linear_solver_iterations.size(), inexact.residuals.size() - 1);
+
+        // The loose linear solves far from the equilibrium may add a few newton iterations, but less CG iterations
+        // are needed in total
+        const auto sum = [](const sofa::helper::vector<unsigned int> & iterations) {
+            return std::accumulate(iterations.begin(), iterations.end(), 0u);
+        };
+        EXPECT_LT(sum(inexact.linear_solver_iterations), sum(exact.linear_solver_iterations));
+
+        // Both reach the same equilibrium
+        expect_same_equilibrium(exact, inexact);
+    }
+}
+
+TEST(StaticODESolver, LineSearch) {
+    using namespace static_ode_solver_test;
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        SCOPED_TRACE(material);
+        const auto full_step = beam_test::solve(static_beam(material));
+        ASSERT_TRUE(full_step.converged);
+
+        // Without line search, every newton iterations take the full step
+        ASSERT_EQ(full_step.step_lengths.size(), full_step.residuals.size() - 1);
+        for (const auto & step_length : full_step.step_lengths) {
+            EXPECT_EQ(step_length, 1.);
+        }
+
+        for (const std::string method : {"Energy", "Residual"}) {
+            SCOPED_TRACE(method);
+            const auto searched = beam_test::solve(static_beam(material, {{"line_search", method}}));
+            EXPECT_TRUE(searched.converged);
+
+            ASSERT_EQ(searched.step_lengths.size(), searched.residuals.size() - 1);
+            for (const auto & step_length : searched.step_lengths) {
+                EXPECT_GT(step_length, 0.);
+                EXPECT_LE(step_length, 1.);
+            }
+
+            // Near the equilibrium, the full newton step is always accepted
+            EXPECT_EQ(searched.step_lengths.back(), 1.);
+
+            // Both reach the same equilibrium
+            expect_same_equilibrium(full_step, searched);
+        }
+    }
+}
+
+TEST(StaticODESolver, ModifiedNewton) {
+    using namespace static_ode_solver_test;
+    for (const std::string linear_solver : {"ConjugateGradientSolver", "LDLTSolver"}) {
+        SCOPED_TRACE(linear_solver);
+        const auto full = beam_test::solve(static_beam("NeoHookeanMaterial", {}, linear_solver));
+        const Arguments tangent_reuse = {{"newton_iterations", "100"}, {"tangent_reuse", "3"}};
+        const auto modified = beam_test::solve(static_beam("NeoHookeanMaterial", tangent_reuse, linear_solver));
+
+        ASSERT_TRUE(full.converged);
+        EXPECT_TRUE(modified.converged);
+
+        // Full newton rebuilds the tangent at every iterations
+        EXPECT_EQ(full.number_of_tangent_updates, full.residuals.size() - 1);
+        EXPECT_EQ(full.number_of_tangent_reuses, 0u);
+
+        // Every newton iterations either rebuild or reuse the tangent, and the tangent is reused at most 3 times in a row
+        EXPECT_EQ(modified.number_of_tangent_updates + modified.number_of_tangent_reuses, modified.residuals.size() - 1);
+        EXPECT_GT(modified.number_of_tangent_reuses, 0u);
+        EXPECT_LE(modified.number_of_tangent_reuses, 3 * modified.number_of_tangent_updates);
+        EXPECT_LT(modified.number_of_tangent_updates, full.number_of_tangent_updates);
+        if (linear_solver == "LDLTSolver") {
+            EXPECT_EQ(modified.number_of_factorizations, modified.number_of_tangent_updates);
+        }
+
+        // Both reach the same equilibrium
+        expect_same_equilibrium(full, modified);
+
+        // The frozen matrix-free tangent is the one of the positions it was built at, as the stored element matrices
+        const auto matrix_free = beam_test::solve(static_beam("NeoHookeanMaterial", tangent_reuse, linear_solver, {{"tangent_storage", "MatrixFree"}}));
+        EXPECT_EQ(matrix_free.number_of_tangent_updates, modified.number_of_tangent_updates);
+        EXPECT_EQ(matrix_free.number_of_tangent_reuses, modified.number_of_tangent_reuses);
+        beam_test::expect_same_newton_iterations(modified, matrix_free);
+    }
+}
+
+TEST(StaticODESolver, AdaptiveLoadStepping) {
+    using namespace static_ode_solver_test;
+    const auto fixed = solve_beam_load_steps("0.05", {}, 40);
+    const auto adaptive = solve_beam_load_steps("0.05", {{"adaptive_load_stepping", "true"}, {"load_increment_growth_iterations", "25"}}, 40);
+
+    // The fixed increments need 20 time steps to reach the total load
+    ASSERT_EQ(fixed.converged.size(), 20u);
+    for (const auto & converged : fixed.converged) {
+        ASSERT_TRUE(converged);
+    }
+
+    // The grown increments reach the total load in less time steps, and every time steps end at an equilibrium
+    EXPECT_LT(adaptive.converged.size(), fixed.converged.size());
+    EXPECT_NEAR(adaptive.total_loads.back(), beam_total_load, 1e-8 * beam_total_load);
+    for (const auto & converged : adaptive.converged) {
+        EXPECT_TRUE(converged);
+    }
+
+    // Both reach the same equilibrium
+    expect_same_equilibrium(fixed.solution, adaptive.solution);
+}
+
+TEST(StaticODESolver, LoadCutback) {
+    using namespace static_ode_solver_test;
+
+    // A single newton iteration never reaches the residual threshold: the increment is cut back until the maximum
+    // number of cutbacks, and the time step is then cancelled
+    const auto steps = solve_beam_load_steps("1", {{"adaptive_load_stepping", "true"}, {"newton_iterations", "1"}, {"maximum_load_cutbacks", "3"}}, 1);
+    ASSERT_EQ(steps.converged.size(), 1u);
+    EXPECT_FALSE(steps.converged[0]);
+    EXPECT_EQ(steps.number_of_load_cutbacks[0], 3u);
+
+    // The positions and the load of the beginning of the step (the rest state) are restored
+    EXPECT_NEAR(steps.total_loads[0], 0., 1e-10 * beam_total_load);
+    ASSERT_EQ(steps.solution.positions.size(), steps.solution.rest_positions.size());
+    for (std::size_t i = 0; i < steps.solution.positions.size(); ++i) {
+        EXPECT_EQ(steps.solution.positions[i], steps.solution.rest_positions[i]);
+    }
+}
+
+TEST(StaticODESolver, LoadCutbackWithCorrectionCriterion) {
+    using namespace static_ode_solver_test;
+
+    // Newton only stops on the correction's ratio |du|/|U|, U being the total displacement. The full load isn't
+    // reached in 5 newton iterations: its increment is cut back until the reduced load converges.
+    const Arguments correction_criterion = {{"newton_iterations", "5"}, {"correction_tolerance_threshold", "1e-6"}, {"residual_tolerance_threshold", "-1"}};
+    Arguments adaptive_arguments = correction_criterion;
+    adaptive_arguments["adaptive_load_stepping"] = "true";
+    const auto cutback = solve_beam_load_steps("1", adaptive_arguments, 1);
+    ASSERT_EQ(cutback.converged.size(), 1u);
+    ASSERT_TRUE(cutback.converged[0]);
+    ASSERT_GT(cutback.number_of_load_cutbacks[0], 0u);
+
+    // The displacements of the diverged attempts are discarded with their positions: the last attempt follows the
+    // newton iterations of the reduced load applied at once
+    std::ostringstream reduced_slope;
+    reduced_slope << std::setprecision(17) << cutback.total_loads[0] / beam_total_load;
+    const auto direct = solve_beam_load_steps(reduced_slope.str(), correction_criterion, 1);
+    ASSERT_EQ(direct.converged.size(), 1u);
+    EXPECT_DOUBLE_EQ(direct.total_loads[0], cutback.total_loads[0]);
+    beam_test::expect_same_newton_iterations(direct.solution, cutback.solution);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "Beam.h"
+
+TEST(TangentStorage, MatrixFree) {
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        SCOPED_TRACE(material);
+        const beam_test::BeamOptions dense {"HyperelasticForcefield", {{"tangent_storage", "Dense"}}, material};
+        const beam_test::BeamOptions matrix_free {"HyperelasticForcefield", {{"tangent_storage", "MatrixFree"}}, material};
+
+        // The products K*dx and the matrix blocks computed from the stress and its jacobian at the gauss nodes are
+        // the ones of the stored elemental matrices, up to the rounding errors
+        beam_test::expect_same_tangent(beam_test::evaluate_forcefield(dense), beam_test::evaluate_forcefield(matrix_free), 1e-10);
+    }
+}
+
+TEST(TangentStorage, PackedSymmetric) {
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        SCOPED_TRACE(material);
+        const beam_test::BeamOptions dense {"HyperelasticForcefield", {{"tangent_storage", "Dense"}}, material};
+        const beam_test::BeamOptions packed {"HyperelasticForcefield", {{"tangent_storage", "PackedSymmetric"}}, material};
+
+        // The packed blocks are the upper blocks of the dense element matrices, the lower ones being their transpose
+        beam_test::expect_same_tangent(beam_test::evaluate_forcefield(dense), beam_test::evaluate_forcefield(packed), 1e-12);
+    }
+}
+
+TEST(TangentStorage, MatrixFreeNewton) {
+    for (const std::string material : {"SaintVenantKirchhoffMaterial", "NeoHookeanMaterial"}) {
+        SCOPED_TRACE(material);
+        const auto dense = beam_test::solve({"HyperelasticForcefield", {{"tangent_storage", "Dense"}}, material});
+        const auto matrix_free = beam_test::solve({"HyperelasticForcefield", {{"tangent_storage", "MatrixFree"}}, material});
+        EXPECT_TRUE(dense.converged);
+        EXPECT_TRUE(matrix_free.converged);
+        EXPECT_EQ(matrix_free.residuals.size(), dense.residuals.size());
+        beam_test::expect_same_equilibrium(dense, matrix_free);
+    }
+}
@@ -3,6 +3,19 @@
 #include <Caribou/config.h>
 #include <Eigen/Sparse>
 #include <SofaCaribou/Algebra/EigenMatrixWrapper.h>
+#include "BatchedKernels.h"
+#include "BlockSparseMatrix.h"
+#include "ConjugateGradientSolver.h"
+#include "GeometricMultigrid.h"
+#include "HyperelasticMaterial.h"
+#include "LBFGSODESolver.h"
+#include "LDLTSolver.h"
+#include "MixedPrecision.h"
+#include "MultiThreading.h"
+#include "SinglePrecisionStiffness.h"
+#include "SmoothedAggregation.h"
+#include "StaticODESolver.h"
+#include "TangentStorage.h"
 
 template<int nRows, int nColumns>
 using Matrix = Eigen::Matrix<FLOATING_POINT_TYPE, nRows, nColumns>;
@@ -178,8 +191,66 @@ TEST(Algebra, SparseMatrixByReference) {
     EXPECT_EQ(m.coeff(30, 30), 200);
 }
 
+TEST(Algebra, SparseMatrixPatternLocked) {
+    using EigenSparse = Eigen::SparseMatrix<double>;
+    using EigenWrapper = SofaCaribou::Algebra::EigenMatrixWrapper<EigenSparse &>;
+
+    const size_t N = 9;
+    EigenSparse m;
+
+    // Assemble the matrix with a new wrapper every time, as done by the solvers at every Newton iterations
+    const auto assemble = [&m, N](bool with_new_entry) {
+        EigenWrapper mm(m);
+        mm.set_pattern_locked(true);
+        mm.resize(N, N);
+        mm.add(0, 0, sofa::defaulttype::Mat3x3d(1));
+        mm.add(3, 3, sofa::defaulttype::Mat3x3d(1));
+        mm.add(0, 0, 2);
+        if (with_new_entry) {
+            mm.add(8, 0, 5);
+        }
+        mm.clearRow(1);
+        mm.compress();
+        return mm.pattern_has_changed();
+    };
+
+    // First assembly: the pattern is built from the triplets
+    EXPECT_TRUE(assemble(false));
+    EXPECT_EQ(m.nonZeros(), 18);
+
+    // Same pattern: the values are accumulated into the existing entries
+    EXPECT_FALSE(assemble(false));
+    EXPECT_EQ(m.nonZeros(), 18);
+    EXPECT_EQ(m.coeff(0, 0), 3);
+    EXPECT_EQ(m.coeff(1, 1), 0);
+    EXPECT_EQ(m.coeff(3, 3), 1);
+
+    // A new entry rebuilds the pattern once
+    EXPECT_TRUE(assemble(true));
+    EXPECT_EQ(m.nonZeros(), 19);
+    EXPECT_EQ(m.coeff(8, 0), 5);
+    EXPECT_FALSE(assemble(true));
+    EXPECT_EQ(m.coeff(8, 0), 5);
+
+    // An entry that isn't added anymore is kept in the pattern with a zero value
+    EXPECT_FALSE(assemble(false));
+    EXPECT_EQ(m.nonZeros(), 19);
+    EXPECT_EQ(m.coeff(8, 0), 0);
+    EXPECT_EQ(m.coeff(0, 0), 3);
+
+    // Resizing to other dimensions resets the pattern
+    EigenWrapper mm(m);
+    mm.set_pattern_locked(true);
+    mm.resize(2*N, 2*N);
+    mm.compress();
+    EXPECT_TRUE(mm.pattern_has_changed());
+    EXPECT_EQ(m.nonZeros(), 0);
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
+    sofa::simpleapi::importPlugin("SofaComponentAll");
+    sofa::simpleapi::importPlugin("SofaCaribou");
     int ret = RUN_ALL_TESTS();
     return ret;
 }